@@ -0,0 +1,18 @@
+#pragma once
+
+#include <chrono>
+
+#include "cppy/datetime.h"
+
+// Wall-clock time of one call of `func`, in milliseconds.
+template <class Func>
+double bench_measure(Func func)
+{
+    std::chrono::steady_clock::time_point start, end;
+    CPPY_DATETIME_now(&start);
+    func();
+    CPPY_DATETIME_now(&end);
+    std::chrono::microseconds::rep us;
+    CPPY_DATETIME_duration<std::chrono::microseconds>(start, end, &us);
+    return static_cast<double>(us) / 1000.0;
+}
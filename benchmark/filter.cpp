@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Compare std::copy_if with the branchless CPPY_BUILTINS_filter at several selectivities,
+//  and std::all_of with the SIMD and parallel CPPY_BUILTINS_all.
+//  usage: bench_filter [n] [workers]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const std::size_t workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<int> ints(n);
+    for (int& x : ints)
+        CPPY_RANDOM_randint(&random, 0, 99, &x);
+
+    bool ok = true;
+    std::printf("n = %d, workers = %zu\n", n, workers);
+    std::printf("%-10s %12s %12s %12s\n", "filter ms", "copy_if", "cppy", "parallel");
+    for (int percent : {1, 50, 99})
+    {
+        auto keep = [percent](int x) { return x < percent; };
+        std::vector<int> a, b, c;
+        a.reserve(n), b.reserve(n), c.reserve(n);
+        const double t1 = bench_measure([&]() { std::copy_if(ints.begin(), ints.end(), std::back_inserter(a), keep); });
+        const double t2 = bench_measure([&]() { CPPY_BUILTINS_filter(ints.begin(), ints.end(), keep, std::back_inserter(b)); });
+        const double t3 =
+            bench_measure([&]() { CPPY_BUILTINS_filter(&pool, ints.begin(), ints.end(), keep, std::back_inserter(c)); });
+        ok = ok && a == b && a == c;
+        std::printf("%9d%% %12.1f %12.1f %12.1f\n", percent, t1, t2, t3);
+    }
+
+    std::vector<int> ones(n, 1);
+    bool r1 = false, r2 = false, r3 = false;
+    const double t1 = bench_measure([&]() { r1 = std::all_of(ones.begin(), ones.end(), [](int x) { return x != 0; }); });
+    const double t2 = bench_measure([&]() { CPPY_BUILTINS_all(ones.begin(), ones.end(), &r2); });
+    const double t3 = bench_measure([&]() { CPPY_BUILTINS_all(&pool, ones.begin(), ones.end(), &r3); });
+    ok = ok && r1 && r2 && r3;
+    std::printf("%-10s %12.1f %12.1f %12.1f\n", "all", t1, t2, t3);
+    return ok ? 0 : 1;
+}
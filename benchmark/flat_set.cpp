@@ -0,0 +1,63 @@
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Compare std::set and CPPY_FlatSet on bulk build, lookup and iteration.
+//  usage: bench_flat_set [n]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<int> values(n), probes(n);
+    for (int i = 0; i < n; ++i)
+    {
+        CPPY_RANDOM_randint(&random, 0, n, &values[i]);
+        CPPY_RANDOM_randint(&random, 0, n, &probes[i]);
+    }
+
+    std::set<int> tree;
+    CPPY_FlatSet<int> flat;
+    long long found_tree = 0, found_flat = 0, sum_tree = 0, sum_flat = 0;
+
+    const double build_tree = bench_measure([&]() { CPPY_SET_init(&tree, values.begin(), values.end()); });
+    const double build_flat = bench_measure([&]() { CPPY_SET_init(&flat, values.begin(), values.end()); });
+
+    const double lookup_tree = bench_measure([&]() {
+        bool result;
+        for (int x : probes)
+        {
+            CPPY_SET_iscontain(tree, x, &result);
+            found_tree += result;
+        }
+    });
+    const double lookup_flat = bench_measure([&]() {
+        bool result;
+        for (int x : probes)
+        {
+            CPPY_SET_iscontain(flat, x, &result);
+            found_flat += result;
+        }
+    });
+
+    const double iter_tree = bench_measure([&]() {
+        for (int x : tree)
+            sum_tree += x;
+    });
+    const double iter_flat = bench_measure([&]() {
+        for (int x : flat)
+            sum_flat += x;
+    });
+
+    std::printf("n = %d, unique = %zu\n", n, flat.size());
+    std::printf("%-10s %12s %12s\n", "ms", "std::set", "flat_set");
+    std::printf("%-10s %12.1f %12.1f\n", "build", build_tree, build_flat);
+    std::printf("%-10s %12.1f %12.1f\n", "lookup", lookup_tree, lookup_flat);
+    std::printf("%-10s %12.1f %12.1f\n", "iterate", iter_tree, iter_flat);
+    return (found_tree == found_flat && sum_tree == sum_flat) ? 0 : 1;
+}
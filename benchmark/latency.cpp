@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "cppy/cppy.h"
+
+using bench_clock = std::chrono::steady_clock;
+
+// Microseconds from each post() to the start of its task, for tasks posted one at a time
+//  `gap_us` apart so the workers have gone idle in between.
+static std::vector<double> submit_to_start(const CPPY_CONCURRENT_ThreadPoolOptions& options, int tasks, int gap_us)
+{
+    std::vector<double> latencies(tasks);
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+    for (int i = 0; i < tasks; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+        std::atomic<bool> started{false};
+        const bench_clock::time_point posted = bench_clock::now();
+        pool.post([&, i, posted]() {
+            latencies[i] = std::chrono::duration<double, std::micro>(bench_clock::now() - posted).count();
+            started.store(true, std::memory_order_release);
+        });
+        while (!started.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+}
+
+// Submit-to-start latency of an idle pool under each idle policy: sleeping at once, yielding
+//  first, spinning then yielding first (the default), and an elastic pool that has retired
+//  every worker and starts one per task.
+//  usage: bench_latency [tasks] [workers] [gap us]
+int main(int argc, char* argv[])
+{
+    const int tasks = argc > 1 ? std::atoi(argv[1]) : 2000;
+    const std::size_t workers = argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : 2;
+    const int gap_us = argc > 3 ? std::atoi(argv[3]) : 200;
+
+    struct Policy
+    {
+        const char* name;
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+    };
+    std::vector<Policy> policies(4);
+    for (Policy& policy : policies)
+        policy.options.max_workers = workers;
+    policies[0].name = "park";
+    policies[0].options.spin_count = policies[0].options.yield_count = 0;
+    policies[1].name = "yield";
+    policies[1].options.spin_count = 0;
+    policies[2].name = "spin";
+    policies[3].name = "elastic";
+    policies[3].options.min_workers = 0;
+    policies[3].options.idle_timeout = std::chrono::milliseconds(0);
+
+    std::printf("%d tasks, %zu workers, %d us apart, submit to start in us\n", tasks, workers, gap_us);
+    std::printf("%-10s %10s %10s %10s\n", "", "p50", "p99", "max");
+    for (const Policy& policy : policies)
+    {
+        const std::vector<double> latencies = submit_to_start(policy.options, tasks, gap_us);
+        std::printf("%-10s %10.2f %10.2f %10.2f\n", policy.name, percentile(latencies, 0.50),
+                    percentile(latencies, 0.99), latencies.back());
+    }
+    return 0;
+}
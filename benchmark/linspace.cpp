@@ -0,0 +1,56 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// The previous linspace: each sample adds step to the one before it.
+static void linspace_accumulate(double start, double end, int num, double result[])
+{
+    const double step = (end - start) / (num - 1);
+    result[0] = start;
+    for (int i = 1; i < num - 1; ++i)
+        result[i] = result[i - 1] + step;
+    result[num - 1] = end;
+}
+
+// Largest distance from the correctly rounded sample, in units of step.
+static double max_error(const std::vector<double>& values, long double start, long double end)
+{
+    const long double num = static_cast<long double>(values.size());
+    long double error = 0.0L;
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        const long double exact = start + (end - start) * static_cast<long double>(i) / (num - 1);
+        error = std::max(error, std::fabs(static_cast<long double>(values[i]) - exact));
+    }
+    return static_cast<double>(error / ((end - start) / (num - 1)));
+}
+
+// Compare the repeated-addition linspace with the index-based one, serially and on the
+//  thread pool, and report how far each drifts from the exact samples.
+//  usage: bench_linspace [n] [workers]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const std::size_t workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+    const double start = 0.1, end = 0.7;
+
+    std::vector<double> accumulate(n), serial(n), parallel(n);
+    const double t_accumulate = bench_measure([&]() { linspace_accumulate(start, end, n, accumulate.data()); });
+    const double t_serial = bench_measure([&]() { CPPY_BUILTINS_linspace(start, end, n, serial.data()); });
+    const double t_parallel = bench_measure([&]() { CPPY_BUILTINS_linspace(&pool, start, end, n, parallel.data()); });
+
+    std::printf("n = %d, workers = %zu\n", n, workers);
+    std::printf("%-12s %10s %14s\n", "", "ms", "max error/step");
+    std::printf("%-12s %10.2f %14.3g\n", "accumulate", t_accumulate, max_error(accumulate, start, end));
+    std::printf("%-12s %10.2f %14.3g\n", "linspace", t_serial, max_error(serial, start, end));
+    std::printf("%-12s %10.2f %14.3g\n", "parallel", t_parallel, max_error(parallel, start, end));
+    return 0;
+}
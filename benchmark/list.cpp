@@ -0,0 +1,58 @@
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Compare std::list and CPPY_List on the Python-style list workload: append,
+//  positional reads, extended slicing and sort.
+//  usage: bench_list [n]
+template <class List>
+static void run(const char* name, const std::vector<int>& values, const std::vector<int>& positions)
+{
+    List list;
+    long long checksum = 0;
+
+    const double append = bench_measure([&]() {
+        for (int x : values)
+            CPPY_LIST_append(&list, x);
+    });
+    const double at = bench_measure([&]() {
+        int element;
+        for (int i : positions)
+        {
+            CPPY_Sequence_at(list, i, &element);
+            checksum += element;
+        }
+    });
+    const double slice = bench_measure([&]() {
+        std::vector<int> result;
+        CPPY_BUILTINS_slice(list.begin(), list.end(), 0, static_cast<int>(values.size()), 2,
+                            std::back_inserter(result));
+        checksum += static_cast<long long>(result.size());
+    });
+    const double sort = bench_measure([&]() { CPPY_LIST_sort(&list); });
+
+    std::printf("%-10s %10.1f %10.1f %10.1f %10.1f   (checksum %lld)\n", name, append, at, slice, sort, checksum);
+}
+
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<int> values(n), positions(1000);
+    for (int& x : values)
+        CPPY_RANDOM_randint(&random, 0, n, &x);
+    for (int& i : positions)
+        CPPY_RANDOM_randint(&random, 0, n - 1, &i);
+
+    std::printf("n = %d, %zu positional reads\n", n, positions.size());
+    std::printf("%-10s %10s %10s %10s %10s\n", "ms", "append", "at", "slice", "sort");
+    run<std::list<int>>("std::list", values, positions);
+    run<CPPY_List<int>>("CPPY_List", values, positions);
+    return 0;
+}
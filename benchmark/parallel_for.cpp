@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Busy work of about `iterations` dependent multiply-adds.
+static unsigned spin(unsigned iterations, unsigned seed)
+{
+    unsigned x = seed;
+    for (unsigned i = 0; i < iterations; ++i)
+        x = x * 1664525u + 1013904223u;
+    return x;
+}
+
+// One post per item, waiting on a counter: what a loop costs without chunking.
+static double per_item(CPPY_CONCURRENT_ThreadPoolExecutor& pool, std::vector<unsigned>& out, unsigned work)
+{
+    const int n = static_cast<int>(out.size());
+    return bench_measure([&]() {
+        std::atomic<int> done{0};
+        for (int i = 0; i < n; ++i)
+            pool.post([&, i]() {
+                out[i] = spin(work, i);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        while (done.load(std::memory_order_acquire) < n)
+            std::this_thread::yield();
+    });
+}
+
+static double chunked(CPPY_CONCURRENT_ThreadPoolExecutor& pool, std::vector<unsigned>& out, unsigned work,
+                      size_t grain)
+{
+    return bench_measure([&]() {
+        pool.parallel_for(0, out.size(), [&](size_t i) { out[i] = spin(work, static_cast<unsigned>(i)); }, grain);
+    });
+}
+
+// Items per microsecond of a loop run as one task per item, as parallel_for with grain 1 and
+//  as parallel_for with the adaptive grain, sweeping the work per item.
+//  usage: bench_parallel_for [items] [workers]
+int main(int argc, char* argv[])
+{
+    const int items = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const std::size_t workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+
+    std::printf("%d items, %zu workers, items/us\n", items, workers);
+    std::printf("%-8s %12s %12s %12s\n", "work", "per item", "grain 1", "adaptive");
+    for (unsigned work : {0u, 10u, 100u, 1000u})
+    {
+        const int n = work >= 1000 ? items / 10 : items;
+        std::vector<unsigned> out(n);
+        std::printf("%-8u %12.3f %12.3f %12.3f\n", work, n / per_item(pool, out, work) / 1000.0,
+                    n / chunked(pool, out, work, 1) / 1000.0, n / chunked(pool, out, work, 0) / 1000.0);
+    }
+    return 0;
+}
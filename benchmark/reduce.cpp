@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+template <typename T>
+static void run(const char* name, const std::vector<T>& data, CPPY_CONCURRENT_ThreadPoolExecutor* pool)
+{
+    const CPPY_REDUCE_t all = CPPY_REDUCE_t::All;
+    double sink = 0.0;
+    CPPY_Reduction<T> result;
+    const double separate = bench_measure([&]() {
+        sink += static_cast<double>(*std::min_element(data.begin(), data.end()));
+        sink += static_cast<double>(*std::max_element(data.begin(), data.end()));
+        sink += static_cast<double>(std::accumulate(data.begin(), data.end(), T()));
+    });
+    const double fast = bench_measure([&]() { CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result, CPPY_SUM_t::Fast); });
+    const double pairwise = bench_measure([&]() { CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result); });
+    const double kahan = bench_measure([&]() { CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result, CPPY_SUM_t::Kahan); });
+    const double parallel = bench_measure([&]() { CPPY_BUILTINS_reduce(pool, data.begin(), data.end(), all, &result); });
+    std::printf("%-8s %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, separate, fast, pairwise, kahan, parallel);
+    if (sink == 0.5)
+        std::printf("\n");
+}
+
+// Compare separate min_element/max_element/accumulate passes with one CPPY_BUILTINS_reduce
+//  pass (all of min/max/sum/argmin/argmax/mean) in each summation mode and on the thread pool.
+//  usage: bench_reduce [n] [workers]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const std::size_t workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<int> ints(n);
+    for (int& x : ints)
+        CPPY_RANDOM_randint(&random, -(1 << 20), 1 << 20, &x);
+    std::vector<float> floats(ints.begin(), ints.end());
+    std::vector<double> doubles(ints.begin(), ints.end());
+
+    std::printf("n = %d, workers = %zu\n", n, workers);
+    std::printf("%-8s %10s %10s %10s %10s %10s\n", "ms", "separate", "fast", "pairwise", "kahan", "parallel");
+    run("int", ints, &pool);
+    run("float", floats, &pool);
+    run("double", doubles, &pool);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+template <class T, class Sort>
+static double run(const std::vector<T>& input, Sort sort, bool* const ok)
+{
+    std::vector<T> values = input;
+    const double ms = bench_measure([&]() { sort(&values); });
+    *ok = *ok && std::is_sorted(values.begin(), values.end());
+    return ms;
+}
+
+// Compare std::sort with CPPY_VECTOR_sort (radix for ints, Timsort for strings) and the
+//  parallel merge sort on the thread pool.
+//  usage: bench_sort [n] [workers]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    const std::size_t workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<int> ints(n);
+    for (int& x : ints)
+        CPPY_RANDOM_randint(&random, 0, 1 << 30, &x);
+    std::vector<std::string> strings;
+    for (int i = 0; i < n / 10; ++i)
+        strings.push_back(std::to_string(ints[i]));
+
+    bool ok = true;
+    std::printf("n = %d, workers = %zu\n", n, workers);
+    std::printf("%-10s %12s %12s %12s\n", "ms", "std::sort", "cppy", "parallel");
+    std::printf("%-10s %12.1f %12.1f %12.1f\n",
+                "int",
+                run(ints, [](std::vector<int>* v) { std::sort(v->begin(), v->end()); }, &ok),
+                run(ints, [](std::vector<int>* v) { CPPY_VECTOR_sort(v); }, &ok),
+                run(ints, [&](std::vector<int>* v) { CPPY_VECTOR_sort(&pool, v); }, &ok));
+    std::printf("%-10s %12.1f %12.1f %12.1f\n",
+                "string",
+                run(strings, [](std::vector<std::string>* v) { std::sort(v->begin(), v->end()); }, &ok),
+                run(strings, [](std::vector<std::string>* v) { CPPY_VECTOR_sort(v); }, &ok),
+                run(strings, [&](std::vector<std::string>* v) { CPPY_VECTOR_sort(&pool, v); }, &ok));
+    return ok ? 0 : 1;
+}
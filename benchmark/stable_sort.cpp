@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Compare std::stable_sort with the Timsort behind CPPY_BUILTINS_sorted on the input
+//  shapes Timsort adapts to. Keys are strings so that the radix path is not taken.
+//  usage: bench_stable_sort [n]
+int main(int argc, char* argv[])
+{
+    const int n = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 42);
+    std::vector<std::vector<int>> shapes(4, std::vector<int>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        shapes[0][i] = i;
+        shapes[1][i] = n - i;
+        shapes[2][i] = i % 1000;
+        CPPY_RANDOM_randint(&random, 0, n, &shapes[3][i]);
+    }
+    const char* names[] = {"sorted", "reversed", "sawtooth", "random"};
+
+    bool ok = true;
+    std::printf("n = %d\n", n);
+    std::printf("%-10s %16s %12s\n", "ms", "std::stable_sort", "timsort");
+    for (std::size_t s = 0; s < shapes.size(); ++s)
+    {
+        std::vector<std::string> input;
+        input.reserve(n);
+        for (int x : shapes[s])
+            input.push_back(std::to_string(1000000000 + x));
+
+        std::vector<std::string> expected = input;
+        std::vector<std::string> values = input;
+        const double std_ms = bench_measure([&]() { std::stable_sort(expected.begin(), expected.end()); });
+        const double tim_ms = bench_measure([&]() { CPPY_BUILTINS_sorted(values.begin(), values.end()); });
+        ok = ok && values == expected;
+        std::printf("%-10s %16.1f %12.1f\n", names[s], std_ms, tim_ms);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Every allocation made by this program, counted by the replaced global operator new.
+static std::atomic<long long> allocations{0};
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+template <class Submit>
+static void run(const char* name, int tasks, Submit submit)
+{
+    // one round to warm the free lists, then the measured one
+    submit(tasks);
+    const long long before = allocations.load();
+    const double ms = bench_measure([&]() { submit(tasks); });
+    const double per_task = static_cast<double>(allocations.load() - before) / tasks;
+    std::printf("%-10s %10.2f %12.3f %14.2f\n", name, ms, tasks / ms / 1000.0, per_task);
+}
+
+// Cost of handing tasks to CPPY_CONCURRENT_ThreadPoolExecutor: submit (std::future), spawn
+//  (recycled CPPY_CONCURRENT_Future) and post (fire and forget), in time and in allocations
+//  per task.
+//  usage: bench_submit [tasks] [workers]
+int main(int argc, char* argv[])
+{
+    const int tasks = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const std::size_t workers = argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : 2;
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(workers);
+    std::atomic<long long> sum{0};
+
+    std::printf("%d tasks, %zu workers\n", tasks, workers);
+    std::printf("%-10s %10s %12s %14s\n", "", "ms", "Mtasks/s", "mallocs/task");
+    std::vector<std::future<int>> futures;
+    std::vector<CPPY_CONCURRENT_Future<int>> spawned;
+    futures.reserve(tasks);
+    spawned.reserve(tasks);
+    run("submit", tasks, [&](int n) {
+        futures.clear();
+        for (int i = 0; i < n; ++i)
+            futures.push_back(pool.submit([i]() { return i; }));
+        for (auto& future : futures)
+            sum += future.get();
+    });
+    run("spawn", tasks, [&](int n) {
+        spawned.clear();
+        for (int i = 0; i < n; ++i)
+            spawned.push_back(pool.spawn([i]() { return i; }));
+        for (auto& future : spawned)
+            sum += future.get();
+    });
+    run("post", tasks, [&](int n) {
+        std::atomic<int> done{0};
+        for (int i = 0; i < n; ++i)
+            pool.post([&done, &sum, i]() {
+                sum.fetch_add(i, std::memory_order_relaxed);
+                done.fetch_add(1, std::memory_order_release);
+            });
+        while (done.load(std::memory_order_acquire) < n)
+            std::this_thread::yield();
+    });
+    if (sum.load() == 42)
+        std::printf("\n");
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cppy/cppy.h"
+
+// Busy work of about `iterations` dependent multiply-adds.
+static unsigned spin(unsigned iterations)
+{
+    unsigned x = iterations;
+    for (unsigned i = 0; i < iterations; ++i)
+        x = x * 1664525u + 1013904223u;
+    return x;
+}
+
+static std::atomic<unsigned> sink{0};
+
+// Millions of tasks per second: `tasks` tasks submitted from the calling thread.
+static double external(const CPPY_CONCURRENT_ThreadPoolOptions& options, int tasks, unsigned work)
+{
+    double ms = 0.0;
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        ms = bench_measure([&]() {
+            for (int i = 0; i < tasks; ++i)
+                pool.post([work]() { sink.fetch_add(spin(work), std::memory_order_relaxed); });
+            pool.shutdown();
+        });
+    }
+    return tasks / ms / 1000.0;
+}
+
+// Millions of tasks per second: a binary tree of tasks, each submitting its children from
+//  inside a worker.
+static double nested(const CPPY_CONCURRENT_ThreadPoolOptions& options, int depth, unsigned work)
+{
+    double ms = 0.0;
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        std::function<void(int)> node = [&](int level) {
+            sink.fetch_add(spin(work), std::memory_order_relaxed);
+            if (level > 0)
+            {
+                pool.post(node, level - 1);
+                pool.post(node, level - 1);
+            }
+        };
+        ms = bench_measure([&]() {
+            pool.post(node, depth);
+            pool.shutdown();
+        });
+    }
+    return ((2 << depth) - 1) / ms / 1000.0;
+}
+
+// Task throughput of the shared-queue and work-stealing schedulers, sweeping the work per task
+//  and the number of workers.
+//  usage: bench_thread_pool [tasks] [max workers]
+int main(int argc, char* argv[])
+{
+    const int tasks = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const std::size_t max_workers =
+        argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    int depth = 0;
+    while ((2 << (depth + 1)) - 1 <= tasks)
+        ++depth;
+
+    std::printf("%d tasks, Mtasks/s\n", tasks);
+    std::printf("%-8s %8s %10s %10s %10s %10s\n", "work", "workers", "shared", "stealing", "shared", "stealing");
+    std::printf("%-8s %8s %10s %10s %10s %10s\n", "", "", "external", "external", "nested", "nested");
+    std::vector<std::size_t> worker_counts;
+    for (std::size_t workers = 1; workers < max_workers; workers *= 2)
+        worker_counts.push_back(workers);
+    worker_counts.push_back(max_workers);
+
+    for (unsigned work : {0u, 100u, 1000u, 10000u})
+    {
+        for (std::size_t workers : worker_counts)
+        {
+            CPPY_CONCURRENT_ThreadPoolOptions shared, stealing;
+            shared.max_workers = stealing.max_workers = workers;
+            stealing.work_stealing = true;
+            const int n = work >= 10000 ? tasks / 10 : tasks;
+            const int d = work >= 10000 ? depth - 3 : depth;
+            std::printf("%-8u %8zu %10.3f %10.3f %10.3f %10.3f\n", work, workers, external(shared, n, work),
+                        external(stealing, n, work), nested(shared, d, work), nested(stealing, d, work));
+        }
+    }
+    if (sink.load() == 42)
+        std::printf("\n");
+    return 0;
+}
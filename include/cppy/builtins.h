@@ -1,11 +1,20 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <numeric>
+#include <vector>
 
 #include "cppy/exception.h"
 #include "cppy/internal/declare.h"
+#include "cppy/internal/filter.h"
 #include "cppy/internal/internal.h"
+#include "cppy/internal/reduce.h"
+#include "cppy/internal/select.h"
+#include "cppy/internal/slice.h"
+#include "cppy/internal/sort.h"
+#include "cppy/thread.h"
 
 /*
  * Return True if bool(x) is True for all values x in the iterable.
@@ -21,7 +30,34 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_all(Iterable first, Iterable last, Pred func
 template <class Iterable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_all(Iterable first, Iterable last, bool* const result)
 {
-    return CPPY_BUILTINS_all(first, last, [](typename Iterable::value_type v) { return v; }, result);
+    *result = cppy::internal::all_truthy(first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+/*
+ * Parallel all() over a random-access range.
+ *
+ * Chunks are tested on the executor and all of them stop as soon as one finds
+ * a false value. func must be safe to call from several threads.
+ */
+template <class Iterable, class Pred>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_all(
+    CPPY_CONCURRENT_ThreadPoolExecutor* const executor, Iterable first, Iterable last, Pred func, bool* const result)
+{
+    *result = !cppy::internal::parallel_find(
+        executor, first, last, [&func](Iterable begin, Iterable end) { return !std::all_of(begin, end, func); });
+    return CPPY_ERROR_t::Ok;
+}
+template <class Iterable>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_all(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                        Iterable first,
+                                        Iterable last,
+                                        bool* const result)
+{
+    *result = !cppy::internal::parallel_find(executor, first, last, [](Iterable begin, Iterable end) {
+        return !cppy::internal::all_truthy(begin, end);
+    });
+    return CPPY_ERROR_t::Ok;
 }
 
 /*
@@ -38,7 +74,34 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_any(Iterable first, Iterable last, Pred func
 template <class Iterable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_any(Iterable first, Iterable last, bool* const result)
 {
-    return CPPY_BUILTINS_any(first, last, [](typename Iterable::value_type v) { return v; }, result);
+    *result = cppy::internal::any_truthy(first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+/*
+ * Parallel any() over a random-access range.
+ *
+ * Chunks are tested on the executor and all of them stop as soon as one finds
+ * a true value. func must be safe to call from several threads.
+ */
+template <class Iterable, class Pred>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_any(
+    CPPY_CONCURRENT_ThreadPoolExecutor* const executor, Iterable first, Iterable last, Pred func, bool* const result)
+{
+    *result = cppy::internal::parallel_find(
+        executor, first, last, [&func](Iterable begin, Iterable end) { return std::any_of(begin, end, func); });
+    return CPPY_ERROR_t::Ok;
+}
+template <class Iterable>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_any(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                        Iterable first,
+                                        Iterable last,
+                                        bool* const result)
+{
+    *result = cppy::internal::parallel_find(executor, first, last, [](Iterable begin, Iterable end) {
+        return cppy::internal::any_truthy(begin, end);
+    });
+    return CPPY_ERROR_t::Ok;
 }
 
 /*
@@ -97,14 +160,108 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_divmod(T x, T y, T* const div, T* const mod)
 
 /*
  * Return an iterator yielding those items of iterable for which function(item) is true.
+ *
+ * Contiguous numbers are filtered without a branch per element: the predicate
+ * results are collected first and the kept items are compacted in SIMD registers.
  */
 template <class Iterable, class Pred, class OutputIter>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_filter(Iterable first, Iterable last, Pred func, OutputIter result)
 {
-    std::copy_if(first, last, result, func);
+    if constexpr (cppy::internal::is_compactable_v<Iterable>)
+        cppy::internal::filter_compact(first, last, func, result);
+    else
+        std::copy_if(first, last, result, func);
     return CPPY_ERROR_t::Ok;
 }
 
+/*
+ * Parallel filter over a random-access range.
+ *
+ * Each chunk is filtered on the executor into its own buffer; the buffers are
+ * then written to result in order, so the output is the same as the serial call.
+ * func must be safe to call from several threads.
+ */
+template <class Iterable, class Pred, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_filter(
+    CPPY_CONCURRENT_ThreadPoolExecutor* const executor, Iterable first, Iterable last, Pred func, OutputIter result)
+{
+    using T = typename std::iterator_traits<Iterable>::value_type;
+    constexpr std::size_t grain = 1 << 14;
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = cppy::internal::parallel_chunks(executor, size, grain);
+
+    std::vector<std::vector<T>> parts(chunks);
+    cppy::internal::parallel_invoke(executor, chunks, [&](std::size_t i) {
+        const std::size_t begin = size * i / chunks;
+        const std::size_t end = size * (i + 1) / chunks;
+        CPPY_BUILTINS_filter(first + begin, first + end, func, std::back_inserter(parts[i]));
+    });
+    for (auto& part : parts)
+        result = std::move(part.begin(), part.end(), result);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Lazy sequence of evenly spaced numbers, filled in by CPPY_BUILTINS_linspace and
+ *  CPPY_BUILTINS_arange.
+ *
+ *  Nothing is materialised: the i-th value is computed on demand as start + i * step,
+ *  the same expression the array versions use, so both produce identical values.
+ */
+struct CPPY_Linspace_view
+{
+    class iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = double;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const double*;
+        using reference = double;
+
+        iterator() = default;
+        iterator(const CPPY_Linspace_view* view, std::size_t index) : _view(view), _index(index) {}
+
+        double operator*() const { return (*_view)[_index]; }
+        double operator[](difference_type n) const { return (*_view)[_index + n]; }
+        iterator& operator++() { return ++_index, *this; }
+        iterator operator++(int) { return iterator(_view, _index++); }
+        iterator& operator--() { return --_index, *this; }
+        iterator operator--(int) { return iterator(_view, _index--); }
+        iterator& operator+=(difference_type n) { return _index += n, *this; }
+        iterator& operator-=(difference_type n) { return _index -= n, *this; }
+        iterator operator+(difference_type n) const { return iterator(_view, _index + n); }
+        iterator operator-(difference_type n) const { return iterator(_view, _index - n); }
+        difference_type operator-(const iterator& other) const
+        {
+            return static_cast<difference_type>(_index) - static_cast<difference_type>(other._index);
+        }
+        bool operator==(const iterator& other) const { return _index == other._index; }
+        bool operator!=(const iterator& other) const { return _index != other._index; }
+        bool operator<(const iterator& other) const { return _index < other._index; }
+        bool operator>(const iterator& other) const { return _index > other._index; }
+        bool operator<=(const iterator& other) const { return _index <= other._index; }
+        bool operator>=(const iterator& other) const { return _index >= other._index; }
+
+    private:
+        const CPPY_Linspace_view* _view = nullptr;
+        std::size_t _index = 0;
+    };
+
+    double start = 0.0;
+    double step = 0.0;
+    double stop = 0.0;
+    std::size_t num = 0;
+    bool exact_stop = false; // the last value is `stop` itself (linspace with endpoint)
+
+    std::size_t size() const { return num; }
+    double operator[](std::size_t i) const
+    {
+        return exact_stop && i + 1 == num ? stop : start + static_cast<double>(i) * step;
+    }
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, num); }
+};
+
 /* Return evenly spaced numbers over a specified interval.
  *
  *  Returns `num` evenly spaced samples, calculated over the interval [`start`, `stop`].
@@ -115,11 +272,14 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_filter(Iterable first, Iterable last, Pred f
  *  stop
  *    The end value
  *  num : int, optional
- *    Number of samples to generate. Must be non-negative.
+ *    Number of samples to generate. Must be non-negative, otherwise ValueError is raised.
  *  endpoint : bool, optional
  *    If True, `stop` is the last sample. Otherwise, it is not included.
  *    Default is True.
  *
+ *  Each sample is computed from its own index as start + i * step, so rounding error does
+ *  not accumulate along the array, and with endpoint the last sample is exactly `stop`.
+ *
  *  >>> np.linspace(2.0, 3.0, 5)
  *  array([2.  , 2.25, 2.5 , 2.75, 3.  ])
  *  >>> np.linspace(2.0, 3.0, 5, endpoint=False)
@@ -127,6 +287,72 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_filter(Iterable first, Iterable last, Pred f
  */
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(double start, double end, int num, double result[], bool endpoint = true);
 
+/*
+ * Parallel linspace: chunks of result are filled on the executor. Every sample
+ * depends only on its index, so the values are the same as the serial call.
+ */
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                             double start,
+                                             double end,
+                                             int num,
+                                             double result[],
+                                             bool endpoint = true);
+
+/*
+ * Lazy linspace: set up a view that yields the samples on demand.
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_BUILTINS_linspace(double start, double end, int num, CPPY_Linspace_view* const result, bool endpoint = true);
+
+/* Return evenly spaced values within a given interval.
+ *
+ *  Values are generated within the half-open interval [start, stop), every `step`.
+ *  The number of values is ceil((stop - start) / step). Raises ValueError if step is 0.
+ *
+ *  >>> np.arange(3.0, 7.0, 1.5)
+ *  array([3. , 4.5, 6. ])
+ */
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_arange(double start, double stop, double step, std::vector<double>* const result);
+
+/*
+ * Lazy arange: set up a view that yields the values on demand.
+ */
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_arange(double start, double stop, double step, CPPY_Linspace_view* const result);
+
+/* Return numbers spaced evenly on a log scale.
+ *
+ *  The sequence starts at base ** start and ends with base ** stop (see `endpoint`):
+ *  it is base raised to the samples of linspace(start, stop, num, endpoint).
+ *
+ *  >>> np.logspace(2.0, 3.0, num=4)
+ *  array([ 100.        ,  215.443469  ,  464.15888336, 1000.        ])
+ */
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_logspace(
+    double start, double stop, int num, double result[], bool endpoint = true, double base = 10.0);
+
+/*
+ * Parallel logspace: chunks of result are filled on the executor.
+ */
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_logspace(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                             double start,
+                                             double stop,
+                                             int num,
+                                             double result[],
+                                             bool endpoint = true,
+                                             double base = 10.0);
+
+/* Return numbers spaced evenly on a log scale (a geometric progression).
+ *
+ *  Like logspace, but with the endpoints given directly: the first sample is `start`
+ *  and, with endpoint, the last is exactly `stop`. Both must be non-zero and have the
+ *  same sign, otherwise ValueError is raised.
+ *
+ *  >>> np.geomspace(1, 1000, num=4)
+ *  array([   1.,   10.,  100., 1000.])
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_BUILTINS_geomspace(double start, double stop, int num, double result[], bool endpoint = true);
+
 /*
  * max(iterable, *[, default=obj, key=func]) -> value
  * max(arg1, arg2, *args, *[, key=func]) -> value
@@ -139,7 +365,18 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(double start, double end, int num,
 template <class Iterable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_max(Iterable first, Iterable last, Iterable* const result)
 {
-    *result = std::max_element(first, last);
+    if constexpr (cppy::internal::is_simd_reducible_v<Iterable>)
+    {
+        using T = typename std::iterator_traits<Iterable>::value_type;
+        *result = last;
+        cppy::internal::Reducer<T> reducer(CPPY_REDUCE_t::ArgMax, CPPY_SUM_t::Fast);
+        cppy::internal::reduce_range(first, last, 0, &reducer);
+        CPPY_Reduction<T> reduction;
+        if (reducer.finish(&reduction) == CPPY_ERROR_t::Ok)
+            *result = first + static_cast<std::ptrdiff_t>(reduction.argmax);
+    }
+    else
+        *result = std::max_element(first, last);
     return CPPY_ERROR_t::Ok;
 }
 
@@ -155,7 +392,88 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_max(Iterable first, Iterable last, Iterable*
 template <class Iterable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_min(Iterable first, Iterable last, Iterable* const result)
 {
-    *result = std::min_element(first, last);
+    if constexpr (cppy::internal::is_simd_reducible_v<Iterable>)
+    {
+        using T = typename std::iterator_traits<Iterable>::value_type;
+        *result = last;
+        cppy::internal::Reducer<T> reducer(CPPY_REDUCE_t::ArgMin, CPPY_SUM_t::Fast);
+        cppy::internal::reduce_range(first, last, 0, &reducer);
+        CPPY_Reduction<T> reduction;
+        if (reducer.finish(&reduction) == CPPY_ERROR_t::Ok)
+            *result = first + static_cast<std::ptrdiff_t>(reduction.argmin);
+    }
+    else
+        *result = std::min_element(first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+/*
+ * Find the n largest elements in a dataset.
+ *
+ * Equivalent to: sorted(iterable, key=key, reverse=True)[:n]
+ *
+ * A heap of the n best elements seen so far is kept, so the dataset is read
+ * once and never sorted as a whole. The results are written largest first.
+ */
+template <class Iterable, class Callable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nlargest(Iterable first, Iterable last, int n, Callable key, OutputIter result)
+{
+    using Rank = cppy::internal::TopRank<true>;
+    const std::size_t k = n > 0 ? static_cast<std::size_t>(n) : 0;
+    auto entries = cppy::internal::top_k<Rank>(first, last, k, key);
+    cppy::internal::write_ranked<Rank>(&entries, k, result);
+    return CPPY_ERROR_t::Ok;
+}
+template <class Iterable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nlargest(Iterable first, Iterable last, int n, OutputIter result)
+{
+    return CPPY_BUILTINS_nlargest(first, last, n, cppy::internal::Identity(), result);
+}
+
+/*
+ * Find the n smallest elements in a dataset.
+ *
+ * Equivalent to: sorted(iterable, key=key)[:n]
+ */
+template <class Iterable, class Callable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nsmallest(Iterable first, Iterable last, int n, Callable key, OutputIter result)
+{
+    using Rank = cppy::internal::TopRank<false>;
+    const std::size_t k = n > 0 ? static_cast<std::size_t>(n) : 0;
+    auto entries = cppy::internal::top_k<Rank>(first, last, k, key);
+    cppy::internal::write_ranked<Rank>(&entries, k, result);
+    return CPPY_ERROR_t::Ok;
+}
+template <class Iterable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nsmallest(Iterable first, Iterable last, int n, OutputIter result)
+{
+    return CPPY_BUILTINS_nsmallest(first, last, n, cppy::internal::Identity(), result);
+}
+
+/*
+ * Parallel nlargest / nsmallest over a random-access range.
+ *
+ * Each worker keeps the top n of its own chunk; the per-chunk lists are merged
+ * on the calling thread. Results and tie order are the same as the serial calls.
+ */
+template <class Iterable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nlargest(
+    CPPY_CONCURRENT_ThreadPoolExecutor* const executor, Iterable first, Iterable last, int n, OutputIter result)
+{
+    using Rank = cppy::internal::TopRank<true>;
+    const std::size_t k = n > 0 ? static_cast<std::size_t>(n) : 0;
+    auto entries = cppy::internal::parallel_top_k<Rank>(executor, first, last, k, cppy::internal::Identity());
+    cppy::internal::write_ranked<Rank>(&entries, k, result);
+    return CPPY_ERROR_t::Ok;
+}
+template <class Iterable, class OutputIter>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_nsmallest(
+    CPPY_CONCURRENT_ThreadPoolExecutor* const executor, Iterable first, Iterable last, int n, OutputIter result)
+{
+    using Rank = cppy::internal::TopRank<false>;
+    const std::size_t k = n > 0 ? static_cast<std::size_t>(n) : 0;
+    auto entries = cppy::internal::parallel_top_k<Rank>(executor, first, last, k, cppy::internal::Identity());
+    cppy::internal::write_ranked<Rank>(&entries, k, result);
     return CPPY_ERROR_t::Ok;
 }
 
@@ -171,6 +489,12 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_reversed(Iterable first, Iterable last)
 
 /*
  * Create a slice object.  This is used for extended slicing.
+ *
+ * Copies the elements seq[start:stop:step] selects to result, with Python's rules for
+ * negative and out-of-range indices and for negative steps. Raises ValueError if step is 0.
+ *
+ * The sequence is walked once, stepping from one selected element to the next; contiguous
+ * trivially copyable data is gathered a block at a time, and a step of 1 is a single copy.
  */
 template <class Iterable, class OutputIter>
 CPPY_API CPPY_ERROR_t
@@ -178,47 +502,30 @@ CPPY_BUILTINS_slice(Iterable first, Iterable last, int start, int stop, int step
 {
     if (step == 0)
         return CPPY_ERROR_t::ValueError;
-    const int len = static_cast<int>(std::distance(first, last));
-    if (step > 0)
-    {
-        if (start < 0)
-            start += len;
-        if (stop < 0)
-            stop += len;
-        if (start < 0)
-            start = 0;
-        if (stop > len)
-            stop = len;
-        if (start >= len || start >= stop)
-            return CPPY_ERROR_t::Ok;
-        for (int i = start; i < stop; i += step)
-        {
-            auto it = first;
-            std::advance(it, i);
-            *result = *it;
-            ++result;
-        }
-    }
-    else
-    {
-        if (start < 0)
-            start += len;
-        if (stop < 0)
-            stop += len;
-        if (start >= len)
-            start = len - 1;
-        if (stop < -1)
-            stop = -1;
-        if (start < 0 || start <= stop)
-            return CPPY_ERROR_t::Ok;
-        for (int i = start; i > stop; i += step)
-        {
-            auto it = first;
-            std::advance(it, i);
-            *result = *it;
-            ++result;
-        }
-    }
+    std::ptrdiff_t begin, count;
+    cppy::internal::slice_indices<std::ptrdiff_t>(std::distance(first, last), start, stop, step, &begin, &count);
+    cppy::internal::slice_copy(first, begin, step, static_cast<std::size_t>(count), result);
+    return CPPY_ERROR_t::Ok;
+}
+
+/*
+ * Lazy slice: set up a view of the elements seq[start:stop:step] selects, without copying.
+ * A negative step needs a bidirectional iterator, otherwise NotImplementedError is raised.
+ */
+template <class Iterable>
+CPPY_API CPPY_ERROR_t
+CPPY_BUILTINS_slice(Iterable first, Iterable last, int start, int stop, int step, CPPY_Slice_view<Iterable>* const result)
+{
+    using category = typename std::iterator_traits<Iterable>::iterator_category;
+    if (step == 0)
+        return CPPY_ERROR_t::ValueError;
+    if (step < 0 && !std::is_base_of_v<std::bidirectional_iterator_tag, category>)
+        return CPPY_ERROR_t::NotImplementedError;
+    std::ptrdiff_t begin, count;
+    cppy::internal::slice_indices<std::ptrdiff_t>(std::distance(first, last), start, stop, step, &begin, &count);
+    if (count > 0)
+        std::advance(first, begin);
+    *result = CPPY_Slice_view<Iterable>(first, step, static_cast<std::size_t>(count));
     return CPPY_ERROR_t::Ok;
 }
 
@@ -227,22 +534,37 @@ CPPY_BUILTINS_slice(Iterable first, Iterable last, int start, int stop, int step
  *
  * A custom key function can be supplied to customize the sort order, and the
  * reverse flag can be set to request the result in descending order.
+ * The sort is stable: equal elements keep their relative order.
  */
 template <typename Iterable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_sorted(Iterable first, Iterable last, bool reverse = false)
 {
-    std::sort(first, last);
+    using T = typename std::iterator_traits<Iterable>::value_type;
     if (reverse)
-        std::reverse(first, last);
+        cppy::internal::sort_stable(first, last, std::greater<T>());
+    else
+        cppy::internal::sort_stable(first, last, std::less<T>());
     return CPPY_ERROR_t::Ok;
 }
 
 template <typename Iterable, typename Callable>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_sorted(Iterable first, Iterable last, Callable key, bool reverse = false)
 {
-    std::sort(first, last, [&](const auto& a, const auto& b) { return key(a) < key(b); });
+    cppy::internal::sort_by_key(first, last, key, reverse);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename Iterable>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_sorted(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                           Iterable first,
+                                           Iterable last,
+                                           bool reverse = false)
+{
+    using T = typename std::iterator_traits<Iterable>::value_type;
     if (reverse)
-        std::reverse(first, last);
+        cppy::internal::parallel_sort(executor, first, last, std::greater<T>());
+    else
+        cppy::internal::parallel_sort(executor, first, last, std::less<T>());
     return CPPY_ERROR_t::Ok;
 }
 
@@ -256,6 +578,84 @@ CPPY_API CPPY_ERROR_t CPPY_BUILTINS_sorted(Iterable first, Iterable last, Callab
 template <class Iterable, typename AddableT>
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_sum(Iterable first, Iterable last, AddableT start, AddableT* const result)
 {
-    *result = std::accumulate(first, last, start);
+    if constexpr (cppy::internal::is_simd_reducible_v<Iterable> && std::is_arithmetic_v<AddableT>)
+    {
+        // floats are summed with compensation, as Python does since 3.12
+        using T = typename std::iterator_traits<Iterable>::value_type;
+        cppy::internal::Reducer<T> reducer(CPPY_REDUCE_t::Sum, CPPY_SUM_t::Kahan);
+        cppy::internal::reduce_range(first, last, 0, &reducer);
+        CPPY_Reduction<T> reduction;
+        reducer.finish(&reduction);
+        *result = static_cast<AddableT>(start + reduction.sum);
+    }
+    else
+        *result = std::accumulate(first, last, start);
     return CPPY_ERROR_t::Ok;
 }
+
+/*
+ * Return an accurate floating point sum of values in the iterable.
+ *
+ * Assumes IEEE-754 floating point arithmetic. The result is correctly
+ * rounded: it does not depend on the order of the values.
+ * Raises ValueError for inf - inf and OverflowError if an intermediate
+ * sum overflows.
+ *
+ * >>> fsum([0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1, 0.1])
+ * 1.0
+ */
+template <class Iterable>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_fsum(Iterable first, Iterable last, double* const result)
+{
+    cppy::internal::Fsum sum;
+    for (; first != last; ++first)
+        sum.add(static_cast<double>(*first));
+    return sum.value(result);
+}
+
+/*
+ * Compute any combination of min, max, sum, argmin, argmax and mean in one pass.
+ *
+ * The same as calling min(), max(), sum() and so on separately, but the data is
+ * read once. Contiguous int, float and double data is reduced in SIMD lanes.
+ * min/max and argmin/argmax return the first occurrence, like min() and max().
+ * Floating point sums are added as `mode` says (see CPPY_SUM_t); the mean is the
+ * sum divided by the count.
+ *
+ * Raises ValueError if the iterable is empty and anything but the sum is asked
+ * for. With CPPY_SUM_t::Exact the sum fails like math.fsum().
+ *
+ *  >>> reduce([3, 1, 4, 1, 5], Min | ArgMin | Sum)
+ *  min = 1, argmin = 1, sum = 14
+ */
+template <class Iterable, typename T>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_reduce(Iterable first,
+                                           Iterable last,
+                                           CPPY_REDUCE_t what,
+                                           CPPY_Reduction<T>* const result,
+                                           CPPY_SUM_t mode = CPPY_SUM_t::Pairwise)
+{
+    cppy::internal::Reducer<T> reducer(what, mode);
+    cppy::internal::reduce_range(first, last, 0, &reducer);
+    return reducer.finish(result);
+}
+
+/*
+ * Parallel reduce over a random-access range.
+ *
+ * Chunks are reduced on the executor and combined in order, so min/max and the
+ * arg positions are the same as the serial call. Exact sums are identical too;
+ * the other sum modes may round differently.
+ */
+template <class Iterable, typename T>
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_reduce(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                           Iterable first,
+                                           Iterable last,
+                                           CPPY_REDUCE_t what,
+                                           CPPY_Reduction<T>* const result,
+                                           CPPY_SUM_t mode = CPPY_SUM_t::Pairwise)
+{
+    cppy::internal::Reducer<T> reducer(what, mode);
+    cppy::internal::parallel_reduce_range(executor, first, last, what, mode, &reducer);
+    return reducer.finish(result);
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "cppy/coroutine.h needs C++20 coroutines: configure cppy with -DCPPY_COROUTINES=ON"
+#endif
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "cppy/future.h"
+#include "cppy/thread.h"
+
+template <typename T = void>
+class CPPY_CONCURRENT_Task;
+
+namespace cppy
+{
+namespace internal
+{
+// Ends a task by resuming the coroutine that awaited it, if any. Returning its handle from
+//  await_suspend is symmetric transfer: the awaiting coroutine resumes in place of this one
+//  instead of on top of it, so a loop awaiting tasks that finish at once does not grow the
+//  stack.
+struct TaskFinalAwaiter
+{
+    bool await_ready() noexcept { return false; }
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+    {
+        if (std::coroutine_handle<> continuation = coroutine.promise().continuation)
+            return continuation;
+        return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+};
+
+// What a task returned or threw, and who awaits it.
+template <typename T>
+class TaskPromiseBase
+{
+public:
+    CPPY_CONCURRENT_Task<T> get_return_object() noexcept;
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    TaskFinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { _result.template emplace<2>(std::current_exception()); }
+
+    T take()
+    {
+        if (_result.index() == 2)
+            std::rethrow_exception(std::get<2>(_result));
+        if constexpr (!std::is_void_v<T>)
+            return std::move(std::get<1>(_result));
+    }
+
+    std::coroutine_handle<> continuation;
+
+protected:
+    std::variant<std::monostate, future_value_t<T>, std::exception_ptr> _result;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase<T>
+{
+public:
+    template <class U = T>
+    void return_value(U&& value)
+    {
+        this->_result.template emplace<1>(std::forward<U>(value));
+    }
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase<void>
+{
+public:
+    void return_void() noexcept { _result.emplace<1>(); }
+};
+
+template <typename T>
+CPPY_CONCURRENT_Task<T> TaskPromiseBase<T>::get_return_object() noexcept
+{
+    return CPPY_CONCURRENT_Task<T>(
+        std::coroutine_handle<TaskPromise<T>>::from_promise(static_cast<TaskPromise<T>&>(*this)));
+}
+
+// The coroutine CPPY_CONCURRENT_sync_wait runs a task in; it signals once the task is over.
+class SyncWait
+{
+public:
+    struct promise_type
+    {
+        SyncWait get_return_object() noexcept
+        {
+            return SyncWait(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept
+        {
+            struct Signal
+            {
+                bool await_ready() noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                {
+                    promise_type& promise = coroutine.promise();
+                    std::lock_guard<std::mutex> lock(promise.mutex);
+                    promise.done = true;
+                    promise.cv.notify_one();
+                }
+                void await_resume() noexcept {}
+            };
+            return Signal{};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+    };
+
+    explicit SyncWait(std::coroutine_handle<promise_type> coroutine) : _coroutine(coroutine) {}
+    SyncWait(const SyncWait&) = delete;
+    SyncWait& operator=(const SyncWait&) = delete;
+    ~SyncWait() { _coroutine.destroy(); }
+
+    // Start the coroutine on this thread and block until it has finished.
+    void run()
+    {
+        _coroutine.resume();
+        promise_type& promise = _coroutine.promise();
+        std::unique_lock<std::mutex> lock(promise.mutex);
+        promise.cv.wait(lock, [&]() { return promise.done; });
+    }
+
+private:
+    std::coroutine_handle<promise_type> _coroutine;
+};
+
+template <typename T>
+SyncWait sync_wait(CPPY_CONCURRENT_Task<T>& task, std::optional<future_value_t<T>>& value, std::exception_ptr& error)
+{
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await std::move(task);
+            value.emplace();
+        }
+        else
+            value.emplace(co_await std::move(task));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+}
+} // namespace internal
+} // namespace cppy
+
+/* A coroutine returning T, which starts when it is awaited.
+ *
+ *  A function that returns a CPPY_CONCURRENT_Task and uses co_await and co_return is a
+ *  coroutine; `co_await task` runs it and gives what it co_returns, or rethrows what it
+ *  throws. Inside it, co_await CPPY_CONCURRENT_schedule(pool) moves the rest of the
+ *  coroutine onto a worker of the pool, and co_await on a CPPY_CONCURRENT_Future from
+ *  pool.spawn() suspends until the future is done and resumes on that pool, so a pipeline
+ *  reads top to bottom and holds no thread while it waits:
+ *
+ *      CPPY_CONCURRENT_Task<size_t> count_words(CPPY_CONCURRENT_ThreadPoolExecutor& pool, std::string path)
+ *      {
+ *          std::string text = co_await pool.spawn(read_file, path);
+ *          co_return co_await pool.spawn(count, std::move(text));
+ *      }
+ *
+ *  CPPY_CONCURRENT_sync_wait runs a task from ordinary code. Tasks are move-only and can be
+ *  awaited once. Available when cppy is configured with CPPY_COROUTINES.
+ */
+template <typename T>
+class [[nodiscard]] CPPY_CONCURRENT_Task
+{
+public:
+    using promise_type = cppy::internal::TaskPromise<T>;
+    using value_type = T;
+
+    CPPY_CONCURRENT_Task() = default;
+    explicit CPPY_CONCURRENT_Task(std::coroutine_handle<promise_type> coroutine) : _coroutine(coroutine) {}
+    CPPY_CONCURRENT_Task(CPPY_CONCURRENT_Task&& other) noexcept : _coroutine(std::exchange(other._coroutine, nullptr))
+    {
+    }
+    CPPY_CONCURRENT_Task& operator=(CPPY_CONCURRENT_Task&& other) noexcept
+    {
+        std::swap(_coroutine, other._coroutine);
+        return *this;
+    }
+    ~CPPY_CONCURRENT_Task()
+    {
+        if (_coroutine)
+            _coroutine.destroy();
+    }
+
+    bool valid() const { return static_cast<bool>(_coroutine); }
+
+    // Run the task until it finishes and give its result to the awaiting coroutine, which
+    //  resumes on whichever thread the task finishes on.
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                coroutine.promise().continuation = awaiting;
+                return coroutine;
+            }
+            T await_resume() { return coroutine.promise().take(); }
+
+            std::coroutine_handle<promise_type> coroutine;
+        };
+        return Awaiter{_coroutine};
+    }
+
+private:
+    std::coroutine_handle<promise_type> _coroutine;
+};
+
+// Awaiting this suspends the coroutine and resumes it on a worker of `pool`.
+inline auto CPPY_CONCURRENT_schedule(CPPY_CONCURRENT_ThreadPoolExecutor& pool)
+{
+    struct Awaiter
+    {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> coroutine) { pool->post([coroutine]() { coroutine.resume(); }); }
+        void await_resume() const noexcept {}
+
+        CPPY_CONCURRENT_ThreadPoolExecutor* pool;
+    };
+    return Awaiter{&pool};
+}
+
+// Awaiting a future suspends the coroutine until the future is done, then resumes it where
+//  the future's continuations run: on the pool that spawned it.
+template <typename T>
+auto operator co_await(CPPY_CONCURRENT_Future<T>&& future)
+{
+    struct Awaiter
+    {
+        bool await_ready() const { return future.done(); }
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            // once the callback is in, the coroutine may resume, and this awaiter with it,
+            //  before on_ready returns: touch nothing of it afterwards
+            const cppy::internal::Scheduler scheduler = cppy::internal::FutureAccess::scheduler(future);
+            cppy::internal::FutureAccess::state(future)->on_ready(cppy::internal::Task::make([scheduler, coroutine]() {
+                scheduler(cppy::internal::Task::make([coroutine]() { coroutine.resume(); }));
+            }));
+        }
+        T await_resume() { return future.get(); }
+
+        CPPY_CONCURRENT_Future<T> future;
+    };
+    return Awaiter{std::move(future)};
+}
+
+// Run `task` on the calling thread until its first suspension, then block until it has
+//  finished, and return its result or rethrow its exception.
+template <typename T>
+T CPPY_CONCURRENT_sync_wait(CPPY_CONCURRENT_Task<T> task)
+{
+    std::optional<cppy::internal::future_value_t<T>> value;
+    std::exception_ptr error;
+    cppy::internal::sync_wait(task, value, error).run();
+    if (error)
+        std::rethrow_exception(error);
+    if constexpr (!std::is_void_v<T>)
+        return std::move(*value);
+}
@@ -3,13 +3,22 @@
 #include "cppy/builtins.h"
 #include "cppy/datetime.h"
 #include "cppy/exception.h"
+#include "cppy/flat_set.hpp"
+#include "cppy/future.h"
+#include "cppy/indexed_list.hpp"
 #include "cppy/int.h"
 #include "cppy/io.h"
 #include "cppy/list.hpp"
 #include "cppy/malloc.h"
 #include "cppy/platform.h"
 #include "cppy/random.h"
+#include "cppy/roaring.h"
 #include "cppy/set.hpp"
+#include "cppy/statistics.hpp"
 #include "cppy/str.h"
 #include "cppy/thread.h"
 #include "cppy/vector.hpp"
+
+#if defined(CPPY_COROUTINES)
+#include "cppy/coroutine.h"
+#endif
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "cppy/exception.h"
+#include "cppy/internal/declare.h"
+#include "cppy/internal/sort.h"
+
+/* Set backed by a contiguous sorted vector.
+ *
+ *  Building from n values is one sort + unique instead of n tree insertions,
+ *  and iteration walks contiguous memory. Single-element add/remove are O(n).
+ */
+template <typename T>
+struct CPPY_FlatSet
+{
+    using value_type = T;
+    using size_type = typename std::vector<T>::size_type;
+    using const_iterator = typename std::vector<T>::const_iterator;
+    using iterator = const_iterator;
+
+    std::vector<T> items; // sorted, unique
+
+    const_iterator begin() const { return items.begin(); }
+    const_iterator end() const { return items.end(); }
+    size_type size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+};
+
+namespace cppy
+{
+namespace internal
+{
+// lower_bound without a data-dependent branch: the loop trip count depends only on n
+// and the comparison result selects the next base with a conditional move.
+template <typename T>
+const T* branchless_lower_bound(const T* base, std::size_t n, const T& value)
+{
+    if (n == 0)
+        return base;
+    while (n > 1)
+    {
+        const std::size_t half = n / 2;
+        base = (base[half - 1] < value) ? base + half : base;
+        n -= half;
+    }
+    return base + (*base < value);
+}
+
+template <typename T>
+typename std::vector<T>::const_iterator flat_set_find(const std::vector<T>& items, const T& element)
+{
+    const T* pos = branchless_lower_bound(items.data(), items.size(), element);
+    auto it = items.begin() + (pos - items.data());
+    if (it != items.end() && !(element < *it))
+        return it;
+    return items.end();
+}
+
+// Copy [first, last) into a sorted, duplicate-free vector, skipping the sort for sorted input.
+template <typename T, class Iterable>
+std::vector<T> sorted_unique(Iterable first, Iterable last)
+{
+    std::vector<T> values(first, last);
+    if (!std::is_sorted(values.begin(), values.end()))
+        cppy::internal::sort_unstable(values.begin(), values.end(), std::less<T>());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+} // namespace internal
+} // namespace cppy
+
+/* set(iterable) -> new set object
+ *
+ *  Build an unordered collection of unique elements.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_SET_init(CPPY_FlatSet<T>* const self, Iterable first, Iterable last)
+{
+    self->items = cppy::internal::sorted_unique<T>(first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_SET_iscontain(const CPPY_FlatSet<T>& self, const T& element, bool* const result)
+{
+    *result = cppy::internal::flat_set_find(self.items, element) != self.items.end();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Add an element to a set.
+ *
+ *  This has no effect if the element is already present.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_add(CPPY_FlatSet<T>* const self, const T& element)
+{
+    auto it = std::lower_bound(self->items.begin(), self->items.end(), element);
+    if (it == self->items.end() || element < *it)
+        self->items.insert(it, element);
+    return CPPY_ERROR_t::Ok;
+}
+template <typename T>
+CPPY_ERROR_t CPPY_SET_add(CPPY_FlatSet<T>* const self, T&& element)
+{
+    auto it = std::lower_bound(self->items.begin(), self->items.end(), element);
+    if (it == self->items.end() || element < *it)
+        self->items.insert(it, std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove all elements from this set.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_clear(CPPY_FlatSet<T>* const self)
+{
+    self->items.clear();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return a shallow copy of a set.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_copy(const CPPY_FlatSet<T>& self, CPPY_FlatSet<T>* const result)
+{
+    result->items = self.items;
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the difference of two or more sets as a new set.
+ *
+ *  (i.e. all elements that are in this set but not the others.)
+ */
+template <typename T, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_difference(
+    Iterable1 first_1, Iterable1 last_1, Iterable2 first_2, Iterable2 last_2, CPPY_FlatSet<T>* const result)
+{
+    result->items.clear();
+    std::set_difference(first_1, last_1, first_2, last_2, std::back_inserter(result->items));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove all elements of another set from this set.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_SET_difference_update(CPPY_FlatSet<T>* const self, Iterable first, Iterable last)
+{
+    std::vector<T> other = cppy::internal::sorted_unique<T>(first, last);
+    std::vector<T> result;
+    std::set_difference(
+        self->items.begin(), self->items.end(), other.begin(), other.end(), std::back_inserter(result));
+    self->items.swap(result);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the intersection of two sets as a new set.
+ *
+ *  (i.e. all elements that are in both sets.)
+ */
+template <typename T, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_intersection(
+    Iterable1 first_1, Iterable1 last_1, Iterable2 first_2, Iterable2 last_2, CPPY_FlatSet<T>* const result)
+{
+    result->items.clear();
+    std::set_intersection(first_1, last_1, first_2, last_2, std::back_inserter(result->items));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Update a set with the intersection of itself and another.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_SET_intersection_update(CPPY_FlatSet<T>* const self, Iterable first, Iterable last)
+{
+    std::vector<T> other = cppy::internal::sorted_unique<T>(first, last);
+    std::vector<T> result;
+    std::set_intersection(
+        self->items.begin(), self->items.end(), other.begin(), other.end(), std::back_inserter(result));
+    self->items.swap(result);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the symmetric difference of two sets as a new set.
+ *
+ *  (i.e. all elements that are in exactly one of the sets.)
+ */
+template <typename T, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_symmetric_difference(
+    Iterable1 first_1, Iterable1 last_1, Iterable2 first_2, Iterable2 last_2, CPPY_FlatSet<T>* const result)
+{
+    result->items.clear();
+    std::set_symmetric_difference(first_1, last_1, first_2, last_2, std::back_inserter(result->items));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Update a set with the symmetric difference of itself and another.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_SET_symmetric_difference_update(CPPY_FlatSet<T>* const self, Iterable first, Iterable last)
+{
+    std::vector<T> other = cppy::internal::sorted_unique<T>(first, last);
+    std::vector<T> result;
+    std::set_symmetric_difference(
+        self->items.begin(), self->items.end(), other.begin(), other.end(), std::back_inserter(result));
+    self->items.swap(result);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the union of sets as a new set.
+ *
+ *  (i.e. all elements that are in either set.)
+ */
+template <typename T, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_union(
+    Iterable1 first_1, Iterable1 last_1, Iterable2 first_2, Iterable2 last_2, CPPY_FlatSet<T>* const result)
+{
+    result->items.clear();
+    std::set_union(first_1, last_1, first_2, last_2, std::back_inserter(result->items));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Update a set with the union of itself and others.
+ *
+ *  The new elements are appended, sorted, and merged into place in one pass.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_SET_update(CPPY_FlatSet<T>* const self, Iterable first, Iterable last)
+{
+    auto& items = self->items;
+    const auto middle = static_cast<typename std::vector<T>::difference_type>(items.size());
+    items.insert(items.end(), first, last);
+    if (!std::is_sorted(items.begin() + middle, items.end()))
+        cppy::internal::sort_unstable(items.begin() + middle, items.end(), std::less<T>());
+    std::inplace_merge(items.begin(), items.begin() + middle, items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove and return an arbitrary set element.
+ *  Raises KeyError if the set is empty.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_pop(CPPY_FlatSet<T>* const self, T* const element)
+{
+    if (self->items.empty())
+        return CPPY_ERROR_t::KeyError;
+
+    *element = std::move(self->items.back());
+    self->items.pop_back();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove an element from a set; it must be a member.
+ *
+ *  If the element is not a member, raise a KeyError.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_remove(CPPY_FlatSet<T>* const self, const T& element)
+{
+    auto it = cppy::internal::flat_set_find(self->items, element);
+    if (it == self->items.end())
+        return CPPY_ERROR_t::KeyError;
+
+    self->items.erase(it);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove an element from a set if it is a member.
+ *
+ *  Unlike set.remove(), the discard() method does not raise
+ *  an exception when an element is missing from the set.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_discard(CPPY_FlatSet<T>* const self, const T& element)
+{
+    auto it = cppy::internal::flat_set_find(self->items, element);
+    if (it != self->items.end())
+        self->items.erase(it);
+    return CPPY_ERROR_t::Ok;
+}
@@ -0,0 +1,753 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cppy/internal/declare.h"
+#include "cppy/internal/task.h"
+
+template <typename T>
+class CPPY_CONCURRENT_Future;
+
+namespace cppy
+{
+namespace internal
+{
+// What a future of void holds.
+struct Unit
+{
+};
+
+template <typename T>
+using future_value_t = std::conditional_t<std::is_void_v<T>, Unit, T>;
+
+// Where the continuations of a future run. An executor sets one on the futures it hands
+//  out; without one, a continuation runs on the thread that completes the future. The
+//  futures share `executor` with the executor, which may go first: schedule() must then
+//  run the task itself.
+struct Scheduler
+{
+    void (*schedule)(void* executor, Task* task) = nullptr;
+    std::shared_ptr<void> executor;
+
+    void operator()(Task* task) const
+    {
+        if (schedule != nullptr)
+            schedule(executor.get(), task);
+        else
+            task->run();
+    }
+};
+
+// The state a Promise and a CPPY_CONCURRENT_Future share: a value or an exception, a way
+//  to wait for either and the callbacks to run once there is one. States come from a
+//  FreeList and go back to it once both sides have let go, so the mutex and condition
+//  variable are built once and a spawn allocates nothing.
+template <typename T>
+class FutureState
+{
+public:
+    using value_type = future_value_t<T>;
+
+    static FutureState* make()
+    {
+        FutureState* state = FreeList<FutureState>::acquire();
+        state->_status.store(kPending, std::memory_order_relaxed);
+        state->_waiters.store(false, std::memory_order_relaxed);
+        state->_callbacks.store(nullptr, std::memory_order_relaxed);
+        state->_references.store(2, std::memory_order_relaxed);
+        return state;
+    }
+
+    // Drop one of the two references; the last one recycles the state.
+    void release()
+    {
+        if (_references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        if (_status.load(std::memory_order_relaxed) == kValue)
+            value().~value_type();
+        _error = nullptr;
+        FreeList<FutureState>::release(this);
+    }
+
+    template <class... Args>
+    void set_value(Args&&... args)
+    {
+        new (_storage) value_type(std::forward<Args>(args)...);
+        publish(kValue);
+    }
+
+    void set_exception(std::exception_ptr error)
+    {
+        _error = std::move(error);
+        publish(kError);
+    }
+
+    bool ready() const { return _status.load(std::memory_order_acquire) != kPending; }
+
+    void wait()
+    {
+        if (ready())
+            return;
+        std::unique_lock<std::mutex> lock(_mutex);
+        _waiters.store(true);
+        _cv.wait(lock, [this]() { return ready(); });
+    }
+
+    // Run `callback` once the state is ready: now if it already is, otherwise on the thread
+    //  that makes it ready. Callbacks are pushed on a lock-free stack, which publish()
+    //  swaps for a sentinel, so any number of them can be added from any thread.
+    void on_ready(Task* callback)
+    {
+        Task* head = _callbacks.load(std::memory_order_acquire);
+        do
+        {
+            if (head == fired())
+            {
+                callback->run();
+                return;
+            }
+            callback->next = head;
+        } while (!_callbacks.compare_exchange_weak(head, callback, std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
+    }
+
+    value_type& value() { return *std::launder(reinterpret_cast<value_type*>(_storage)); }
+    const std::exception_ptr& error() const { return _error; }
+
+private:
+    enum : int
+    {
+        kPending,
+        kValue,
+        kError,
+    };
+
+    static Task* fired() { return reinterpret_cast<Task*>(alignof(Task)); }
+
+    // The waiter sets _waiters before it checks the status, and the setter stores the status
+    //  before it checks _waiters, so one of them always sees the other. The mutex is only
+    //  taken when somebody waits.
+    void publish(int status)
+    {
+        _status.store(status);
+        if (_waiters.load())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+            }
+            _cv.notify_all();
+        }
+        Task* callback = _callbacks.exchange(fired(), std::memory_order_acq_rel);
+        while (callback != nullptr)
+        {
+            Task* const next = callback->next;
+            callback->run();
+            callback = next;
+        }
+    }
+
+    std::atomic<int> _status{kPending};
+    std::atomic<int> _references{0};
+    std::atomic<bool> _waiters{false};
+    std::atomic<Task*> _callbacks{nullptr};
+    alignas(value_type) unsigned char _storage[sizeof(value_type)];
+    std::exception_ptr _error;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+};
+
+// What the promises dropped on this thread store instead of broken_promise while an
+//  executor discards the tasks it has cancelled, and nullptr the rest of the time.
+inline thread_local const std::exception_ptr* dropped_error = nullptr;
+
+// The writing side of a FutureState. Dropping a promise that was never satisfied stores a
+//  broken_promise future_error, as std::promise does, or dropped_error.
+template <typename T>
+class Promise
+{
+public:
+    Promise() = default;
+    explicit Promise(FutureState<T>* state) : _state(state) {}
+    Promise(Promise&& other) noexcept : _state(std::exchange(other._state, nullptr)) {}
+    Promise& operator=(Promise&& other) noexcept
+    {
+        std::swap(_state, other._state);
+        return *this;
+    }
+    ~Promise()
+    {
+        if (_state == nullptr)
+            return;
+        if (!_state->ready())
+        {
+            if (dropped_error != nullptr)
+                _state->set_exception(*dropped_error);
+            else
+                _state->set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+        _state->release();
+    }
+
+    template <class... Args>
+    void set_value(Args&&... args)
+    {
+        _state->set_value(std::forward<Args>(args)...);
+    }
+
+    void set_exception(std::exception_ptr error) { _state->set_exception(std::move(error)); }
+
+    // Store what func() returns, or what it throws.
+    template <class Func>
+    void run(Func&& func) noexcept
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                std::forward<Func>(func)();
+                _state->set_value();
+            }
+            else
+                _state->set_value(std::forward<Func>(func)());
+        }
+        catch (...)
+        {
+            _state->set_exception(std::current_exception());
+        }
+    }
+
+private:
+    FutureState<T>* _state = nullptr;
+};
+
+template <typename T>
+struct is_future : std::false_type
+{
+};
+
+template <typename T>
+struct is_future<CPPY_CONCURRENT_Future<T>> : std::true_type
+{
+};
+
+// A continuation returning a future stands for that future's result.
+template <typename R>
+struct unwrap_future
+{
+    using type = R;
+};
+
+template <typename U>
+struct unwrap_future<CPPY_CONCURRENT_Future<U>>
+{
+    using type = U;
+};
+
+// What future.then(func) passes to func: the value of the finished future, or nothing for
+//  a future of void, and otherwise, when func only accepts that, the future itself.
+template <typename T>
+struct value_continuation
+{
+    template <class Func>
+    static constexpr bool accepts = std::is_invocable_v<Func&, T>;
+    template <class Func>
+    using result = std::invoke_result<Func&, T>;
+};
+
+template <>
+struct value_continuation<void>
+{
+    template <class Func>
+    static constexpr bool accepts = std::is_invocable_v<Func&>;
+    template <class Func>
+    using result = std::invoke_result<Func&>;
+};
+
+template <typename T, class Func, bool = value_continuation<T>::template accepts<Func>>
+struct continuation_result
+{
+    static constexpr bool takes_future = false;
+    using type = typename value_continuation<T>::template result<Func>::type;
+};
+
+template <typename T, class Func>
+struct continuation_result<T, Func, false>
+{
+    static constexpr bool takes_future = true;
+    using type = std::invoke_result_t<Func&, CPPY_CONCURRENT_Future<T>>;
+};
+
+// Reaches into futures for the combinators below.
+struct FutureAccess
+{
+    template <typename T>
+    static FutureState<T>* state(const CPPY_CONCURRENT_Future<T>& future)
+    {
+        return future._state;
+    }
+
+    template <typename T>
+    static Scheduler scheduler(const CPPY_CONCURRENT_Future<T>& future)
+    {
+        return future._scheduler;
+    }
+
+    // Run func on the thread that completes `future`, which must be valid.
+    template <typename T, class Func>
+    static void on_ready(const CPPY_CONCURRENT_Future<T>& future, Func&& func)
+    {
+        future._state->on_ready(Task::make(std::forward<Func>(func)));
+    }
+};
+} // namespace internal
+} // namespace cppy
+
+/* The result of a task spawned on a CPPY_CONCURRENT_ThreadPoolExecutor.
+ *
+ *  Like std::future, it is move-only and get() may be called once: it waits for the task,
+ *  then returns its value or rethrows its exception. Unlike std::future the shared state is
+ *  recycled, so creating one costs no allocation, and instead of waiting for the result a
+ *  later stage can be chained to it with then().
+ */
+template <typename T>
+class CPPY_CONCURRENT_Future
+{
+public:
+    using value_type = T;
+
+    CPPY_CONCURRENT_Future() = default;
+    // Take over one reference to `state`; used by the executor.
+    explicit CPPY_CONCURRENT_Future(cppy::internal::FutureState<T>* state,
+                                    cppy::internal::Scheduler scheduler = {})
+        : _state(state), _scheduler(std::move(scheduler))
+    {
+    }
+    CPPY_CONCURRENT_Future(CPPY_CONCURRENT_Future&& other) noexcept
+        : _state(std::exchange(other._state, nullptr)), _scheduler(std::move(other._scheduler))
+    {
+    }
+    CPPY_CONCURRENT_Future& operator=(CPPY_CONCURRENT_Future&& other) noexcept
+    {
+        std::swap(_state, other._state);
+        std::swap(_scheduler, other._scheduler);
+        return *this;
+    }
+    ~CPPY_CONCURRENT_Future()
+    {
+        if (_state != nullptr)
+            _state->release();
+    }
+
+    // Whether this future refers to a result, i.e. neither get() nor then() has been called.
+    bool valid() const { return _state != nullptr; }
+
+    // Return True if the task has finished, with a value or an exception.
+    bool done() const { return _state->ready(); }
+
+    void wait() const { _state->wait(); }
+
+    T get()
+    {
+        _state->wait();
+        struct Release
+        {
+            ~Release() { state->release(); }
+            cppy::internal::FutureState<T>* state;
+        } release{std::exchange(_state, nullptr)};
+        if (release.state->error())
+            std::rethrow_exception(release.state->error());
+        if constexpr (!std::is_void_v<T>)
+            return std::move(release.state->value());
+    }
+
+    /* Schedule func to run once this future is done, and return a future of its result.
+     *
+     *  func is called with the value of this future, or with no argument for a future of
+     *  void; an exception of this future then skips func and passes on to the result. A
+     *  func that takes a CPPY_CONCURRENT_Future<T> instead gets this future, done, and
+     *  handles errors itself. A func that returns a CPPY_CONCURRENT_Future<U> gives a
+     *  future of U, completed when the returned one is.
+     *
+     *  func runs as a task of the pool this future came from, and no thread waits in the
+     *  meantime. Like get(), then() consumes the future.
+     */
+    template <class Func>
+    auto then(Func&& func);
+
+private:
+    friend struct cppy::internal::FutureAccess;
+
+    cppy::internal::FutureState<T>* _state = nullptr;
+    cppy::internal::Scheduler _scheduler;
+};
+
+namespace cppy
+{
+namespace internal
+{
+// A std::promise that, like Promise, stores dropped_error when it is dropped while there is
+//  one.
+template <typename T>
+class StdPromise : public std::promise<T>
+{
+public:
+    StdPromise() = default;
+    StdPromise(StdPromise&&) noexcept = default;
+    StdPromise& operator=(StdPromise&&) noexcept = default;
+    ~StdPromise()
+    {
+        if (dropped_error == nullptr)
+            return;
+        try
+        {
+            this->set_exception(*dropped_error);
+        }
+        catch (const std::future_error&)
+        {
+            // satisfied already, or moved from
+        }
+    }
+};
+
+// A promise and the future it will satisfy.
+template <typename T>
+std::pair<Promise<T>, CPPY_CONCURRENT_Future<T>> make_promise(Scheduler scheduler = {})
+{
+    FutureState<T>* state = FutureState<T>::make();
+    return {Promise<T>(state), CPPY_CONCURRENT_Future<T>(state, std::move(scheduler))};
+}
+} // namespace internal
+} // namespace cppy
+
+template <typename T>
+template <class Func>
+auto CPPY_CONCURRENT_Future<T>::then(Func&& func)
+{
+    using Continuation = cppy::internal::continuation_result<T, std::decay_t<Func>>;
+    using R = typename Continuation::type;
+    using U = typename cppy::internal::unwrap_future<R>::type;
+
+    auto [promise, result] = cppy::internal::make_promise<U>(_scheduler);
+    cppy::internal::FutureState<T>* const state = _state;
+    const cppy::internal::Scheduler scheduler = _scheduler;
+    cppy::internal::Task* const work = cppy::internal::Task::make(
+        [promise = std::move(promise), source = std::move(*this), func = std::forward<Func>(func)]() mutable {
+            auto call = [&]() -> R {
+                if constexpr (Continuation::takes_future)
+                    return func(std::move(source));
+                else if constexpr (std::is_void_v<T>)
+                {
+                    source.get();
+                    return func();
+                }
+                else
+                    return func(source.get());
+            };
+            if constexpr (cppy::internal::is_future<R>::value)
+            {
+                // forward the inner future's result when it has one
+                R inner;
+                try
+                {
+                    inner = call();
+                    if (!inner.valid())
+                        throw std::future_error(std::future_errc::no_state);
+                }
+                catch (...)
+                {
+                    promise.set_exception(std::current_exception());
+                    return;
+                }
+                cppy::internal::FutureState<U>* const inner_state = cppy::internal::FutureAccess::state(inner);
+                inner_state->on_ready(cppy::internal::Task::make(
+                    [promise = std::move(promise), inner = std::move(inner)]() mutable {
+                        promise.run([&]() { return inner.get(); });
+                    }));
+            }
+            else
+                promise.run(call);
+        });
+    // the callback only hands the work to the scheduler, on whichever thread completes this
+    try
+    {
+        state->on_ready(cppy::internal::Task::make([scheduler, work]() { scheduler(work); }));
+    }
+    catch (...)
+    {
+        work->discard();
+        throw;
+    }
+    return std::move(result);
+}
+
+/* What CPPY_CONCURRENT_when_any gives: the futures it was passed, in the same order, and the
+ *  index of one that is done. index is SIZE_MAX when there were no futures.
+ */
+template <class Futures>
+struct CPPY_CONCURRENT_WhenAnyResult
+{
+    size_t index;
+    Futures futures;
+};
+
+namespace cppy
+{
+namespace internal
+{
+// The shared state of when_all: the futures, and how many callbacks are still to come. The
+//  count starts one higher and the caller drops that last, so the futures are not moved
+//  out while callbacks are still being added.
+template <class Futures>
+struct WhenAll
+{
+    void arrive()
+    {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            promise.set_value(std::move(futures));
+    }
+
+    Futures futures;
+    std::atomic<std::size_t> remaining{1};
+    Promise<Futures> promise;
+};
+
+// The shared state of when_any. The first future to finish records its index; the result
+//  is set once that has happened and every callback has been added.
+template <class Futures>
+struct WhenAny
+{
+    void win(std::size_t i)
+    {
+        if (!won.exchange(true, std::memory_order_acq_rel))
+        {
+            index = i;
+            arrive();
+        }
+    }
+
+    void arrive()
+    {
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            promise.set_value(CPPY_CONCURRENT_WhenAnyResult<Futures>{index, std::move(futures)});
+    }
+
+    Futures futures;
+    std::size_t index = SIZE_MAX;
+    std::atomic<bool> won{false};
+    std::atomic<int> remaining{2};
+    Promise<CPPY_CONCURRENT_WhenAnyResult<Futures>> promise;
+};
+
+// The order in which the futures of an as_completed finish, as indices into them.
+struct Completion
+{
+    void arrive(std::size_t i)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        }
+        cv.notify_one();
+    }
+
+    std::size_t wait(std::size_t k)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() { return order.size() > k; });
+        return order[k];
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::size_t> order;
+};
+
+template <typename T>
+struct future_of
+{
+};
+
+template <typename T>
+struct future_of<CPPY_CONCURRENT_Future<T>>
+{
+    using type = T;
+};
+
+template <class InputIt>
+using iterated_future_t = typename future_of<typename std::iterator_traits<InputIt>::value_type>::type;
+} // namespace internal
+} // namespace cppy
+
+/* A future of all the futures in [first, last), moved into a vector, done when every one of
+ *  them is. Their errors are not rethrown: call get() on each of them.
+ *
+ *  No thread waits: the last future to finish completes the result, and continuations of
+ *  the result run on the pool of the first future.
+ */
+template <class InputIt, typename T = cppy::internal::iterated_future_t<InputIt>>
+CPPY_CONCURRENT_Future<std::vector<CPPY_CONCURRENT_Future<T>>> CPPY_CONCURRENT_when_all(InputIt first, InputIt last)
+{
+    using Futures = std::vector<CPPY_CONCURRENT_Future<T>>;
+    auto block = std::make_shared<cppy::internal::WhenAll<Futures>>();
+    for (; first != last; ++first)
+        block->futures.push_back(std::move(*first));
+    auto [promise, result] = cppy::internal::make_promise<Futures>(
+        block->futures.empty() ? cppy::internal::Scheduler{}
+                               : cppy::internal::FutureAccess::scheduler(block->futures.front()));
+    block->promise = std::move(promise);
+    block->remaining.store(block->futures.size() + 1);
+    for (const CPPY_CONCURRENT_Future<T>& future : block->futures)
+        cppy::internal::FutureAccess::on_ready(future, [block]() { block->arrive(); });
+    block->arrive();
+    return std::move(result);
+}
+
+// A future of the tuple of the given futures, done when every one of them is.
+template <typename... Ts, std::enable_if_t<(sizeof...(Ts) > 0), int> = 0>
+CPPY_CONCURRENT_Future<std::tuple<CPPY_CONCURRENT_Future<Ts>...>> CPPY_CONCURRENT_when_all(
+    CPPY_CONCURRENT_Future<Ts>&&... futures)
+{
+    using Futures = std::tuple<CPPY_CONCURRENT_Future<Ts>...>;
+    auto block = std::make_shared<cppy::internal::WhenAll<Futures>>();
+    block->futures = Futures(std::move(futures)...);
+    auto [promise, result] = cppy::internal::make_promise<Futures>(
+        cppy::internal::FutureAccess::scheduler(std::get<0>(block->futures)));
+    block->promise = std::move(promise);
+    block->remaining.store(sizeof...(Ts) + 1);
+    std::apply(
+        [&](const auto&... future) {
+            (cppy::internal::FutureAccess::on_ready(future, [block]() { block->arrive(); }), ...);
+        },
+        block->futures);
+    block->arrive();
+    return std::move(result);
+}
+
+/* A future of all the futures in [first, last), done as soon as one of them is, with the
+ *  index of that one. The others keep running.
+ */
+template <class InputIt, typename T = cppy::internal::iterated_future_t<InputIt>>
+CPPY_CONCURRENT_Future<CPPY_CONCURRENT_WhenAnyResult<std::vector<CPPY_CONCURRENT_Future<T>>>>
+CPPY_CONCURRENT_when_any(InputIt first, InputIt last)
+{
+    using Futures = std::vector<CPPY_CONCURRENT_Future<T>>;
+    auto block = std::make_shared<cppy::internal::WhenAny<Futures>>();
+    for (; first != last; ++first)
+        block->futures.push_back(std::move(*first));
+    auto [promise, result] = cppy::internal::make_promise<CPPY_CONCURRENT_WhenAnyResult<Futures>>(
+        block->futures.empty() ? cppy::internal::Scheduler{}
+                               : cppy::internal::FutureAccess::scheduler(block->futures.front()));
+    block->promise = std::move(promise);
+    if (block->futures.empty())
+        block->remaining.store(1);
+    for (std::size_t i = 0; i < block->futures.size(); ++i)
+        cppy::internal::FutureAccess::on_ready(block->futures[i], [block, i]() { block->win(i); });
+    block->arrive();
+    return std::move(result);
+}
+
+// A future of the tuple of the given futures, done as soon as one of them is.
+template <typename... Ts, std::enable_if_t<(sizeof...(Ts) > 0), int> = 0>
+CPPY_CONCURRENT_Future<CPPY_CONCURRENT_WhenAnyResult<std::tuple<CPPY_CONCURRENT_Future<Ts>...>>>
+CPPY_CONCURRENT_when_any(CPPY_CONCURRENT_Future<Ts>&&... futures)
+{
+    using Futures = std::tuple<CPPY_CONCURRENT_Future<Ts>...>;
+    auto block = std::make_shared<cppy::internal::WhenAny<Futures>>();
+    block->futures = Futures(std::move(futures)...);
+    auto [promise, result] = cppy::internal::make_promise<CPPY_CONCURRENT_WhenAnyResult<Futures>>(
+        cppy::internal::FutureAccess::scheduler(std::get<0>(block->futures)));
+    block->promise = std::move(promise);
+    std::size_t i = 0;
+    std::apply(
+        [&](const auto&... future) {
+            (cppy::internal::FutureAccess::on_ready(future, [block, index = i++]() { block->win(index); }), ...);
+        },
+        block->futures);
+    block->arrive();
+    return std::move(result);
+}
+
+/* Python's concurrent.futures.as_completed: iterating it yields the futures it was given,
+ *  each one as soon as it is done, in the order they finish.
+ *
+ *  Moving to the next future waits until there is one; the iteration is the only place that
+ *  waits. The object owns the futures, and get() may be called on each one it yields.
+ */
+template <typename T>
+class CPPY_CONCURRENT_AsCompleted
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = CPPY_CONCURRENT_Future<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = CPPY_CONCURRENT_Future<T>*;
+        using reference = CPPY_CONCURRENT_Future<T>&;
+
+        iterator(CPPY_CONCURRENT_AsCompleted* owner, size_t position) : _owner(owner), _position(position) {}
+
+        reference operator*() const
+        {
+            if (_index == npos)
+                _index = _owner->_completion->wait(_position);
+            return _owner->_futures[_index];
+        }
+        pointer operator->() const { return &**this; }
+        iterator& operator++()
+        {
+            ++_position;
+            _index = npos;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return _position == other._position; }
+        bool operator!=(const iterator& other) const { return _position != other._position; }
+
+    private:
+        static constexpr size_t npos = SIZE_MAX;
+
+        CPPY_CONCURRENT_AsCompleted* _owner;
+        size_t _position;
+        mutable size_t _index = npos;
+    };
+
+    template <class InputIt>
+    CPPY_CONCURRENT_AsCompleted(InputIt first, InputIt last)
+        : _completion(std::make_shared<cppy::internal::Completion>())
+    {
+        for (; first != last; ++first)
+            _futures.push_back(std::move(*first));
+        _completion->order.reserve(_futures.size());
+        for (size_t i = 0; i < _futures.size(); ++i)
+            cppy::internal::FutureAccess::on_ready(
+                _futures[i], [completion = _completion, i]() { completion->arrive(i); });
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, _futures.size()); }
+    size_t size() const { return _futures.size(); }
+
+private:
+    std::vector<CPPY_CONCURRENT_Future<T>> _futures;
+    std::shared_ptr<cppy::internal::Completion> _completion;
+};
+
+template <class InputIt, typename T = cppy::internal::iterated_future_t<InputIt>>
+CPPY_CONCURRENT_AsCompleted<T> CPPY_CONCURRENT_as_completed(InputIt first, InputIt last)
+{
+    return CPPY_CONCURRENT_AsCompleted<T>(first, last);
+}
@@ -0,0 +1,507 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cppy/exception.h"
+#include "cppy/internal/declare.h"
+#include "cppy/internal/sort.h"
+#include "cppy/typing.hpp"
+
+/* List with cheap positional access and positional insert/pop (tiered vector).
+ *
+ *  Elements live in a sequence of non-empty blocks of about sqrt(n) elements each, and
+ *  a prefix-count table maps a position to its block with a binary search. Indexing is
+ *  O(log n); insert and pop at any position shift one block and update the prefix
+ *  counts of the blocks after it, both O(sqrt(n)).
+ */
+template <typename T>
+class CPPY_IndexedList
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    template <bool Const>
+    class basic_iterator
+    {
+        using list_type = std::conditional_t<Const, const CPPY_IndexedList, CPPY_IndexedList>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        basic_iterator() = default;
+        basic_iterator(list_type* owner, size_type block, size_type offset)
+            : _owner(owner), _block(block), _offset(offset)
+        {
+        }
+
+        operator basic_iterator<true>() const { return basic_iterator<true>(_owner, _block, _offset); }
+
+        reference operator*() const { return _owner->_blocks[_block][_offset]; }
+        pointer operator->() const { return &_owner->_blocks[_block][_offset]; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        basic_iterator& operator++()
+        {
+            if (++_offset == _owner->_blocks[_block].size())
+            {
+                ++_block;
+                _offset = 0;
+            }
+            return *this;
+        }
+        basic_iterator operator++(int)
+        {
+            basic_iterator it = *this;
+            ++*this;
+            return it;
+        }
+        basic_iterator& operator--()
+        {
+            if (_offset == 0)
+                _offset = _owner->_blocks[--_block].size();
+            --_offset;
+            return *this;
+        }
+        basic_iterator operator--(int)
+        {
+            basic_iterator it = *this;
+            --*this;
+            return it;
+        }
+        basic_iterator& operator+=(difference_type n)
+        {
+            const auto position = static_cast<difference_type>(index()) + n;
+            *this = _owner->template _iterator_at<Const>(static_cast<size_type>(position));
+            return *this;
+        }
+        basic_iterator& operator-=(difference_type n) { return *this += -n; }
+        basic_iterator operator+(difference_type n) const
+        {
+            basic_iterator it = *this;
+            return it += n;
+        }
+        friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+        basic_iterator operator-(difference_type n) const
+        {
+            basic_iterator it = *this;
+            return it -= n;
+        }
+        difference_type operator-(const basic_iterator& other) const
+        {
+            return static_cast<difference_type>(index()) - static_cast<difference_type>(other.index());
+        }
+
+        bool operator==(const basic_iterator& other) const
+        {
+            return _block == other._block && _offset == other._offset;
+        }
+        bool operator!=(const basic_iterator& other) const { return !(*this == other); }
+        bool operator<(const basic_iterator& other) const
+        {
+            return _block < other._block || (_block == other._block && _offset < other._offset);
+        }
+        bool operator>(const basic_iterator& other) const { return other < *this; }
+        bool operator<=(const basic_iterator& other) const { return !(other < *this); }
+        bool operator>=(const basic_iterator& other) const { return !(*this < other); }
+
+        // Position of the element in the list.
+        size_type index() const { return _owner->_offsets[_block] + _offset; }
+
+    private:
+        list_type* _owner = nullptr;
+        size_type _block = 0;
+        size_type _offset = 0;
+    };
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    CPPY_IndexedList() : _offsets{0} {}
+
+    template <class Iterable>
+    CPPY_IndexedList(Iterable first, Iterable last) : CPPY_IndexedList()
+    {
+        assign(first, last);
+    }
+
+    CPPY_IndexedList(std::initializer_list<T> values) : CPPY_IndexedList(values.begin(), values.end()) {}
+
+    iterator begin() { return iterator(this, 0, 0); }
+    iterator end() { return iterator(this, _blocks.size(), 0); }
+    const_iterator begin() const { return const_iterator(this, 0, 0); }
+    const_iterator end() const { return const_iterator(this, _blocks.size(), 0); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_type size() const { return _offsets.back(); }
+    bool empty() const { return size() == 0; }
+
+    reference operator[](size_type index)
+    {
+        const size_type block = _locate(index);
+        return _blocks[block][index - _offsets[block]];
+    }
+    const_reference operator[](size_type index) const
+    {
+        const size_type block = _locate(index);
+        return _blocks[block][index - _offsets[block]];
+    }
+
+    void clear()
+    {
+        _blocks.clear();
+        _offsets.assign(1, 0);
+    }
+
+    // Replace the contents, packing the elements into full blocks.
+    template <class Iterable>
+    void assign(Iterable first, Iterable last)
+    {
+        std::vector<T> values(first, last);
+        _rebuild(&values);
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        if (_blocks.empty() || _blocks.back().size() >= 2 * _block_target())
+        {
+            _blocks.emplace_back();
+            _blocks.back().reserve(2 * _block_target());
+            _offsets.push_back(_offsets.back());
+        }
+        _blocks.back().emplace_back(std::forward<Args>(args)...);
+        ++_offsets.back();
+    }
+
+    // Insert before position `index` (0 <= index <= size()).
+    void insert(size_type index, const T& value) { emplace(index, value); }
+    void insert(size_type index, T&& value) { emplace(index, std::move(value)); }
+
+    template <typename... Args>
+    void emplace(size_type index, Args&&... args)
+    {
+        if (index == size())
+        {
+            emplace_back(std::forward<Args>(args)...);
+            return;
+        }
+        const size_type block = _locate(index);
+        _blocks[block].emplace(_blocks[block].begin() + (index - _offsets[block]), std::forward<Args>(args)...);
+        for (size_type b = block + 1; b < _offsets.size(); ++b)
+            ++_offsets[b];
+        if (_blocks[block].size() > 2 * _block_target())
+            _split(block);
+    }
+
+    // Remove the element at position `index` (0 <= index < size()).
+    void erase(size_type index)
+    {
+        const size_type block = _locate(index);
+        _blocks[block].erase(_blocks[block].begin() + (index - _offsets[block]));
+        for (size_type b = block + 1; b < _offsets.size(); ++b)
+            --_offsets[b];
+        if (_blocks[block].empty())
+        {
+            _blocks.erase(_blocks.begin() + block);
+            _offsets.erase(_offsets.begin() + block + 1);
+        }
+        else if (block + 1 < _blocks.size() &&
+                 _blocks[block].size() + _blocks[block + 1].size() <= _block_target())
+        {
+            // merge small neighbours so the block count stays near sqrt(n)
+            _blocks[block].insert(_blocks[block].end(), std::make_move_iterator(_blocks[block + 1].begin()),
+                                  std::make_move_iterator(_blocks[block + 1].end()));
+            _blocks.erase(_blocks.begin() + block + 1);
+            _offsets.erase(_offsets.begin() + block + 1);
+        }
+    }
+
+    void erase(const_iterator it) { erase(it.index()); }
+
+    // Reverse the element order in place.
+    void reverse()
+    {
+        std::reverse(_blocks.begin(), _blocks.end());
+        for (auto& block : _blocks)
+            std::reverse(block.begin(), block.end());
+        _rebuild_offsets(0);
+    }
+
+    // Sort the elements in place with `compare`.
+    template <class Compare>
+    void sort(Compare compare)
+    {
+        std::vector<T> values;
+        values.reserve(size());
+        for (auto& block : _blocks)
+            std::move(block.begin(), block.end(), std::back_inserter(values));
+        cppy::internal::sort_stable(values.begin(), values.end(), compare);
+        _rebuild(&values);
+    }
+
+private:
+    static constexpr size_type kMinBlock = 64;
+
+    size_type _block_target() const
+    {
+        return std::max<size_type>(kMinBlock, static_cast<size_type>(std::sqrt(static_cast<double>(size()))));
+    }
+
+    // Block holding position `index`, found by binary search over the prefix counts.
+    size_type _locate(size_type index) const
+    {
+        return static_cast<size_type>(std::upper_bound(_offsets.begin(), _offsets.end(), index) -
+                                      _offsets.begin()) - 1;
+    }
+
+    template <bool Const>
+    basic_iterator<Const> _iterator_at(size_type index) const
+    {
+        using list_type = std::conditional_t<Const, const CPPY_IndexedList, CPPY_IndexedList>;
+        auto* self = const_cast<list_type*>(this);
+        if (index >= size())
+            return basic_iterator<Const>(self, _blocks.size(), 0);
+        const size_type block = _locate(index);
+        return basic_iterator<Const>(self, block, index - _offsets[block]);
+    }
+
+    void _split(size_type block)
+    {
+        const size_type half = _blocks[block].size() / 2;
+        std::vector<T> tail(std::make_move_iterator(_blocks[block].begin() + half),
+                            std::make_move_iterator(_blocks[block].end()));
+        _blocks[block].erase(_blocks[block].begin() + half, _blocks[block].end());
+        _blocks.insert(_blocks.begin() + block + 1, std::move(tail));
+        _offsets.insert(_offsets.begin() + block + 1, _offsets[block] + half);
+    }
+
+    void _rebuild_offsets(size_type block)
+    {
+        _offsets.resize(_blocks.size() + 1);
+        for (size_type b = block; b < _blocks.size(); ++b)
+            _offsets[b + 1] = _offsets[b] + _blocks[b].size();
+    }
+
+    void _rebuild(std::vector<T>* values)
+    {
+        const size_type n = values->size();
+        const size_type target =
+            std::max<size_type>(kMinBlock, static_cast<size_type>(std::sqrt(static_cast<double>(n))));
+        _blocks.clear();
+        for (size_type i = 0; i < n; i += target)
+        {
+            const size_type stop = std::min(n, i + target);
+            _blocks.emplace_back(std::make_move_iterator(values->begin() + i),
+                                 std::make_move_iterator(values->begin() + stop));
+        }
+        _offsets.assign(1, 0);
+        _rebuild_offsets(0);
+    }
+
+    std::vector<std::vector<T>> _blocks;
+    std::vector<size_type> _offsets; // _offsets[b] = number of elements before block b
+};
+
+/* Indexed list.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_LIST_init(CPPY_IndexedList<T>* const self, Iterable first, Iterable last)
+{
+    self->assign(first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_iscontain(const CPPY_IndexedList<T>& self, const T& element, bool* const result)
+{
+    return CPPY_Container_iscontain(self.begin(), self.end(), element, result);
+}
+
+/* Append object to the end of the list
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_append(CPPY_IndexedList<T>* const self, const T& element)
+{
+    self->push_back(element);
+    return CPPY_ERROR_t::Ok;
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_append(CPPY_IndexedList<T>* const self, T&& element)
+{
+    self->push_back(std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Construct an object in place at the end of the list.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace_back(CPPY_IndexedList<T>* const self, Args&&... args)
+{
+    self->emplace_back(std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove all items from list.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_clear(CPPY_IndexedList<T>* const self)
+{
+    self->clear();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return a shallow copy of the list.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_copy(const CPPY_IndexedList<T>& self, CPPY_IndexedList<T>* const result)
+{
+    for (const T& element : self)
+        result->push_back(element);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return number of occurrences of value.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_count(const CPPY_IndexedList<T>& self, const T& element, int* const count)
+{
+    return CPPY_Sequence_count(self.begin(), self.end(), element, count);
+}
+
+/* Extend list by appending elements from the iterable.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_LIST_extend(CPPY_IndexedList<T>* const self, Iterable first, Iterable last)
+{
+    // [first, last) may be this list, as in l.extend(l), which grows as it is read: copy
+    //  as many elements as it held when called
+    using category = typename std::iterator_traits<Iterable>::iterator_category;
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>)
+    {
+        for (auto n = last - first; n > 0; --n, ++first)
+            self->push_back(*first);
+    }
+    else
+    {
+        std::vector<T> values(first, last);
+        for (T& value : values)
+            self->push_back(std::move(value));
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return first index of value.
+ *
+ *  Raises ValueError if the value is not present.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_index(
+    const CPPY_IndexedList<T>& self, const T& element, int* const index, int start = 0, int end = INT_MAX)
+{
+    return CPPY_Sequence_index(self.begin(), self.end(), element, index, start, end);
+}
+
+/* Construct an object in place before index.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace(CPPY_IndexedList<T>* const self, int index, Args&&... args)
+{
+    index = cppy::internal::insert_position(index, static_cast<int>(self->size()));
+    self->emplace(static_cast<std::size_t>(index), std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Insert object before index.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(CPPY_IndexedList<T>* const self, int index, const T& element)
+{
+    return CPPY_LIST_emplace(self, index, element);
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(CPPY_IndexedList<T>* const self, int index, T&& element)
+{
+    return CPPY_LIST_emplace(self, index, std::move(element));
+}
+
+/* Remove and return item at index (default last).
+ *
+ *  Raises IndexError if list is empty or index is out of range.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_pop(CPPY_IndexedList<T>* const self, T* const element, int index = -1)
+{
+    int len = static_cast<int>(self->size());
+    if (index >= len || index < -len)
+        return CPPY_ERROR_t::IndexError;
+
+    index = index >= 0 ? index : index + len;
+    *element = std::move((*self)[static_cast<std::size_t>(index)]);
+    self->erase(static_cast<std::size_t>(index));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove first occurrence of value.
+ *
+ *  Raises ValueError if the value is not present.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_remove(CPPY_IndexedList<T>* const self, const T& element)
+{
+    return CPPY_MutableSequence_remove(self, element);
+}
+
+/* Reverse *IN PLACE*.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_reverse(CPPY_IndexedList<T>* const self)
+{
+    self->reverse();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Sort the list in ascending order and return None.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_sort(CPPY_IndexedList<T>* const self)
+{
+    self->sort(std::less<T>());
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T, typename Iterable>
+CPPY_ERROR_t
+CPPY_LIST_isequal(const CPPY_IndexedList<T>& self, Iterable other_first, Iterable other_last, bool* const result)
+{
+    return CPPY_Sequence_isequal(self.begin(), self.end(), other_first, other_last, result);
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_mul(const CPPY_IndexedList<T>& self, int n, CPPY_IndexedList<T>* const result)
+{
+    // the n copies are of self as it was, even when result is self
+    const auto size = static_cast<std::ptrdiff_t>(self.size());
+    for (int i = 0; i < n; ++i)
+        CPPY_LIST_extend(result, self.begin(), self.begin() + size);
+
+    return CPPY_ERROR_t::Ok;
+}
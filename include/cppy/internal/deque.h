@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cppy
+{
+namespace internal
+{
+// Chase-Lev work-stealing deque (Le, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+//  Work-Stealing for Weak Memory Models", PPoPP 2013).
+//
+//  One owner thread pushes and pops at the bottom, in LIFO order; any number of thieves take
+//  from the top, in FIFO order. Only the last element is contended. T must be trivially
+//  copyable (the pool stores task pointers). The ring grows when full; retired rings are kept
+//  until the deque is destroyed, since a thief may still be reading one.
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque holds trivially copyable values");
+
+    struct Ring
+    {
+        explicit Ring(std::int64_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+        std::int64_t capacity() const { return mask + 1; }
+        T get(std::int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T value) { slots[i & mask].store(value, std::memory_order_relaxed); }
+
+        const std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+public:
+    explicit WorkStealingDeque(std::int64_t capacity = 256)
+    {
+        std::int64_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        _rings.emplace_back(new Ring(size));
+        _ring.store(_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    void push(T value)
+    {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = _top.load(std::memory_order_acquire);
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+        if (b - t > ring->capacity() - 1)
+            ring = grow(ring, t, b);
+        ring->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only: take the most recently pushed value.
+    bool pop(T* const result)
+    {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Ring* ring = _ring.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = _top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        *result = ring->get(b);
+        if (t == b)
+        {
+            // the last element: race the thieves for it
+            const bool won =
+                _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread: take the least recently pushed value. Fails when empty or on losing a race.
+    bool steal(T* const result)
+    {
+        std::int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+        const T value = _ring.load(std::memory_order_acquire)->get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+        *result = value;
+        return true;
+    }
+
+    // Approximate when other threads are pushing or stealing.
+    bool empty() const
+    {
+        return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+    }
+
+private:
+    Ring* grow(Ring* ring, std::int64_t t, std::int64_t b)
+    {
+        Ring* bigger = new Ring(ring->capacity() * 2);
+        for (std::int64_t i = t; i < b; ++i)
+            bigger->put(i, ring->get(i));
+        _rings.emplace_back(bigger);
+        _ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<std::int64_t> _top{0};
+    alignas(64) std::atomic<std::int64_t> _bottom{0};
+    std::atomic<Ring*> _ring{nullptr};
+    std::vector<std::unique_ptr<Ring>> _rings; // owner only
+};
+} // namespace internal
+} // namespace cppy
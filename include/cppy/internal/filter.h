@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "cppy/internal/simd.h"
+#include "cppy/typing.hpp"
+
+namespace cppy
+{
+namespace internal
+{
+// bool(x), taking x by reference.
+struct Truth
+{
+    template <typename T>
+    bool operator()(const T& value) const
+    {
+        return static_cast<bool>(value);
+    }
+};
+
+// all(iterable): contiguous numbers are searched for a zero with simd_find.
+template <class Iterable>
+bool all_truthy(Iterable first, Iterable last)
+{
+    using T = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    if constexpr (is_simd_searchable_v<Iterable, T>)
+    {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        return n == 0 || simd_find(&*first, n, T(0)) == n;
+    }
+    else
+        return std::all_of(first, last, Truth());
+}
+
+// any(iterable): contiguous numbers are searched for a non-zero with simd_find_not.
+template <class Iterable>
+bool any_truthy(Iterable first, Iterable last)
+{
+    using T = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    if constexpr (is_simd_searchable_v<Iterable, T>)
+    {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        return n > 0 && simd_find_not(&*first, n, T(0)) != n;
+    }
+    else
+        return std::any_of(first, last, Truth());
+}
+
+// Whether filter() over [first, last) can use branchless compaction.
+template <class Iterable>
+inline constexpr bool is_compactable_v =
+    is_contiguous_iterator_v<Iterable> &&
+    std::is_arithmetic_v<std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>>;
+
+// filter() over contiguous numbers without a branch per element. Each block is first run
+//  through the predicate into keep flags, then the kept elements are compacted into a
+//  buffer (simd_compact for int, float and double) and copied to result in one go.
+//  The predicate is still called once per element, in order.
+template <class Iterable, class Pred, class OutputIter>
+OutputIter filter_compact(Iterable first, Iterable last, Pred func, OutputIter result)
+{
+    using T = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    constexpr std::size_t block = 1 << 10;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n == 0)
+        return result;
+
+    const T* data = &*first;
+    unsigned char keep[block];
+    T buffer[block];
+    for (std::size_t begin = 0; begin < n; begin += block)
+    {
+        const std::size_t size = std::min(block, n - begin);
+        const T* part = data + begin;
+        for (std::size_t i = 0; i < size; ++i)
+            keep[i] = static_cast<unsigned char>(static_cast<bool>(func(part[i])));
+
+        std::size_t count = 0;
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>)
+            count = simd_compact(part, keep, size, buffer);
+        else
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                buffer[count] = part[i];
+                count += keep[i];
+            }
+        }
+        result = std::copy(buffer, buffer + count, result);
+    }
+    return result;
+}
+} // namespace internal
+} // namespace cppy
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace cppy
+{
+namespace internal
+{
+// Log-linear buckets in the manner of HdrHistogram: values below 2^kHistogramSubBits have a
+//  bucket each, and every power of two above is split into 2^kHistogramSubBits buckets of
+//  equal width, so a bucket is never more than 1/16 wider than the values it holds. Values
+//  are clamped to kHistogramMax: in nanoseconds, about 18 minutes.
+constexpr unsigned kHistogramSubBits = 4;
+constexpr unsigned kHistogramBits = 40;
+constexpr uint64_t kHistogramMax = (uint64_t(1) << kHistogramBits) - 1;
+constexpr std::size_t kHistogramBuckets = (kHistogramBits - kHistogramSubBits + 1) << kHistogramSubBits;
+
+inline unsigned floor_log2(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned log = 0;
+    for (unsigned shift = 32; shift > 0; shift /= 2)
+    {
+        if (value >> shift)
+        {
+            value >>= shift;
+            log += shift;
+        }
+    }
+    return log;
+#endif
+}
+
+inline std::size_t histogram_bucket(uint64_t value)
+{
+    value = std::min(value, kHistogramMax);
+    if (value < (uint64_t(1) << kHistogramSubBits))
+        return static_cast<std::size_t>(value);
+    const unsigned shift = floor_log2(value) - kHistogramSubBits;
+    return (static_cast<std::size_t>(shift + 1) << kHistogramSubBits) +
+           static_cast<std::size_t>((value >> shift) - (uint64_t(1) << kHistogramSubBits));
+}
+
+// The largest value that falls in bucket `bucket`.
+inline uint64_t histogram_bucket_max(std::size_t bucket)
+{
+    if (bucket < (std::size_t(1) << kHistogramSubBits))
+        return bucket;
+    const unsigned shift = static_cast<unsigned>(bucket >> kHistogramSubBits) - 1;
+    const uint64_t mantissa = (bucket & ((std::size_t(1) << kHistogramSubBits) - 1)) + (uint64_t(1) << kHistogramSubBits);
+    return ((mantissa + 1) << shift) - 1;
+}
+
+// Add to a counter that only one thread writes. Readers on other threads see whole values,
+//  and the writer pays for no locked instruction and shares no cache line it writes.
+template <typename T>
+inline void single_writer_add(std::atomic<T>& counter, T amount)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// A histogram one thread records into while others read it.
+struct HistogramRecorder
+{
+    void record(uint64_t value)
+    {
+        single_writer_add(counts[histogram_bucket(value)], uint64_t(1));
+        single_writer_add(sum, value);
+        if (value < min.load(std::memory_order_relaxed))
+            min.store(value, std::memory_order_relaxed);
+        if (value > max.load(std::memory_order_relaxed))
+            max.store(value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts[kHistogramBuckets] = {};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max{0};
+};
+} // namespace internal
+} // namespace cppy
@@ -1,7 +1,15 @@
 #pragma once
 
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <type_traits>
 
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
 namespace cppy
 {
 namespace internal
@@ -19,6 +27,37 @@ void format_helper(std::ostringstream& oss, std::string_view& str, const T& valu
     str = str.substr(close_bracket + 1);
 }
 
+inline int popcount64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(x));
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    int n = 0;
+    for (; x; x &= x - 1)
+        ++n;
+    return n;
+#endif
+}
+
+// Index of the lowest set bit; x must be non-zero.
+inline int ctz64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    for (; !(x & 1); x >>= 1)
+        ++n;
+    return n;
+#endif
+}
+
 template <size_t N, typename T, typename... Types>
 struct GetTypeAtIndex
 {
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "cppy/thread.h"
+
+namespace cppy
+{
+namespace internal
+{
+// Run func(0) ... func(n - 1) concurrently and wait for all of them.
+//  Helpers are submitted as one batch and the calling thread takes calls too, so this
+//  also completes when called from a task already running on the same executor.
+template <class Func>
+void parallel_invoke(CPPY_CONCURRENT_ThreadPoolExecutor* executor, std::size_t n, Func func)
+{
+    executor->parallel_for(0, n, func, 1);
+}
+
+// Number of chunks worth splitting `n` items into, given a minimum chunk size.
+inline std::size_t parallel_chunks(CPPY_CONCURRENT_ThreadPoolExecutor* executor, std::size_t n, std::size_t grain)
+{
+    const std::size_t workers = executor->max_workers() + 1; // the caller takes a chunk too
+    return std::max<std::size_t>(1, std::min(workers, n / std::max<std::size_t>(grain, 1)));
+}
+
+// Whether find(begin, end) is true for some block of the random-access range [first, last).
+//  The range is split into chunks on the executor; each chunk is searched a block at a
+//  time, and a shared flag stops every chunk once any of them has found a match.
+template <class Iterable, class Find>
+bool parallel_find(CPPY_CONCURRENT_ThreadPoolExecutor* executor, Iterable first, Iterable last, Find find)
+{
+    constexpr std::size_t grain = 1 << 14;
+    constexpr std::size_t block = 1 << 12; // elements searched between looks at the flag
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = parallel_chunks(executor, size, grain);
+
+    std::atomic<bool> found{false};
+    parallel_invoke(executor, chunks, [&](std::size_t i) {
+        const std::size_t end = size * (i + 1) / chunks;
+        for (std::size_t begin = size * i / chunks; begin < end; begin += block)
+        {
+            if (found.load(std::memory_order_relaxed))
+                return;
+            if (find(first + begin, first + std::min(begin + block, end)))
+            {
+                found.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    });
+    return found.load();
+}
+
+// Iterators to the first element >= each splitter, plus first and last.
+template <class Iterable, typename T>
+std::vector<Iterable> partition_sorted(Iterable first, Iterable last, const std::vector<T>& splitters)
+{
+    using iterator_category = typename std::iterator_traits<Iterable>::iterator_category;
+    std::vector<Iterable> bounds{first};
+    Iterable it = first;
+    for (const T& splitter : splitters)
+    {
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag, iterator_category>)
+            it = std::lower_bound(it, last, splitter);
+        else
+            while (it != last && *it < splitter)
+                ++it;
+        bounds.push_back(it);
+    }
+    bounds.push_back(last);
+    return bounds;
+}
+
+// The values at positions len * i / chunks of the `len` elements from first, for i in
+//  [1, chunks). Each one is reached from the previous, so a std::set is walked once.
+template <typename T, class Iterable>
+std::vector<T> pick_splitters(Iterable first, std::size_t len, std::size_t chunks)
+{
+    std::vector<T> splitters;
+    splitters.reserve(chunks > 0 ? chunks - 1 : 0);
+    std::size_t position = 0;
+    for (std::size_t i = 1; i < chunks; ++i)
+    {
+        const std::size_t next = len * i / chunks;
+        std::advance(first, static_cast<std::ptrdiff_t>(next - position));
+        position = next;
+        splitters.push_back(*first);
+    }
+    return splitters;
+}
+
+// Apply a sorted-range set operation (std::set_union and friends) in parallel.
+//  Splitter values taken from the longer input cut both inputs into partitions that
+//  hold the same value interval, so the per-partition outputs concatenate in order.
+template <typename T, class Iterable1, class Iterable2, class Operation>
+void parallel_set_operation(CPPY_CONCURRENT_ThreadPoolExecutor* executor,
+                            Iterable1 first_1,
+                            Iterable1 last_1,
+                            Iterable2 first_2,
+                            Iterable2 last_2,
+                            Operation operation,
+                            std::vector<std::vector<T>>* parts)
+{
+    constexpr std::size_t grain = 1 << 14;
+    const std::size_t len_1 = static_cast<std::size_t>(std::distance(first_1, last_1));
+    const std::size_t len_2 = static_cast<std::size_t>(std::distance(first_2, last_2));
+    const std::size_t chunks = parallel_chunks(executor, len_1 + len_2, grain);
+
+    const std::vector<T> splitters =
+        len_1 >= len_2 ? pick_splitters<T>(first_1, len_1, chunks) : pick_splitters<T>(first_2, len_2, chunks);
+
+    const auto bounds_1 = partition_sorted(first_1, last_1, splitters);
+    const auto bounds_2 = partition_sorted(first_2, last_2, splitters);
+    parts->assign(chunks, {});
+    parallel_invoke(executor, chunks, [&](std::size_t i) {
+        operation(bounds_1[i], bounds_1[i + 1], bounds_2[i], bounds_2[i + 1], std::back_inserter((*parts)[i]));
+    });
+}
+} // namespace internal
+} // namespace cppy
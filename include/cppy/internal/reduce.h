@@ -0,0 +1,521 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cppy/exception.h"
+#include "cppy/internal/parallel.h"
+#include "cppy/internal/simd.h"
+#include "cppy/thread.h"
+#include "cppy/typing.hpp"
+
+/* What CPPY_BUILTINS_reduce computes in its single pass. Combine with |.
+ */
+enum class CPPY_REDUCE_t : unsigned int
+{
+    Min = 1,
+    Max = 2,
+    Sum = 4,
+    ArgMin = 8,
+    ArgMax = 16,
+    Mean = 32,
+    All = 63,
+};
+
+constexpr CPPY_REDUCE_t operator|(CPPY_REDUCE_t a, CPPY_REDUCE_t b)
+{
+    return static_cast<CPPY_REDUCE_t>(static_cast<unsigned int>(a) | static_cast<unsigned int>(b));
+}
+
+/* How floating point values are summed. Integers are always summed exactly in 64 bits.
+ *
+ *    Fast     - independent partial sums per SIMD lane; the error grows with n
+ *    Pairwise - lane sums of small blocks added pairwise; the error grows with log(n)
+ *    Kahan    - compensated summation in every lane; the error does not grow with n
+ *    Exact    - correctly rounded, like math.fsum()
+ */
+enum class CPPY_SUM_t : unsigned int
+{
+    Fast = 0,
+    Pairwise = 1,
+    Kahan = 2,
+    Exact = 3,
+};
+
+namespace cppy
+{
+namespace internal
+{
+// Type sums of T are accumulated in: 64-bit integers, double, or T itself.
+template <typename T>
+using reduce_sum_t = std::conditional_t<
+    std::is_integral_v<T>,
+    std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>,
+    std::conditional_t<std::is_floating_point_v<T>, std::conditional_t<(sizeof(T) > sizeof(double)), T, double>, T>>;
+} // namespace internal
+} // namespace cppy
+
+/* Result of CPPY_BUILTINS_reduce. Only the fields that were asked for are set.
+ */
+template <typename T>
+struct CPPY_Reduction
+{
+    using sum_type = cppy::internal::reduce_sum_t<T>;
+
+    T min{};
+    T max{};
+    std::size_t argmin = 0;
+    std::size_t argmax = 0;
+    sum_type sum{};
+    double mean = 0.0;
+    std::size_t count = 0;
+};
+
+namespace cppy
+{
+namespace internal
+{
+// Add x to the running total sum + compensation (Neumaier's variant of Kahan summation).
+template <typename Sum>
+void neumaier_add(Sum* sum, Sum* compensation, Sum x)
+{
+    const Sum t = *sum + x;
+    if (std::fabs(*sum) >= std::fabs(x))
+        *compensation += (*sum - t) + x;
+    else
+        *compensation += (x - t) + *sum;
+    *sum = t;
+}
+
+// Shewchuk's exact summation, the algorithm behind math.fsum(): the running total is kept
+//  as a list of non-overlapping partials whose sum is exact, and rounded once at the end.
+class Fsum
+{
+public:
+    void add(double x)
+    {
+        if (!std::isfinite(x))
+        {
+            // inf and nan make the partials irrelevant; inf - inf shows up as a nan here
+            if (std::isinf(x))
+                _inf_sum += x;
+            _special_sum += x;
+            return;
+        }
+        std::size_t i = 0;
+        for (double y : _partials)
+        {
+            if (std::fabs(x) < std::fabs(y))
+                std::swap(x, y);
+            const double hi = x + y;
+            const double lo = y - (hi - x);
+            if (lo != 0.0)
+                _partials[i++] = lo;
+            x = hi;
+        }
+        _partials.resize(i);
+        if (x != 0.0)
+        {
+            if (!std::isfinite(x))
+                _overflow = true;
+            _partials.push_back(x);
+        }
+    }
+
+    // Add everything another Fsum has seen.
+    void merge(const Fsum& other)
+    {
+        for (double partial : other._partials)
+            add(partial);
+        _inf_sum += other._inf_sum;
+        _special_sum += other._special_sum;
+        _overflow = _overflow || other._overflow;
+    }
+
+    CPPY_ERROR_t value(double* const result) const
+    {
+        if (_special_sum != 0.0 || std::isnan(_special_sum))
+        {
+            if (std::isnan(_inf_sum))
+                return CPPY_ERROR_t::ValueError; // -inf + inf
+            *result = _special_sum;
+            return CPPY_ERROR_t::Ok;
+        }
+        if (_overflow)
+            return CPPY_ERROR_t::OverflowError;
+
+        std::size_t n = _partials.size();
+        double hi = 0.0;
+        if (n > 0)
+        {
+            double lo = 0.0;
+            hi = _partials[--n];
+            while (n > 0)
+            {
+                const double x = hi;
+                const double y = _partials[--n];
+                hi = x + y;
+                lo = y - (hi - x);
+                if (lo != 0.0)
+                    break;
+            }
+            // round half-even correctly when the remaining partials push lo past the halfway point
+            if (n > 0 && ((lo < 0.0 && _partials[n - 1] < 0.0) || (lo > 0.0 && _partials[n - 1] > 0.0)))
+            {
+                const double y = lo * 2.0;
+                const double x = hi + y;
+                if (y == x - hi)
+                    hi = x;
+            }
+        }
+        *result = hi;
+        return CPPY_ERROR_t::Ok;
+    }
+
+private:
+    std::vector<double> _partials;
+    double _special_sum = 0.0;
+    double _inf_sum = 0.0;
+    bool _overflow = false;
+};
+
+// Running sum in one of the CPPY_SUM_t modes.
+template <typename Sum>
+class Summation
+{
+public:
+    static constexpr bool floating = std::is_floating_point_v<Sum>;
+    // values summed left to right before a Pairwise block is closed
+    static constexpr std::size_t pairwise_block = 128;
+
+    explicit Summation(CPPY_SUM_t mode) : _mode(floating ? mode : CPPY_SUM_t::Fast) {}
+
+    CPPY_SUM_t mode() const { return _mode; }
+
+    void add(Sum x)
+    {
+        if constexpr (floating)
+        {
+            switch (_mode)
+            {
+            case CPPY_SUM_t::Pairwise:
+                _sum += x;
+                if (++_block_count == pairwise_block)
+                {
+                    push_level(_sum);
+                    _sum = Sum();
+                    _block_count = 0;
+                }
+                return;
+            case CPPY_SUM_t::Kahan:
+                neumaier_add(&_sum, &_compensation, x);
+                return;
+            case CPPY_SUM_t::Exact:
+                _exact.add(static_cast<double>(x));
+                return;
+            default:
+                break;
+            }
+        }
+        _sum += x;
+    }
+
+    // Add the partial sum of a block; `compensation` is its Kahan correction term.
+    //  Exact sums cannot take partial sums and must be fed with add().
+    void add_block(Sum sum, Sum compensation = Sum())
+    {
+        if constexpr (floating)
+        {
+            if (_mode == CPPY_SUM_t::Pairwise)
+                return push_level(sum + compensation);
+            if (_mode == CPPY_SUM_t::Kahan)
+            {
+                neumaier_add(&_sum, &_compensation, sum);
+                _compensation += compensation;
+                return;
+            }
+        }
+        _sum += sum + compensation;
+    }
+
+    // Add a sum of values that come after the ones seen so far.
+    void merge(const Summation& other)
+    {
+        if constexpr (floating)
+        {
+            if (_mode == CPPY_SUM_t::Exact)
+                return _exact.merge(other._exact);
+        }
+        Sum sum = other._sum;
+        for (const auto& level : other._levels)
+            sum += level.first;
+        add_block(sum, other._compensation);
+    }
+
+    CPPY_ERROR_t value(Sum* const result) const
+    {
+        if constexpr (floating)
+        {
+            if (_mode == CPPY_SUM_t::Exact)
+            {
+                double exact = 0.0;
+                const CPPY_ERROR_t error = _exact.value(&exact);
+                *result = static_cast<Sum>(exact);
+                return error;
+            }
+        }
+        // the smallest levels are at the back
+        Sum sum = _sum;
+        for (auto level = _levels.rbegin(); level != _levels.rend(); ++level)
+            sum = level->first + sum;
+        *result = sum + _compensation;
+        return CPPY_ERROR_t::Ok;
+    }
+
+private:
+    // Levels work like a binary counter: two sums that cover the same number of blocks
+    //  are added together, so every value takes part in O(log n) additions.
+    void push_level(Sum sum)
+    {
+        unsigned level = 0;
+        while (!_levels.empty() && _levels.back().second == level)
+        {
+            sum = _levels.back().first + sum;
+            _levels.pop_back();
+            ++level;
+        }
+        _levels.push_back({sum, level});
+    }
+
+    CPPY_SUM_t _mode;
+    Sum _sum = Sum();
+    Sum _compensation = Sum();
+    std::size_t _block_count = 0;
+    std::vector<std::pair<Sum, unsigned>> _levels;
+    Fsum _exact;
+};
+
+// Whether a contiguous range of T can be reduced by simd_reduce().
+template <typename Iterable>
+inline constexpr bool is_simd_reducible_v = [] {
+    using value_type = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    return is_contiguous_iterator_v<Iterable> &&
+           (std::is_same_v<value_type, int> || std::is_same_v<value_type, float> ||
+            std::is_same_v<value_type, double>);
+}();
+
+// One pass of CPPY_BUILTINS_reduce. Elements arrive in order, one at a time through
+//  add() or a block at a time through add_block(), and chunks reduced separately are
+//  combined with merge().
+//
+//  min/max follow std::min_element / std::max_element (and Python's min() and max()):
+//  the first occurrence wins, and a NaN only ever wins if it is the very first element.
+template <typename T>
+class Reducer
+{
+public:
+    using sum_type = reduce_sum_t<T>;
+
+    // elements handed to simd_reduce() at once; small enough for int32 lane indices and L1
+    static constexpr std::size_t block = 1 << 11;
+
+    Reducer(CPPY_REDUCE_t what, CPPY_SUM_t mode)
+        : _minmax((static_cast<unsigned int>(what) & ~static_cast<unsigned int>(CPPY_REDUCE_t::Sum) &
+                   ~static_cast<unsigned int>(CPPY_REDUCE_t::Mean)) != 0),
+          _sum_needed((static_cast<unsigned int>(what) &
+                       (static_cast<unsigned int>(CPPY_REDUCE_t::Sum) | static_cast<unsigned int>(CPPY_REDUCE_t::Mean))) != 0),
+          _what(what),
+          _sum(mode)
+    {
+    }
+
+    void add(const T& x, std::size_t index)
+    {
+        if (_minmax)
+            update(x, index);
+        if (_sum_needed)
+            _sum.add(static_cast<sum_type>(x));
+        ++_count;
+    }
+
+    // Add data[0, n), the elements at positions offset, offset + 1, ...
+    void add_block(const T* data, std::size_t n, std::size_t offset)
+    {
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, float> || std::is_same_v<T, double>)
+        {
+            const bool exact = _sum.mode() == CPPY_SUM_t::Exact;
+            for (std::size_t begin = 0; begin < n; begin += block)
+            {
+                const T* part = data + begin;
+                const std::size_t size = std::min(block, n - begin);
+                unsigned what = 0;
+                if (_minmax)
+                    what |= simd_reduce_minmax;
+                if (_sum_needed && !exact)
+                    what |= simd_reduce_sum;
+                if (_sum.mode() == CPPY_SUM_t::Kahan)
+                    what |= simd_reduce_compensated;
+
+                SimdReduceBlock<T> result;
+                simd_reduce(part, size, what, &result);
+                if (_minmax)
+                {
+                    if (result.unordered)
+                    {
+                        for (std::size_t i = 0; i < size; ++i)
+                            update(part[i], offset + begin + i);
+                    }
+                    else
+                    {
+                        update_min(result.min, offset + begin + result.argmin);
+                        update_max(result.max, offset + begin + result.argmax);
+                        _ordered = true;
+                    }
+                }
+                if (_sum_needed)
+                {
+                    if (exact)
+                        for (std::size_t i = 0; i < size; ++i)
+                            _sum.add(static_cast<sum_type>(part[i]));
+                    else
+                        _sum.add_block(static_cast<sum_type>(result.sum), static_cast<sum_type>(result.compensation));
+                }
+                _count += size;
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                add(data[i], offset + i);
+        }
+    }
+
+    // Add the elements reduced by `later`, all of which come after the ones seen so far.
+    void merge(const Reducer& later)
+    {
+        if (_minmax && later._ordered)
+        {
+            update_min(later._min, later._argmin);
+            update_max(later._max, later._argmax);
+            _ordered = true;
+        }
+        if (_sum_needed)
+            _sum.merge(later._sum);
+        _count += later._count;
+    }
+
+    CPPY_ERROR_t finish(CPPY_Reduction<T>* const result) const
+    {
+        const unsigned int what = static_cast<unsigned int>(_what);
+        result->count = _count;
+        if (_count == 0 && (what & ~static_cast<unsigned int>(CPPY_REDUCE_t::Sum)) != 0)
+            return CPPY_ERROR_t::ValueError;
+        if (_minmax)
+        {
+            result->min = _min;
+            result->max = _max;
+            result->argmin = _argmin;
+            result->argmax = _argmax;
+        }
+        if (_sum_needed)
+        {
+            const CPPY_ERROR_t error = _sum.value(&result->sum);
+            if (error != CPPY_ERROR_t::Ok)
+                return error;
+            if constexpr (std::is_arithmetic_v<sum_type>)
+                if (what & static_cast<unsigned int>(CPPY_REDUCE_t::Mean))
+                    result->mean = static_cast<double>(result->sum) / static_cast<double>(_count);
+        }
+        return CPPY_ERROR_t::Ok;
+    }
+
+private:
+    void update(const T& x, std::size_t index)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            // nothing compares less than a NaN, so it only sticks when it comes first
+            if (x != x && index != 0)
+                return;
+        }
+        update_min(x, index);
+        update_max(x, index);
+        _ordered = true;
+    }
+
+    void update_min(const T& x, std::size_t index)
+    {
+        if (!_ordered || x < _min)
+        {
+            _min = x;
+            _argmin = index;
+        }
+    }
+
+    void update_max(const T& x, std::size_t index)
+    {
+        if (!_ordered || _max < x)
+        {
+            _max = x;
+            _argmax = index;
+        }
+    }
+
+    bool _minmax;
+    bool _sum_needed;
+    CPPY_REDUCE_t _what;
+    bool _ordered = false;
+    T _min{};
+    T _max{};
+    std::size_t _argmin = 0;
+    std::size_t _argmax = 0;
+    std::size_t _count = 0;
+    Summation<sum_type> _sum;
+};
+
+// Feed [first, last) to a reducer; `offset` is the position of first in the whole range.
+template <class Iterable, typename T>
+void reduce_range(Iterable first, Iterable last, std::size_t offset, Reducer<T>* reducer)
+{
+    if constexpr (is_simd_reducible_v<Iterable>)
+    {
+        const std::size_t n = static_cast<std::size_t>(last - first);
+        if (n > 0)
+            reducer->add_block(&*first, n, offset);
+    }
+    else
+    {
+        for (; first != last; ++first, ++offset)
+            reducer->add(*first, offset);
+    }
+}
+
+// reduce_range() over chunks of a random-access range on the executor, merged in order.
+template <class Iterable, typename T>
+void parallel_reduce_range(CPPY_CONCURRENT_ThreadPoolExecutor* executor,
+                           Iterable first,
+                           Iterable last,
+                           CPPY_REDUCE_t what,
+                           CPPY_SUM_t mode,
+                           Reducer<T>* reducer)
+{
+    constexpr std::size_t grain = 1 << 16;
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = parallel_chunks(executor, size, grain);
+
+    std::vector<Reducer<T>> parts(chunks, Reducer<T>(what, mode));
+    parallel_invoke(executor, chunks, [&](std::size_t i) {
+        const std::size_t begin = size * i / chunks;
+        const std::size_t end = size * (i + 1) / chunks;
+        reduce_range(first + begin, first + end, begin, &parts[i]);
+    });
+    for (const auto& part : parts)
+        reducer->merge(part);
+}
+} // namespace internal
+} // namespace cppy
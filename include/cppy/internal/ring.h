@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace cppy
+{
+namespace internal
+{
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's array queue).
+//
+//  Each cell carries a sequence number that says whose turn it is: a producer may fill cell
+//  i when its sequence equals the enqueue position, a consumer may empty it when it equals
+//  the position plus one. Claiming a position is one compare-and-swap, and there are no locks.
+//  try_push() fails when the ring is full and try_pop() when it is empty. T must be
+//  trivially copyable (the pool stores task pointers).
+template <typename T>
+class MpmcRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "MpmcRing holds trivially copyable values");
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+public:
+    explicit MpmcRing(std::size_t capacity)
+    {
+        std::size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    bool try_push(T value)
+    {
+        std::size_t position = _enqueue.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &_cells[position & _mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto turn = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (turn == 0)
+            {
+                if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (turn < 0)
+                return false; // a lap behind: full
+            else
+                position = _enqueue.load(std::memory_order_relaxed);
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T* const result)
+    {
+        std::size_t position = _dequeue.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &_cells[position & _mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto turn = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (turn == 0)
+            {
+                if (_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (turn < 0)
+                return false; // not filled yet: empty
+            else
+                position = _dequeue.load(std::memory_order_relaxed);
+        }
+        *result = cell->value;
+        cell->sequence.store(position + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return _mask + 1; }
+
+    // Approximate when other threads are pushing or popping.
+    std::size_t size() const
+    {
+        const std::size_t enqueued = _enqueue.load(std::memory_order_relaxed);
+        const std::size_t dequeued = _dequeue.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    std::unique_ptr<Cell[]> _cells;
+    std::size_t _mask = 0;
+    alignas(64) std::atomic<std::size_t> _enqueue{0};
+    alignas(64) std::atomic<std::size_t> _dequeue{0};
+};
+} // namespace internal
+} // namespace cppy
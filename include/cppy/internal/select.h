@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cppy/internal/parallel.h"
+#include "cppy/thread.h"
+
+namespace cppy
+{
+namespace internal
+{
+// An element kept by top_k(): its key, its position in the input, and the element itself.
+template <typename Key, typename T>
+struct TopEntry
+{
+    Key key;
+    std::size_t order;
+    T value;
+};
+
+// Ranking used by nlargest (largest key first) and nsmallest (smallest key first). Equal
+//  keys rank by input position, matching sorted(iterable, key=key, reverse=...)[:n].
+template <bool Largest>
+struct TopRank
+{
+    static constexpr bool largest = Largest;
+
+    template <typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const
+    {
+        if constexpr (Largest)
+        {
+            if (b.key < a.key)
+                return true;
+            if (a.key < b.key)
+                return false;
+        }
+        else
+        {
+            if (a.key < b.key)
+                return true;
+            if (b.key < a.key)
+                return false;
+        }
+        return a.order < b.order;
+    }
+};
+
+// Key function of the overloads that take none.
+struct Identity
+{
+    template <typename T>
+    const T& operator()(const T& value) const
+    {
+        return value;
+    }
+};
+
+// The n best ranked elements of [first, last), unordered. A heap of the n best so far has the
+//  worst of them on top, so each further element costs one comparison unless it gets in.
+template <class Rank, class Iterable, class Callable>
+auto top_k(Iterable first, Iterable last, std::size_t n, Callable key, std::size_t order = 0)
+{
+    using T = typename std::iterator_traits<Iterable>::value_type;
+    using Key = std::decay_t<decltype(key(*first))>;
+    using Entry = TopEntry<Key, T>;
+
+    Rank rank;
+    std::vector<Entry> heap;
+    if (n == 0)
+        return heap;
+    heap.reserve(n);
+    for (; first != last; ++first, ++order)
+    {
+        if (heap.size() < n)
+        {
+            heap.push_back({key(*first), order, *first});
+            std::push_heap(heap.begin(), heap.end(), rank);
+            continue;
+        }
+        Entry& worst = heap.front();
+        // a later element only gets in with a strictly better key
+        decltype(auto) candidate = key(*first);
+        if (Rank::largest ? worst.key < candidate : candidate < worst.key)
+        {
+            std::pop_heap(heap.begin(), heap.end(), rank);
+            heap.back() = {candidate, order, *first};
+            std::push_heap(heap.begin(), heap.end(), rank);
+        }
+    }
+    return heap;
+}
+
+// Write the values of `entries` to result, best ranked first.
+template <class Rank, typename Entry, class OutputIter>
+OutputIter write_ranked(std::vector<Entry>* entries, std::size_t n, OutputIter result)
+{
+    std::sort(entries->begin(), entries->end(), Rank());
+    const std::size_t count = std::min(n, entries->size());
+    for (std::size_t i = 0; i < count; ++i)
+        *result++ = std::move((*entries)[i].value);
+    return result;
+}
+
+// top_k() over chunks of a random-access range on the executor, merged on the caller.
+template <class Rank, class Iterable, class Callable>
+auto parallel_top_k(
+    CPPY_CONCURRENT_ThreadPoolExecutor* executor, Iterable first, Iterable last, std::size_t n, Callable key)
+{
+    constexpr std::size_t grain = 1 << 14;
+    const std::size_t size = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = parallel_chunks(executor, size, grain);
+
+    using Entries = decltype(top_k<Rank>(first, last, n, key));
+    std::vector<Entries> parts(chunks);
+    parallel_invoke(executor, chunks, [&](std::size_t i) {
+        const std::size_t begin = size * i / chunks;
+        const std::size_t end = size * (i + 1) / chunks;
+        parts[i] = top_k<Rank>(first + begin, first + end, n, key, begin);
+    });
+
+    Entries merged;
+    for (auto& part : parts)
+        std::move(part.begin(), part.end(), std::back_inserter(merged));
+    return merged;
+}
+
+// Rearrange [first, last) so that every position in the sorted, duplicate-free list
+//  [positions, positions_end) holds the element a full sort would put there. Each level
+//  is one introselect (std::nth_element), so a few positions cost O(n log k).
+template <class RandomIt>
+void select_positions(RandomIt first,
+                      RandomIt last,
+                      const std::size_t* positions,
+                      const std::size_t* positions_end,
+                      std::size_t offset = 0)
+{
+    if (positions == positions_end || first == last)
+        return;
+    const std::size_t* middle = positions + (positions_end - positions) / 2;
+    RandomIt nth = first + static_cast<std::ptrdiff_t>(*middle - offset);
+    std::nth_element(first, nth, last);
+    select_positions(first, nth, positions, middle, offset);
+    select_positions(nth + 1, last, middle + 1, positions_end, offset + static_cast<std::size_t>(nth - first) + 1);
+}
+} // namespace internal
+} // namespace cppy
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "cppy/internal/declare.h"
+
+namespace cppy
+{
+namespace internal
+{
+// Vectorised linear search over contiguous memory, dispatched at runtime to the
+//  widest instruction set the CPU supports (AVX2, SSE2, or plain scalar code).
+//  Equality follows operator==, so NaN never matches and -0.0 matches 0.0.
+
+// Index of the first element equal to `value`, or n if there is none.
+CPPY_API std::size_t simd_find(const int* data, std::size_t n, int value);
+CPPY_API std::size_t simd_find(const float* data, std::size_t n, float value);
+CPPY_API std::size_t simd_find(const double* data, std::size_t n, double value);
+
+// Index of the first element not equal to `value`, or n if there is none.
+CPPY_API std::size_t simd_find_not(const int* data, std::size_t n, int value);
+CPPY_API std::size_t simd_find_not(const float* data, std::size_t n, float value);
+CPPY_API std::size_t simd_find_not(const double* data, std::size_t n, double value);
+
+// Number of elements equal to `value`.
+CPPY_API std::size_t simd_count(const int* data, std::size_t n, int value);
+CPPY_API std::size_t simd_count(const float* data, std::size_t n, float value);
+CPPY_API std::size_t simd_count(const double* data, std::size_t n, double value);
+// Copy the elements of data[0, n) whose keep flag is non-zero to out, in order, and return
+//  how many were copied. Whole registers are stored past the last kept element, so out
+//  must have room for n elements however many are kept.
+CPPY_API std::size_t simd_compact(const int* data, const unsigned char* keep, std::size_t n, int* out);
+CPPY_API std::size_t simd_compact(const float* data, const unsigned char* keep, std::size_t n, float* out);
+CPPY_API std::size_t simd_compact(const double* data, const unsigned char* keep, std::size_t n, double* out);
+
+// out[i] = start + (offset + i) * step for i in [0, n). Every value is computed from its own
+//  index (a multiply and an add, no fused multiply-add), so it is rounded exactly like the
+//  scalar expression and there is no running sum to accumulate error.
+CPPY_API void simd_arange(double* out, std::size_t n, double start, double step, std::size_t offset = 0);
+
+// Fused single-pass reduction over one block of contiguous memory, on the same runtime
+//  dispatch. Every SIMD lane keeps its own running min/max, the index where it was found,
+//  and a partial sum; the lanes are combined once at the end of the block.
+
+// What simd_reduce() computes.
+enum : unsigned
+{
+    simd_reduce_minmax = 1,      // min, max, argmin and argmax
+    simd_reduce_sum = 2,         // sum
+    simd_reduce_compensated = 4, // Kahan summation in every lane (floating point only)
+};
+
+// Result of simd_reduce(). Indices are relative to the block and point at the first
+//  occurrence, as std::min_element / std::max_element would. Integers are summed in
+//  64 bits and floats in double.
+template <typename T>
+struct SimdReduceBlock
+{
+    using sum_type = std::conditional_t<std::is_integral_v<T>, long long, double>;
+
+    T min;
+    T max;
+    std::size_t argmin;
+    std::size_t argmax;
+    sum_type sum;
+    double compensation; // sum + compensation is the compensated total
+    bool unordered;      // a NaN was seen, so min/max/argmin/argmax were not computed
+};
+
+// Reduce data[0, n), n > 0.
+CPPY_API void simd_reduce(const int* data, std::size_t n, unsigned what, SimdReduceBlock<int>* result);
+CPPY_API void simd_reduce(const float* data, std::size_t n, unsigned what, SimdReduceBlock<float>* result);
+CPPY_API void simd_reduce(const double* data, std::size_t n, unsigned what, SimdReduceBlock<double>* result);
+} // namespace internal
+} // namespace cppy
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "cppy/typing.hpp"
+
+/* A strided view of a sequence: the elements a slice(start, stop, step) selects, in order.
+ *
+ *  Filled in by CPPY_BUILTINS_slice. Nothing is copied; the view holds an iterator to the
+ *  first selected element, the step and the number of elements, so the sequence must
+ *  outlive it. Iterating steps from one selected element to the next, and never past the
+ *  last one. Over a random-access sequence the view is random access too.
+ */
+template <class Iterable>
+class CPPY_Slice_view
+{
+public:
+    using value_type = typename std::iterator_traits<Iterable>::value_type;
+    using difference_type = typename std::iterator_traits<Iterable>::difference_type;
+    using reference = typename std::iterator_traits<Iterable>::reference;
+
+    class iterator
+    {
+    public:
+        using iterator_category = std::conditional_t<
+            std::is_base_of_v<std::random_access_iterator_tag,
+                              typename std::iterator_traits<Iterable>::iterator_category>,
+            std::random_access_iterator_tag,
+            typename std::iterator_traits<Iterable>::iterator_category>;
+        using value_type = CPPY_Slice_view::value_type;
+        using difference_type = CPPY_Slice_view::difference_type;
+        using pointer = typename std::iterator_traits<Iterable>::pointer;
+        using reference = CPPY_Slice_view::reference;
+
+        iterator() = default;
+        iterator(Iterable it, difference_type step, std::size_t index, std::size_t count)
+            : _it(it), _step(step), _index(index), _count(count)
+        {
+        }
+
+        reference operator*() const { return *_it; }
+        pointer operator->() const { return std::addressof(*_it); }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        iterator& operator++()
+        {
+            // the iterator stays on the last element rather than stepping off the sequence
+            if (++_index < _count)
+                std::advance(_it, _step);
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+        iterator& operator--()
+        {
+            if (_index-- < _count)
+                std::advance(_it, -_step);
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            iterator copy = *this;
+            --*this;
+            return copy;
+        }
+        iterator& operator+=(difference_type n)
+        {
+            const std::size_t index = _index + n;
+            if (_count == 0)
+                return _index = index, *this;
+            const std::size_t from = std::min(_index, _count - 1), to = std::min(index, _count - 1);
+            _it += (static_cast<difference_type>(to) - static_cast<difference_type>(from)) * _step;
+            _index = index;
+            return *this;
+        }
+        iterator& operator-=(difference_type n) { return *this += -n; }
+        iterator operator+(difference_type n) const { return iterator(*this) += n; }
+        iterator operator-(difference_type n) const { return iterator(*this) -= n; }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+        difference_type operator-(const iterator& other) const
+        {
+            return static_cast<difference_type>(_index) - static_cast<difference_type>(other._index);
+        }
+
+        bool operator==(const iterator& other) const { return _index == other._index; }
+        bool operator!=(const iterator& other) const { return _index != other._index; }
+        bool operator<(const iterator& other) const { return _index < other._index; }
+        bool operator>(const iterator& other) const { return _index > other._index; }
+        bool operator<=(const iterator& other) const { return _index <= other._index; }
+        bool operator>=(const iterator& other) const { return _index >= other._index; }
+
+    private:
+        Iterable _it{};          // the element at _index, or the last one once past the end
+        difference_type _step = 1;
+        std::size_t _index = 0;
+        std::size_t _count = 0;
+    };
+
+    CPPY_Slice_view() = default;
+    CPPY_Slice_view(Iterable first, difference_type step, std::size_t count)
+        : _first(first), _last(first), _step(step), _count(count)
+    {
+        if (count > 1)
+            std::advance(_last, static_cast<difference_type>(count - 1) * step);
+    }
+
+    std::size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    difference_type step() const { return _step; }
+    iterator begin() const { return iterator(_first, _step, 0, _count); }
+    iterator end() const { return iterator(_last, _step, _count, _count); }
+    reference operator[](std::size_t i) const { return begin()[static_cast<difference_type>(i)]; }
+
+private:
+    Iterable _first{};
+    Iterable _last{};
+    difference_type _step = 1;
+    std::size_t _count = 0;
+};
+
+namespace cppy
+{
+namespace internal
+{
+// slice(start, stop, step).indices(len): the first selected position and how many follow.
+//  Negative start and stop count from the end and out-of-range values are clamped, as in
+//  Python; step must not be 0.
+template <typename Index>
+void slice_indices(Index len, Index start, Index stop, Index step, Index* const first, Index* const count)
+{
+    const Index low = step > 0 ? 0 : -1, high = step > 0 ? len : len - 1;
+    const auto clamp = [&](Index i) { return std::clamp(i < 0 ? i + len : i, low, high); };
+    start = clamp(start);
+    stop = clamp(stop);
+    *first = start;
+    if (step > 0)
+        *count = start < stop ? (stop - start - 1) / step + 1 : 0;
+    else
+        *count = stop < start ? (start - stop - 1) / -step + 1 : 0;
+}
+
+// Copy the `count` elements at positions start, start + step, ... of the sequence beginning at
+//  `first` to result.
+//
+//  Contiguous trivial data is gathered a block at a time into a buffer and passed on with
+//  std::copy (step 1 copies straight from the source). Other iterators advance from one
+//  selected element to the next, so a std::list is walked once. A negative step over a forward-only iterator
+//  collects the elements in a forward walk and writes them out backwards.
+template <class Iterable, class OutputIter>
+OutputIter slice_copy(Iterable first, std::ptrdiff_t start, std::ptrdiff_t step, std::size_t count, OutputIter result)
+{
+    using T = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    using category = typename std::iterator_traits<Iterable>::iterator_category;
+    if (count == 0)
+        return result;
+
+    if constexpr (is_contiguous_iterator_v<Iterable> && std::is_trivial_v<T>)
+    {
+        const T* data = std::addressof(*first) + start;
+        if (step == 1)
+            return std::copy(data, data + count, result);
+
+        // 8 KiB of stack whatever the element size
+        constexpr std::size_t block = std::max<std::size_t>(1, 8192 / sizeof(T));
+        T buffer[block];
+        for (std::size_t begin = 0; begin < count; begin += block)
+        {
+            const std::size_t size = std::min(block, count - begin);
+            const T* part = data + static_cast<std::ptrdiff_t>(begin) * step;
+            for (std::size_t i = 0; i < size; ++i)
+                buffer[i] = part[static_cast<std::ptrdiff_t>(i) * step];
+            result = std::copy(buffer, buffer + size, result);
+        }
+        return result;
+    }
+    else if constexpr (!std::is_base_of_v<std::bidirectional_iterator_tag, category>)
+    {
+        if (step < 0)
+        {
+            std::vector<T> values;
+            values.reserve(count);
+            Iterable it = std::next(first, start + static_cast<std::ptrdiff_t>(count - 1) * step);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values.push_back(*it);
+                if (i + 1 < count)
+                    std::advance(it, -step);
+            }
+            return std::copy(values.rbegin(), values.rend(), result);
+        }
+    }
+
+    std::advance(first, start);
+    for (std::size_t i = 0;; std::advance(first, step))
+    {
+        *result = *first;
+        ++result;
+        if (++i == count)
+            return result;
+    }
+}
+} // namespace internal
+} // namespace cppy
@@ -0,0 +1,888 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cppy/internal/parallel.h"
+#include "cppy/thread.h"
+#include "cppy/typing.hpp"
+
+namespace cppy
+{
+namespace internal
+{
+// Pattern-defeating quicksort (Orson Peters): median-of-3 / ninther pivots, insertion sort
+//  for small ranges, detection of already-partitioned input, deterministic shuffles that
+//  break up adversarial patterns, and a heapsort fallback that bounds the worst case to
+//  O(n log n).
+namespace pdq
+{
+constexpr std::ptrdiff_t insertion_sort_threshold = 24;
+constexpr std::ptrdiff_t ninther_threshold = 128;
+constexpr std::ptrdiff_t partial_insertion_sort_limit = 8;
+
+template <class RandomIt, class Compare>
+void insertion_sort(RandomIt begin, RandomIt end, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if (begin == end)
+        return;
+    for (RandomIt cur = begin + 1; cur != end; ++cur)
+    {
+        RandomIt sift = cur;
+        RandomIt sift_1 = cur - 1;
+        if (comp(*sift, *sift_1))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*sift_1);
+            } while (sift != begin && comp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// Insertion sort that relies on *(begin - 1) not being greater than any element.
+template <class RandomIt, class Compare>
+void unguarded_insertion_sort(RandomIt begin, RandomIt end, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if (begin == end)
+        return;
+    for (RandomIt cur = begin + 1; cur != end; ++cur)
+    {
+        RandomIt sift = cur;
+        RandomIt sift_1 = cur - 1;
+        if (comp(*sift, *sift_1))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*sift_1);
+            } while (comp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// Insertion sort that gives up (returning false) once it has moved too many elements.
+template <class RandomIt, class Compare>
+bool partial_insertion_sort(RandomIt begin, RandomIt end, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if (begin == end)
+        return true;
+    std::ptrdiff_t limit = 0;
+    for (RandomIt cur = begin + 1; cur != end; ++cur)
+    {
+        RandomIt sift = cur;
+        RandomIt sift_1 = cur - 1;
+        if (comp(*sift, *sift_1))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*sift_1);
+            } while (sift != begin && comp(tmp, *--sift_1));
+            *sift = std::move(tmp);
+            limit += cur - sift;
+        }
+        if (limit > partial_insertion_sort_limit)
+            return false;
+    }
+    return true;
+}
+
+template <class RandomIt, class Compare>
+void sort2(RandomIt a, RandomIt b, Compare comp)
+{
+    if (comp(*b, *a))
+        std::iter_swap(a, b);
+}
+
+template <class RandomIt, class Compare>
+void sort3(RandomIt a, RandomIt b, RandomIt c, Compare comp)
+{
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// Partition around *begin: [begin, pivot) < pivot <= (pivot, end). Also reports whether
+//  the range was already partitioned, i.e. no element had to be swapped.
+template <class RandomIt, class Compare>
+std::pair<RandomIt, bool> partition_right(RandomIt begin, RandomIt end, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    T pivot(std::move(*begin));
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    // the median-of-3 guarantees an element >= pivot before end
+    while (comp(*++first, pivot))
+        ;
+    if (first - 1 == begin)
+        while (first < last && !comp(*--last, pivot))
+            ;
+    else
+        while (!comp(*--last, pivot))
+            ;
+
+    const bool already_partitioned = first >= last;
+    while (first < last)
+    {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot))
+            ;
+        while (!comp(*--last, pivot))
+            ;
+    }
+
+    RandomIt pivot_pos = first - 1;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return {pivot_pos, already_partitioned};
+}
+
+// Partition around *begin putting elements equal to the pivot on the left. Used when the
+//  pivot equals the element before the range, so the whole left side is one equal run.
+template <class RandomIt, class Compare>
+RandomIt partition_left(RandomIt begin, RandomIt end, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    T pivot(std::move(*begin));
+    RandomIt first = begin;
+    RandomIt last = end;
+
+    while (comp(pivot, *--last))
+        ;
+    if (last + 1 == end)
+        while (first < last && !comp(pivot, *++first))
+            ;
+    else
+        while (!comp(pivot, *++first))
+            ;
+
+    while (first < last)
+    {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last))
+            ;
+        while (!comp(pivot, *++first))
+            ;
+    }
+
+    RandomIt pivot_pos = last;
+    *begin = std::move(*pivot_pos);
+    *pivot_pos = std::move(pivot);
+    return pivot_pos;
+}
+
+template <class RandomIt, class Compare>
+void loop(RandomIt begin, RandomIt end, Compare comp, int bad_allowed, bool leftmost)
+{
+    while (true)
+    {
+        const std::ptrdiff_t size = end - begin;
+        if (size < insertion_sort_threshold)
+        {
+            if (leftmost)
+                insertion_sort(begin, end, comp);
+            else
+                unguarded_insertion_sort(begin, end, comp);
+            return;
+        }
+
+        const std::ptrdiff_t s2 = size / 2;
+        if (size > ninther_threshold)
+        {
+            sort3(begin, begin + s2, end - 1, comp);
+            sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+            sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+            sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+            std::iter_swap(begin, begin + s2);
+        }
+        else
+        {
+            sort3(begin + s2, begin, end - 1, comp);
+        }
+
+        // many equal elements: the pivot equals the predecessor, so skip them all at once
+        if (!leftmost && !comp(*(begin - 1), *begin))
+        {
+            begin = partition_left(begin, end, comp) + 1;
+            continue;
+        }
+
+        const auto [pivot_pos, already_partitioned] = partition_right(begin, end, comp);
+        const std::ptrdiff_t l_size = pivot_pos - begin;
+        const std::ptrdiff_t r_size = end - (pivot_pos + 1);
+
+        if (l_size < size / 8 || r_size < size / 8)
+        {
+            if (--bad_allowed == 0)
+            {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+            if (l_size >= insertion_sort_threshold)
+            {
+                std::iter_swap(begin, begin + l_size / 4);
+                std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+                if (l_size > ninther_threshold)
+                {
+                    std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+                    std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                    std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+                }
+            }
+            if (r_size >= insertion_sort_threshold)
+            {
+                std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+                std::iter_swap(end - 1, end - r_size / 4);
+                if (r_size > ninther_threshold)
+                {
+                    std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                    std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                    std::iter_swap(end - 2, end - (1 + r_size / 4));
+                    std::iter_swap(end - 3, end - (2 + r_size / 4));
+                }
+            }
+        }
+        else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp) &&
+                 partial_insertion_sort(pivot_pos + 1, end, comp))
+        {
+            return;
+        }
+
+        loop(begin, pivot_pos, comp, bad_allowed, leftmost);
+        begin = pivot_pos + 1;
+        leftmost = false;
+    }
+}
+} // namespace pdq
+
+template <class RandomIt, class Compare>
+void pdqsort(RandomIt first, RandomIt last, Compare comp)
+{
+    if (last - first < 2)
+        return;
+    int log2 = 0;
+    for (auto n = last - first; n > 1; n >>= 1)
+        ++log2;
+    pdq::loop(first, last, comp, log2, true);
+}
+
+// Integer and float types that radix_sort() handles, mapped to unsigned keys of the same width.
+template <typename T>
+inline constexpr bool is_radix_sortable_v = (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+                                            std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+template <typename T>
+auto radix_key(T value)
+{
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        U bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        constexpr U sign = U(1) << (sizeof(T) * 8 - 1);
+        // negative values reverse their order, positive values move above them
+        return (bits & sign) ? U(~bits) : U(bits | sign);
+    }
+    else
+    {
+        using U = std::make_unsigned_t<T>;
+        if constexpr (std::is_signed_v<T>)
+            return U(U(value) ^ (U(1) << (sizeof(T) * 8 - 1)));
+        else
+            return U(value);
+    }
+}
+
+// LSD radix sort, one byte per pass. All histograms come from a single read of the input,
+//  and a pass whose byte is the same for every element is skipped. Descending order
+//  walks the buckets from the top; the sort is stable either way.
+template <typename T>
+void radix_sort(T* first, T* last, bool descending = false)
+{
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < 2)
+        return;
+
+    std::array<std::array<std::size_t, 256>, sizeof(T)> counts{};
+    for (const T* it = first; it != last; ++it)
+    {
+        const auto key = radix_key(*it);
+        for (std::size_t pass = 0; pass < sizeof(T); ++pass)
+            ++counts[pass][(key >> (pass * 8)) & 0xff];
+    }
+
+    std::vector<T> buffer(n);
+    T* source = first;
+    T* target = buffer.data();
+    for (std::size_t pass = 0; pass < sizeof(T); ++pass)
+    {
+        auto& count = counts[pass];
+        if (std::find(count.begin(), count.end(), n) != count.end())
+            continue;
+
+        std::size_t offset = 0;
+        for (std::size_t b = 0; b < 256; ++b)
+        {
+            auto& bucket = count[descending ? 255 - b : b];
+            const std::size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (std::size_t i = 0; i < n; ++i)
+            target[count[(radix_key(source[i]) >> (pass * 8)) & 0xff]++] = source[i];
+        std::swap(source, target);
+    }
+    if (source != first)
+        std::memcpy(first, source, n * sizeof(T));
+}
+
+// Below this many elements the radix passes cost more than comparisons.
+constexpr std::ptrdiff_t radix_sort_threshold = 1 << 11;
+
+template <typename T, class Compare>
+inline constexpr bool is_ascending_compare_v =
+    std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>;
+
+template <typename T, class Compare>
+inline constexpr bool is_descending_compare_v =
+    std::is_same_v<Compare, std::greater<T>> || std::is_same_v<Compare, std::greater<>>;
+
+// Large contiguous ranges of numbers ordered by std::less / std::greater go
+//  to radix_sort, everything else to pdqsort.
+template <class RandomIt, class Compare>
+void sort_unstable(RandomIt first, RandomIt last, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if constexpr (is_contiguous_iterator_v<RandomIt> && is_radix_sortable_v<T> &&
+                  (is_ascending_compare_v<T, Compare> || is_descending_compare_v<T, Compare>))
+    {
+        if (last - first >= radix_sort_threshold)
+        {
+            T* data = std::addressof(*first);
+            radix_sort(data, data + (last - first), is_descending_compare_v<T, Compare>);
+            return;
+        }
+    }
+    pdqsort(first, last, comp);
+}
+
+// Timsort (Tim Peters, CPython's Objects/listsort.txt): natural runs are found and
+//  extended to minrun with binary insertion sort, then merged under the stack invariants
+//  with galloping once one side keeps winning. Stable, and O(n) on presorted input.
+namespace tim
+{
+constexpr std::ptrdiff_t min_merge = 64;
+constexpr std::ptrdiff_t initial_min_gallop = 7;
+
+inline std::ptrdiff_t min_run_length(std::ptrdiff_t n)
+{
+    std::ptrdiff_t r = 0;
+    while (n >= min_merge)
+    {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+// Sort [first, last) given that [first, start) is already sorted.
+template <class RandomIt, class Compare>
+void binary_insertion_sort(RandomIt first, RandomIt start, RandomIt last, Compare comp)
+{
+    for (; start != last; ++start)
+    {
+        auto pivot = std::move(*start);
+        RandomIt pos = std::upper_bound(first, start, pivot, comp);
+        std::move_backward(pos, start, start + 1);
+        *pos = std::move(pivot);
+    }
+}
+
+// Length of the run at first: non-descending, or strictly descending and then reversed.
+template <class RandomIt, class Compare>
+std::ptrdiff_t count_run(RandomIt first, RandomIt last, Compare comp)
+{
+    RandomIt it = first + 1;
+    if (it == last)
+        return 1;
+    if (comp(*it, *first))
+    {
+        while (++it != last && comp(*it, *(it - 1)))
+            ;
+        std::reverse(first, it);
+    }
+    else
+    {
+        while (++it != last && !comp(*it, *(it - 1)))
+            ;
+    }
+    return it - first;
+}
+
+// std::upper_bound / std::lower_bound probing 1, 2, 4, ... elements in from one end, so a
+//  result k elements from that end costs O(log k) comparisons.
+template <class RandomIt, typename T, class Compare>
+RandomIt gallop_upper_bound(RandomIt first, RandomIt last, const T& key, Compare comp)
+{
+    std::ptrdiff_t step = 1;
+    while (last - first > step && !comp(key, first[step - 1]))
+    {
+        first += step;
+        step *= 2;
+    }
+    return std::upper_bound(first, first + std::min(step, last - first), key, comp);
+}
+
+template <class RandomIt, typename T, class Compare>
+RandomIt gallop_lower_bound(RandomIt first, RandomIt last, const T& key, Compare comp)
+{
+    std::ptrdiff_t step = 1;
+    while (last - first > step && comp(first[step - 1], key))
+    {
+        first += step;
+        step *= 2;
+    }
+    return std::lower_bound(first, first + std::min(step, last - first), key, comp);
+}
+
+template <class RandomIt, typename T, class Compare>
+RandomIt gallop_upper_bound_back(RandomIt first, RandomIt last, const T& key, Compare comp)
+{
+    std::ptrdiff_t step = 1;
+    while (last - first > step && comp(key, last[-step]))
+    {
+        last -= step;
+        step *= 2;
+    }
+    return std::upper_bound(last - std::min(step, last - first), last, key, comp);
+}
+
+template <class RandomIt, typename T, class Compare>
+RandomIt gallop_lower_bound_back(RandomIt first, RandomIt last, const T& key, Compare comp)
+{
+    std::ptrdiff_t step = 1;
+    while (last - first > step && !comp(last[-step], key))
+    {
+        last -= step;
+        step *= 2;
+    }
+    return std::lower_bound(last - std::min(step, last - first), last, key, comp);
+}
+
+template <class RandomIt, class Compare>
+class TimSort
+{
+public:
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+
+    explicit TimSort(Compare comp) : _comp(comp) {}
+
+    void sort(RandomIt first, RandomIt last)
+    {
+        const std::ptrdiff_t n = last - first;
+        if (n < 2)
+            return;
+        const std::ptrdiff_t min_run = min_run_length(n);
+
+        RandomIt it = first;
+        while (it != last)
+        {
+            std::ptrdiff_t length = count_run(it, last, _comp);
+            if (length < min_run)
+            {
+                const std::ptrdiff_t forced = std::min(min_run, last - it);
+                binary_insertion_sort(it, it + length, it + forced, _comp);
+                length = forced;
+            }
+            _runs.push_back({it, length});
+            _merge_collapse();
+            it += length;
+        }
+        while (_runs.size() > 1)
+        {
+            std::size_t i = _runs.size() - 2;
+            if (i > 0 && _runs[i - 1].length < _runs[i + 1].length)
+                --i;
+            _merge_at(i);
+        }
+    }
+
+private:
+    struct Run
+    {
+        RandomIt base;
+        std::ptrdiff_t length;
+    };
+
+    // Keep run lengths growing at least like Fibonacci numbers down the stack, which
+    //  bounds the stack depth and keeps merges balanced.
+    void _merge_collapse()
+    {
+        while (_runs.size() > 1)
+        {
+            std::size_t i = _runs.size() - 2;
+            if ((i > 0 && _runs[i - 1].length <= _runs[i].length + _runs[i + 1].length) ||
+                (i > 1 && _runs[i - 2].length <= _runs[i - 1].length + _runs[i].length))
+            {
+                if (_runs[i - 1].length < _runs[i + 1].length)
+                    --i;
+            }
+            else if (_runs[i].length > _runs[i + 1].length)
+            {
+                break;
+            }
+            _merge_at(i);
+        }
+    }
+
+    void _merge_at(std::size_t i)
+    {
+        RandomIt base_a = _runs[i].base;
+        std::ptrdiff_t length_a = _runs[i].length;
+        RandomIt base_b = _runs[i + 1].base;
+        std::ptrdiff_t length_b = _runs[i + 1].length;
+        _runs[i].length += length_b;
+        _runs.erase(_runs.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+
+        // elements of A already below B's first, and of B already above A's last, stay put
+        RandomIt start = gallop_upper_bound(base_a, base_a + length_a, *base_b, _comp);
+        length_a -= start - base_a;
+        base_a = start;
+        if (length_a == 0)
+            return;
+        length_b = gallop_lower_bound_back(base_b, base_b + length_b, *(base_a + (length_a - 1)), _comp) - base_b;
+        if (length_b == 0)
+            return;
+
+        if (length_a <= length_b)
+            _merge_lo(base_a, length_a, base_b, length_b);
+        else
+            _merge_hi(base_a, length_a, base_b, length_b);
+    }
+
+    // Merge with A moved out to the buffer, filling from the left.
+    void _merge_lo(RandomIt base_a, std::ptrdiff_t length_a, RandomIt base_b, std::ptrdiff_t length_b)
+    {
+        _buffer.assign(std::make_move_iterator(base_a), std::make_move_iterator(base_a + length_a));
+        auto a = _buffer.begin();
+        const auto a_end = _buffer.end();
+        RandomIt b = base_b;
+        const RandomIt b_end = base_b + length_b;
+        RandomIt dest = base_a;
+
+        while (true)
+        {
+            std::ptrdiff_t count_a = 0, count_b = 0;
+            do
+            {
+                if (_comp(*b, *a))
+                {
+                    *dest++ = std::move(*b++);
+                    ++count_b;
+                    count_a = 0;
+                    if (b == b_end)
+                        goto done;
+                }
+                else
+                {
+                    *dest++ = std::move(*a++);
+                    ++count_a;
+                    count_b = 0;
+                    if (a == a_end)
+                        goto done;
+                }
+            } while ((count_a | count_b) < _min_gallop);
+
+            ++_min_gallop;
+            do
+            {
+                _min_gallop -= _min_gallop > 1;
+
+                const auto a_stop = gallop_upper_bound(a, a_end, *b, _comp);
+                count_a = a_stop - a;
+                dest = std::move(a, a_stop, dest);
+                a = a_stop;
+                if (a == a_end)
+                    goto done;
+                *dest++ = std::move(*b++);
+                if (b == b_end)
+                    goto done;
+
+                const RandomIt b_stop = gallop_lower_bound(b, b_end, *a, _comp);
+                count_b = b_stop - b;
+                dest = std::move(b, b_stop, dest);
+                b = b_stop;
+                if (b == b_end)
+                    goto done;
+                *dest++ = std::move(*a++);
+                if (a == a_end)
+                    goto done;
+            } while (count_a >= initial_min_gallop || count_b >= initial_min_gallop);
+            ++_min_gallop;
+        }
+    done:
+        // whatever is left of B is already in place
+        std::move(a, a_end, dest);
+    }
+
+    // Merge with B moved out to the buffer, filling from the right.
+    void _merge_hi(RandomIt base_a, std::ptrdiff_t length_a, RandomIt base_b, std::ptrdiff_t length_b)
+    {
+        _buffer.assign(std::make_move_iterator(base_b), std::make_move_iterator(base_b + length_b));
+        RandomIt a = base_a + length_a; // one past the next A element
+        const auto b_begin = _buffer.begin();
+        auto b = _buffer.end(); // one past the next B element
+        RandomIt dest = base_b + length_b;
+
+        while (true)
+        {
+            std::ptrdiff_t count_a = 0, count_b = 0;
+            do
+            {
+                if (_comp(*(b - 1), *(a - 1)))
+                {
+                    *--dest = std::move(*--a);
+                    ++count_a;
+                    count_b = 0;
+                    if (a == base_a)
+                        goto done;
+                }
+                else
+                {
+                    *--dest = std::move(*--b);
+                    ++count_b;
+                    count_a = 0;
+                    if (b == b_begin)
+                        goto done;
+                }
+            } while ((count_a | count_b) < _min_gallop);
+
+            ++_min_gallop;
+            do
+            {
+                _min_gallop -= _min_gallop > 1;
+
+                const RandomIt a_stop = gallop_upper_bound_back(base_a, a, *(b - 1), _comp);
+                count_a = a - a_stop;
+                dest = std::move_backward(a_stop, a, dest);
+                a = a_stop;
+                if (a == base_a)
+                    goto done;
+                *--dest = std::move(*--b);
+                if (b == b_begin)
+                    goto done;
+
+                const auto b_stop = gallop_lower_bound_back(b_begin, b, *(a - 1), _comp);
+                count_b = b - b_stop;
+                dest = std::move_backward(b_stop, b, dest);
+                b = b_stop;
+                if (b == b_begin)
+                    goto done;
+                *--dest = std::move(*--a);
+                if (a == base_a)
+                    goto done;
+            } while (count_a >= initial_min_gallop || count_b >= initial_min_gallop);
+            ++_min_gallop;
+        }
+    done:
+        // whatever is left of A is already in place
+        std::move_backward(b_begin, b, dest);
+    }
+
+    Compare _comp;
+    std::ptrdiff_t _min_gallop = initial_min_gallop;
+    std::vector<Run> _runs;
+    std::vector<T> _buffer;
+};
+} // namespace tim
+
+template <class RandomIt, class Compare>
+void timsort(RandomIt first, RandomIt last, Compare comp)
+{
+    tim::TimSort<RandomIt, Compare>(comp).sort(first, last);
+}
+
+// Stable sort. Large contiguous ranges of integers ordered by std::less / std::greater go
+//  to radix_sort, which is stable and where equal keys are indistinguishable anyway;
+//  everything else goes to timsort.
+template <class RandomIt, class Compare>
+void sort_stable(RandomIt first, RandomIt last, Compare comp)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    if constexpr (is_contiguous_iterator_v<RandomIt> && is_radix_sortable_v<T> && std::is_integral_v<T> &&
+                  (is_ascending_compare_v<T, Compare> || is_descending_compare_v<T, Compare>))
+    {
+        if (last - first >= radix_sort_threshold)
+        {
+            T* data = std::addressof(*first);
+            radix_sort(data, data + (last - first), is_descending_compare_v<T, Compare>);
+            return;
+        }
+    }
+    timsort(first, last, comp);
+}
+
+// Decorate-sort-undecorate: key() runs once per element rather than twice per comparison.
+//  The sort is stable, also when reversed.
+template <class RandomIt, class Callable>
+void sort_by_key(RandomIt first, RandomIt last, Callable key, bool reverse)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    using Key = std::decay_t<decltype(key(*first))>;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+
+    std::vector<std::pair<Key, std::size_t>> decorated;
+    decorated.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        decorated.emplace_back(key(first[i]), i);
+
+    if (reverse)
+        timsort(decorated.begin(), decorated.end(), [](const auto& a, const auto& b) { return b.first < a.first; });
+    else
+        timsort(decorated.begin(), decorated.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<T> values;
+    values.reserve(n);
+    for (const auto& item : decorated)
+        values.push_back(std::move(first[item.second]));
+    std::move(values.begin(), values.end(), first);
+}
+
+// Number of elements of a that come first in the stable merge of a and b truncated to k.
+template <class It1, class It2, class Compare>
+std::size_t merge_co_rank(std::size_t k, It1 a, std::size_t m, It2 b, std::size_t n, Compare comp)
+{
+    std::size_t low = k > n ? k - n : 0;
+    std::size_t high = std::min(k, m);
+    while (true)
+    {
+        const std::size_t i = low + (high - low) / 2;
+        const std::size_t j = k - i;
+        if (i > 0 && j < n && comp(b[j], a[i - 1]))
+            high = i - 1;
+        else if (j > 0 && i < m && !comp(b[j - 1], a[i]))
+            low = i + 1;
+        else
+            return i;
+    }
+}
+
+// One round of a bottom-up merge: runs [bounds[2k], bounds[2k+1]) and [bounds[2k+1], bounds[2k+2])
+//  are merged from source into target. Each merge is cut into pieces by output position, so
+//  the last rounds keep every worker busy too.
+template <class SourceIt, class TargetIt, class Compare>
+void parallel_merge_round(CPPY_CONCURRENT_ThreadPoolExecutor* executor,
+                          SourceIt source,
+                          TargetIt target,
+                          std::vector<std::size_t>* bounds,
+                          std::size_t workers,
+                          Compare comp)
+{
+    struct Piece
+    {
+        std::size_t a, b, k_begin, k_end, i_begin, i_end;
+    };
+    const std::vector<std::size_t>& runs = *bounds;
+    const std::size_t pairs = (runs.size() - 1) / 2;
+    const std::size_t parts = std::max<std::size_t>(1, workers / std::max<std::size_t>(pairs, 1));
+
+    // split points are found before any piece starts moving elements out of source
+    std::vector<Piece> pieces;
+    std::vector<std::size_t> merged{0};
+    for (std::size_t r = 0; r + 1 < runs.size(); r += 2)
+    {
+        const std::size_t a = runs[r];
+        const std::size_t b = runs[r + 1];
+        const std::size_t end = r + 2 < runs.size() ? runs[r + 2] : runs[r + 1];
+        const std::size_t total = end - a;
+        std::size_t i_begin = 0;
+        for (std::size_t p = 0; p < parts; ++p)
+        {
+            const std::size_t k_begin = total * p / parts;
+            const std::size_t k_end = total * (p + 1) / parts;
+            const std::size_t i_end = merge_co_rank(k_end, source + a, b - a, source + b, end - b, comp);
+            pieces.push_back({a, b, k_begin, k_end, i_begin, i_end});
+            i_begin = i_end;
+        }
+        merged.push_back(end);
+    }
+
+    parallel_invoke(executor, pieces.size(), [&](std::size_t index) {
+        const Piece& piece = pieces[index];
+        const SourceIt a = source + piece.a;
+        const SourceIt b = source + piece.b;
+        std::merge(std::make_move_iterator(a + piece.i_begin),
+                   std::make_move_iterator(a + piece.i_end),
+                   std::make_move_iterator(b + (piece.k_begin - piece.i_begin)),
+                   std::make_move_iterator(b + (piece.k_end - piece.i_end)),
+                   target + (piece.a + piece.k_begin),
+                   comp);
+    });
+    *bounds = std::move(merged);
+}
+
+// Parallel merge sort: the range is cut into one chunk per worker, chunks are sorted
+//  concurrently with sort_chunk, then merged pairwise in parallel rounds through a buffer.
+//  Stable whenever sort_chunk is.
+template <class RandomIt, class Compare, class SortChunk>
+void parallel_merge_sort(
+    CPPY_CONCURRENT_ThreadPoolExecutor* executor, RandomIt first, RandomIt last, Compare comp, SortChunk sort_chunk)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    constexpr std::size_t grain = 1 << 15;
+    const std::size_t n = static_cast<std::size_t>(last - first);
+    const std::size_t chunks = parallel_chunks(executor, n, grain);
+    if (chunks <= 1)
+    {
+        sort_chunk(first, last);
+        return;
+    }
+
+    std::vector<std::size_t> bounds;
+    for (std::size_t i = 0; i <= chunks; ++i)
+        bounds.push_back(n * i / chunks);
+    parallel_invoke(executor, chunks, [&](std::size_t i) { sort_chunk(first + bounds[i], first + bounds[i + 1]); });
+
+    // the buffer takes the data, so the element type needs no default constructor
+    std::vector<T> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    bool in_buffer = true;
+    while (bounds.size() > 2)
+    {
+        if (in_buffer)
+            parallel_merge_round(executor, buffer.begin(), first, &bounds, chunks, comp);
+        else
+            parallel_merge_round(executor, first, buffer.begin(), &bounds, chunks, comp);
+        in_buffer = !in_buffer;
+    }
+    if (in_buffer)
+        std::move(buffer.begin(), buffer.end(), first);
+}
+
+// Stable sort on the executor's workers; small ranges stay on the calling thread.
+template <class RandomIt, class Compare>
+void parallel_sort(CPPY_CONCURRENT_ThreadPoolExecutor* executor, RandomIt first, RandomIt last, Compare comp)
+{
+    parallel_merge_sort(executor, first, last, comp, [&comp](RandomIt chunk_first, RandomIt chunk_last) {
+        sort_stable(chunk_first, chunk_last, comp);
+    });
+}
+} // namespace internal
+} // namespace cppy
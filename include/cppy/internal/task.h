@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cppy
+{
+namespace internal
+{
+// Recycles objects of type T instead of deleting them.
+//
+//  Each thread keeps a small cache of free objects, so acquire() and release() touch no lock
+//  and no allocator in the steady state. Caches trade batches with a shared list under a
+//  mutex when they run dry or overflow, which lets objects acquired on one thread (a
+//  submitter) be released on another (a worker). Objects are constructed once and reused
+//  as they are; the caller resets whatever state it needs.
+template <typename T>
+class FreeList
+{
+public:
+    static T* acquire()
+    {
+        Cache& cache = local();
+        if (cache.items.empty())
+            cache.refill();
+        if (cache.items.empty())
+            return new T();
+        T* item = cache.items.back();
+        cache.items.pop_back();
+        return item;
+    }
+
+    static void release(T* item)
+    {
+        Cache& cache = local();
+        cache.items.push_back(item);
+        if (cache.items.size() > kCacheSize)
+            cache.spill(kBatch);
+    }
+
+private:
+    static constexpr std::size_t kBatch = 64;
+    static constexpr std::size_t kCacheSize = 4 * kBatch;
+
+    struct Shared
+    {
+        std::mutex mutex;
+        std::vector<T*> items;
+    };
+
+    // never destroyed: threads still release objects after static destructors have run
+    static Shared& shared()
+    {
+        static Shared* const instance = new Shared();
+        return *instance;
+    }
+
+    struct Cache
+    {
+        Cache() { items.reserve(kCacheSize + 1); }
+        ~Cache() { spill(items.size()); }
+
+        void refill()
+        {
+            Shared& pool = shared();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            const std::size_t n = std::min(kBatch, pool.items.size());
+            items.insert(items.end(), pool.items.end() - n, pool.items.end());
+            pool.items.resize(pool.items.size() - n);
+        }
+
+        void spill(std::size_t n)
+        {
+            Shared& pool = shared();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.items.insert(pool.items.end(), items.end() - n, items.end());
+            items.resize(items.size() - n);
+        }
+
+        std::vector<T*> items;
+    };
+
+    static Cache& local()
+    {
+        thread_local Cache cache;
+        return cache;
+    }
+};
+
+// A queued unit of work: a type-erased, move-only void() callable.
+//
+//  std::function requires a CopyConstructible callable, which rules out lambdas capturing a
+//  packaged_task or a promise. A Task instead stores any MoveConstructible callable, inline
+//  when it fits in kInlineSize bytes and on the heap otherwise. Tasks themselves come from a
+//  FreeList, so submitting a small callable allocates nothing. A task is 128 bytes, two
+//  cache lines.
+class Task
+{
+public:
+#if defined(CPPY_THREAD_STATS)
+    static constexpr std::size_t kInlineSize = 96;
+#else
+    static constexpr std::size_t kInlineSize = 104;
+#endif
+
+    template <class F>
+    static Task* make(F&& func)
+    {
+        using Callable = std::decay_t<F>;
+        Task* task = FreeList<Task>::acquire();
+        try
+        {
+            if constexpr (fits_inline<Callable>())
+                new (task->_storage) Callable(std::forward<F>(func));
+            else
+                *reinterpret_cast<Callable**>(task->_storage) = new Callable(std::forward<F>(func));
+        }
+        catch (...)
+        {
+            FreeList<Task>::release(task);
+            throw;
+        }
+        task->_call = &call<Callable>;
+        return task;
+    }
+
+    // Invoke the callable, then destroy it and recycle the task, also if it throws.
+    void run() { _call(this, true); }
+
+    // Destroy the callable without invoking it and recycle the task.
+    void discard() { _call(this, false); }
+
+    // Whether the task was made from a callable of type Callable.
+    template <class Callable>
+    bool holds() const
+    {
+        return _call == &call<Callable>;
+    }
+
+    // Free for whoever holds the task to chain it into a list, as future callbacks do.
+    Task* next = nullptr;
+#if defined(CPPY_THREAD_STATS)
+    // When the task was queued, in steady_clock nanoseconds, for the queue wait statistics.
+    int64_t enqueued = 0;
+#endif
+
+private:
+    template <class Callable>
+    static constexpr bool fits_inline()
+    {
+        return sizeof(Callable) <= kInlineSize && alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+    template <class Callable>
+    static void call(Task* task, bool invoke)
+    {
+        struct Recycle
+        {
+            ~Recycle()
+            {
+                if constexpr (fits_inline<Callable>())
+                    func->~Callable();
+                else
+                    delete func;
+                FreeList<Task>::release(task);
+            }
+            Task* task;
+            Callable* func;
+        };
+
+        Callable* func;
+        if constexpr (fits_inline<Callable>())
+            func = std::launder(reinterpret_cast<Callable*>(task->_storage));
+        else
+            func = *reinterpret_cast<Callable**>(task->_storage);
+        Recycle recycle{task, func};
+        if (invoke)
+            (*func)();
+    }
+
+    void (*_call)(Task*, bool) = nullptr;
+    alignas(std::max_align_t) unsigned char _storage[kInlineSize];
+};
+} // namespace internal
+} // namespace cppy
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <climits>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <list>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "cppy/exception.h"
 #include "cppy/internal/declare.h"
+#include "cppy/internal/sort.h"
 #include "cppy/typing.hpp"
 
 /* Built-in list.
@@ -30,6 +38,21 @@ CPPY_ERROR_t CPPY_LIST_append(std::list<T>* const self, const T& element)
     self->push_back(element);
     return CPPY_ERROR_t::Ok;
 }
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_append(std::list<T>* const self, T&& element)
+{
+    self->push_back(std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Construct an object in place at the end of the list.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace_back(std::list<T>* const self, Args&&... args)
+{
+    self->emplace_back(std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
 
 /* Remove all items from list.
  */
@@ -66,6 +89,15 @@ CPPY_ERROR_t CPPY_LIST_extend(std::list<T>* const self, Iterable first, Iterable
     return CPPY_ERROR_t::Ok;
 }
 
+/* Extend list by splicing in the nodes of another list; nothing is copied.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_extend(std::list<T>* const self, std::list<T>&& other)
+{
+    self->splice(self->end(), other);
+    return CPPY_ERROR_t::Ok;
+}
+
 /* Return first index of value.
  *
  *  Raises ValueError if the value is not present.
@@ -77,30 +109,31 @@ CPPY_LIST_index(const std::list<T>& self, const T& element, int* const index, in
     return CPPY_Sequence_index(self.begin(), self.end(), element, index, start, end);
 }
 
-/* Insert object before index.
+/* Construct an object in place before index.
  */
-template <typename T>
-CPPY_ERROR_t CPPY_LIST_insert(std::list<T>* const self, int index, const T& element)
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace(std::list<T>* const self, int index, Args&&... args)
 {
-    int len = static_cast<int>(self->size());
-
-    if (index >= len)
-    {
-        self->push_back(element);
-        return CPPY_ERROR_t::Ok;
-    }
-    if (index < 0)
-    {
-        index += len;
-        if (index < 0)
-            index = 0;
-    }
+    index = cppy::internal::insert_position(index, static_cast<int>(self->size()));
     auto it = self->begin();
     std::advance(it, index);
-    self->insert(it, element);
+    self->emplace(it, std::forward<Args>(args)...);
     return CPPY_ERROR_t::Ok;
 }
 
+/* Insert object before index.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(std::list<T>* const self, int index, const T& element)
+{
+    return CPPY_LIST_emplace(self, index, element);
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(std::list<T>* const self, int index, T&& element)
+{
+    return CPPY_LIST_emplace(self, index, std::move(element));
+}
+
 /* Remove and return item at index (default last).
  *
  *  Raises IndexError if list is empty or index is out of range.
@@ -157,3 +190,290 @@ CPPY_ERROR_t CPPY_LIST_mul(const std::list<T>& self, int n, std::list<T>* result
 
     return CPPY_ERROR_t::Ok;
 }
+
+/* Contiguous list with CPython's list over-allocation policy.
+ *
+ *  Growth reserves newsize + newsize / 8 + 6 slots (rounded to a multiple of 4), so a
+ *  run of appends costs amortised O(1) with ~12.5% slack instead of std::vector's
+ *  implementation-defined doubling. Mutators have rvalue overloads that move.
+ */
+template <typename T>
+class CPPY_List
+{
+public:
+    using value_type = T;
+    using size_type = typename std::vector<T>::size_type;
+    using difference_type = typename std::vector<T>::difference_type;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    CPPY_List() = default;
+
+    template <class Iterable>
+    CPPY_List(Iterable first, Iterable last) : _items(first, last)
+    {
+    }
+
+    CPPY_List(std::initializer_list<T> values) : _items(values) {}
+
+    iterator begin() { return _items.begin(); }
+    iterator end() { return _items.end(); }
+    const_iterator begin() const { return _items.begin(); }
+    const_iterator end() const { return _items.end(); }
+    const_iterator cbegin() const { return _items.cbegin(); }
+    const_iterator cend() const { return _items.cend(); }
+
+    size_type size() const { return _items.size(); }
+    size_type capacity() const { return _items.capacity(); }
+    bool empty() const { return _items.empty(); }
+    T* data() { return _items.data(); }
+    const T* data() const { return _items.data(); }
+
+    reference operator[](size_type index) { return _items[index]; }
+    const_reference operator[](size_type index) const { return _items[index]; }
+    reference back() { return _items.back(); }
+
+    void reserve(size_type n) { _items.reserve(n); }
+    // Plan for n more items under the list's own growth policy.
+    void reserve_extra(size_type n) { _grow(size() + n); }
+    void clear() { _items.clear(); }
+    void pop_back() { _items.pop_back(); }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    template <typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (size() < capacity())
+            return _items.emplace_back(std::forward<Args>(args)...);
+        // growing frees the old buffer, which args may point into, as in l.append(l[0]):
+        //  build the item before that
+        T item(std::forward<Args>(args)...);
+        _grow(size() + 1);
+        return _items.emplace_back(std::move(item));
+    }
+
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        const auto index = pos - cbegin();
+        if (size() < capacity())
+            return _items.emplace(_items.cbegin() + index, std::forward<Args>(args)...);
+        // as in emplace_back
+        T item(std::forward<Args>(args)...);
+        _grow(size() + 1);
+        return _items.emplace(_items.cbegin() + index, std::move(item));
+    }
+    template <class Iterable>
+    iterator insert(const_iterator pos, Iterable first, Iterable last)
+    {
+        using iterator_category = typename std::iterator_traits<Iterable>::iterator_category;
+        const auto index = pos - cbegin();
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, iterator_category>)
+            _grow(size() + static_cast<size_type>(std::distance(first, last)));
+        return _items.insert(_items.cbegin() + index, first, last);
+    }
+
+    iterator erase(const_iterator pos) { return _items.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) { return _items.erase(first, last); }
+
+private:
+    // list_resize() in CPython's Objects/listobject.c
+    void _grow(size_type newsize)
+    {
+        if (newsize <= _items.capacity())
+            return;
+        size_type new_allocated = (newsize + (newsize >> 3) + 6) & ~size_type(3);
+        // a large extend gets exactly what it asked for, rounded up
+        if (newsize - size() > new_allocated - newsize)
+            new_allocated = (newsize + 3) & ~size_type(3);
+        _items.reserve(new_allocated);
+    }
+
+    std::vector<T> _items;
+};
+
+/* Contiguous list.
+ *
+ *  size_hint is the expected length of an input range that cannot be measured up front.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_LIST_init(CPPY_List<T>* const self, Iterable first, Iterable last, std::size_t size_hint = 0)
+{
+    self->clear();
+    self->reserve_extra(size_hint);
+    self->insert(self->end(), first, last);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_iscontain(const CPPY_List<T>& self, const T& element, bool* const result)
+{
+    return CPPY_Container_iscontain(self.begin(), self.end(), element, result);
+}
+
+/* Append object to the end of the list
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_append(CPPY_List<T>* const self, const T& element)
+{
+    self->push_back(element);
+    return CPPY_ERROR_t::Ok;
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_append(CPPY_List<T>* const self, T&& element)
+{
+    self->push_back(std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Construct an object in place at the end of the list.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace_back(CPPY_List<T>* const self, Args&&... args)
+{
+    self->emplace_back(std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove all items from list.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_clear(CPPY_List<T>* const self)
+{
+    self->clear();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return a shallow copy of the list.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_copy(const CPPY_List<T>& self, CPPY_List<T>* const result)
+{
+    result->insert(result->end(), self.begin(), self.end());
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return number of occurrences of value.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_count(const CPPY_List<T>& self, const T& element, int* const count)
+{
+    return CPPY_Sequence_count(self.begin(), self.end(), element, count);
+}
+
+/* Extend list by appending elements from the iterable.
+ */
+template <typename T, class Iterable>
+CPPY_ERROR_t CPPY_LIST_extend(CPPY_List<T>* const self, Iterable first, Iterable last, std::size_t size_hint = 0)
+{
+    self->reserve_extra(size_hint);
+    self->insert(self->end(), first, last);
+    return CPPY_ERROR_t::Ok;
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_extend(CPPY_List<T>* const self, CPPY_List<T>&& other)
+{
+    self->insert(self->end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+    other.clear();
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return first index of value.
+ *
+ *  Raises ValueError if the value is not present.
+ */
+template <typename T>
+CPPY_ERROR_t
+CPPY_LIST_index(const CPPY_List<T>& self, const T& element, int* const index, int start = 0, int end = INT_MAX)
+{
+    return CPPY_Sequence_index(self.begin(), self.end(), element, index, start, end);
+}
+
+/* Insert object before index.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_LIST_emplace(CPPY_List<T>* const self, int index, Args&&... args)
+{
+    index = cppy::internal::insert_position(index, static_cast<int>(self->size()));
+    self->emplace(self->begin() + index, std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(CPPY_List<T>* const self, int index, const T& element)
+{
+    return CPPY_LIST_emplace(self, index, element);
+}
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_insert(CPPY_List<T>* const self, int index, T&& element)
+{
+    return CPPY_LIST_emplace(self, index, std::move(element));
+}
+
+/* Remove and return item at index (default last).
+ *
+ *  Raises IndexError if list is empty or index is out of range.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_pop(CPPY_List<T>* const self, T* const element, int index = -1)
+{
+    int len = static_cast<int>(self->size());
+    if (index >= len || index < -len)
+        return CPPY_ERROR_t::IndexError;
+
+    index = index >= 0 ? index : index + len;
+    *element = std::move((*self)[index]);
+    self->erase(self->begin() + index);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Remove first occurrence of value.
+ *
+ *  Raises ValueError if the value is not present.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_remove(CPPY_List<T>* const self, const T& element)
+{
+    return CPPY_MutableSequence_remove(self, element);
+}
+
+/* Reverse *IN PLACE*.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_reverse(CPPY_List<T>* const self)
+{
+    return CPPY_MutableSequence_reverse(self->begin(), self->end());
+}
+
+/* Sort the list in ascending order and return None.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_sort(CPPY_List<T>* const self)
+{
+    cppy::internal::sort_stable(self->begin(), self->end(), std::less<T>());
+    return CPPY_ERROR_t::Ok;
+}
+
+template <typename T, typename Iterable>
+CPPY_ERROR_t CPPY_LIST_isequal(const CPPY_List<T>& self, Iterable other_first, Iterable other_last, bool* const result)
+{
+    return CPPY_Sequence_isequal(self.begin(), self.end(), other_first, other_last, result);
+}
+
+template <typename T>
+CPPY_ERROR_t CPPY_LIST_mul(const CPPY_List<T>& self, int n, CPPY_List<T>* const result)
+{
+    if (n <= 0)
+        return CPPY_ERROR_t::Ok;
+
+    result->reserve(result->size() + self.size() * static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i)
+        CPPY_LIST_extend(result, self.begin(), self.end());
+
+    return CPPY_ERROR_t::Ok;
+}
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "cppy/exception.h"
 #include "cppy/internal/declare.h"
@@ -12,6 +13,23 @@ CPPY_API CPPY_ERROR_t CPPY_PLATFORM_cpu_percent(double* const percent, int inter
 
 CPPY_API CPPY_ERROR_t CPPY_PLATFORM_memory(uint64_t* total, uint64_t* available);
 
+// A NUMA node and those of its CPUs the process may run on.
+struct CPPY_PLATFORM_NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+// The NUMA nodes of the machine in order of id, leaving out those with no CPU the process
+//  may run on. A machine that does not report its nodes is a single node 0.
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_numa_nodes(std::vector<CPPY_PLATFORM_NumaNode>* const nodes);
+
+// Restrict the calling thread to the given CPUs.
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_set_affinity(const std::vector<int>& cpus);
+
+// The CPU the calling thread is running on, as of the call.
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_current_cpu(int* const cpu);
+
 #if defined(_WIN32) || defined(_WIN64)
 
 #    pragma comment(lib, "pdh.lib")
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "cppy/exception.h"
+#include "cppy/internal/declare.h"
+
+/* Compressed bitmap set of 32-bit unsigned integers (Roaring layout).
+ *
+ *  The value space is split into chunks of 2^16 integers keyed by the high 16 bits.
+ *  Each non-empty chunk is stored in the cheapest of three container kinds:
+ *    Array  - sorted uint16_t values, used while the chunk holds <= 4096 values
+ *    Bitmap - 1024 uint64_t words, one bit per value
+ *    Run    - (start, length - 1) uint16_t pairs, produced by CPPY_ROARING_run_optimize
+ */
+enum class CPPY_ROARING_container_t : uint16_t
+{
+    Array = 1,
+    Bitmap = 2,
+    Run = 3,
+};
+
+struct CPPY_RoaringContainer
+{
+    uint16_t key = 0;
+    CPPY_ROARING_container_t type = CPPY_ROARING_container_t::Array;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> values; // Array: sorted values, Run: (start, length - 1) pairs
+    std::vector<uint64_t> words;  // Bitmap: 1024 words
+};
+
+struct CPPY_RoaringBitmap
+{
+    std::vector<CPPY_RoaringContainer> containers; // sorted by key
+};
+
+/* Read-only view over a buffer produced by CPPY_ROARING_serialize.
+ *
+ *  The view never copies, so the buffer may be a mmap()ed file; it must outlive the view.
+ */
+struct CPPY_RoaringBitmap_view
+{
+    const char* data = nullptr;
+    std::size_t size = 0;
+    uint32_t count = 0;
+};
+
+/* Build a bitmap from already sorted, duplicate-free values.
+ */
+CPPY_API CPPY_ERROR_t CPPY_ROARING_init_sorted(CPPY_RoaringBitmap* const self, const uint32_t* values, std::size_t n);
+
+/* set(iterable) -> new set object
+ *
+ *  Build an unordered collection of unique elements.
+ */
+template <class Iterable>
+CPPY_ERROR_t CPPY_SET_init(CPPY_RoaringBitmap* const self, Iterable first, Iterable last)
+{
+    std::vector<uint32_t> values(first, last);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return CPPY_ROARING_init_sorted(self, values.data(), values.size());
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_iscontain(const CPPY_RoaringBitmap& self, uint32_t element, bool* const result);
+
+/* Return the number of elements, summed from the per-container cardinalities.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_len(const CPPY_RoaringBitmap& self, std::size_t* const len);
+
+/* Add an element to a set.
+ *
+ *  This has no effect if the element is already present.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_add(CPPY_RoaringBitmap* const self, uint32_t element);
+
+/* Remove all elements from this set.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_clear(CPPY_RoaringBitmap* const self);
+
+/* Return a shallow copy of a set.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_copy(const CPPY_RoaringBitmap& self, CPPY_RoaringBitmap* const result);
+
+/* Return the difference of two sets as a new set.
+ *
+ *  (i.e. all elements that are in this set but not the other.)
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_SET_difference(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, CPPY_RoaringBitmap* const result);
+
+/* Remove all elements of another set from this set.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_difference_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other);
+
+/* Return the intersection of two sets as a new set.
+ *
+ *  (i.e. all elements that are in both sets.)
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_intersection(const CPPY_RoaringBitmap& self,
+                                            const CPPY_RoaringBitmap& other,
+                                            CPPY_RoaringBitmap* const result);
+
+/* Update a set with the intersection of itself and another.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_intersection_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other);
+
+/* Return the symmetric difference of two sets as a new set.
+ *
+ *  (i.e. all elements that are in exactly one of the sets.)
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_symmetric_difference(const CPPY_RoaringBitmap& self,
+                                                    const CPPY_RoaringBitmap& other,
+                                                    CPPY_RoaringBitmap* const result);
+
+/* Update a set with the symmetric difference of itself and another.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_symmetric_difference_update(CPPY_RoaringBitmap* const self,
+                                                           const CPPY_RoaringBitmap& other);
+
+/* Return the union of sets as a new set.
+ *
+ *  (i.e. all elements that are in either set.)
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_SET_union(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, CPPY_RoaringBitmap* const result);
+
+/* Update a set with the union of itself and another.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other);
+
+/* Update a set with the elements of an iterable.
+ */
+template <class Iterable>
+CPPY_ERROR_t CPPY_SET_update(CPPY_RoaringBitmap* const self, Iterable first, Iterable last)
+{
+    CPPY_RoaringBitmap other;
+    CPPY_SET_init(&other, first, last);
+    return CPPY_SET_update(self, other);
+}
+
+/* Remove and return the smallest set element.
+ *  Raises KeyError if the set is empty.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_pop(CPPY_RoaringBitmap* const self, uint32_t* const element);
+
+/* Remove an element from a set; it must be a member.
+ *
+ *  If the element is not a member, raise a KeyError.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_remove(CPPY_RoaringBitmap* const self, uint32_t element);
+
+/* Remove an element from a set if it is a member.
+ */
+CPPY_API CPPY_ERROR_t CPPY_SET_discard(CPPY_RoaringBitmap* const self, uint32_t element);
+
+/* Return True if two sets have a null intersection.
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_SET_isdisjoint(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result);
+
+/* Report whether another set contains this set.
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_SET_issubset(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result);
+
+/* Report whether this set contains another set.
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_SET_issuperset(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result);
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_isequal(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result);
+
+/* Convert containers to run containers wherever that is smaller.
+ */
+CPPY_API CPPY_ERROR_t CPPY_ROARING_run_optimize(CPPY_RoaringBitmap* const self);
+
+/* Return the elements in ascending order.
+ */
+CPPY_API CPPY_ERROR_t CPPY_ROARING_tolist(const CPPY_RoaringBitmap& self, std::vector<uint32_t>* const result);
+
+/* Serialize to a flat, mmap()able buffer (native little-endian byte order).
+ *
+ *  Layout:
+ *    header       "CPRB", uint32 version, uint32 container count, uint32 reserved
+ *    descriptors  per container: uint16 key, uint16 type, uint32 cardinality, uint32 offset, uint32 bytes
+ *    payloads     container data at 8-byte aligned offsets from the start of the buffer
+ */
+CPPY_API CPPY_ERROR_t CPPY_ROARING_serialize(const CPPY_RoaringBitmap& self, std::vector<char>* const result);
+
+/* Rebuild a bitmap from a buffer produced by CPPY_ROARING_serialize.
+ *
+ *  Raises ValueError if the buffer is truncated or malformed.
+ */
+CPPY_API CPPY_ERROR_t
+CPPY_ROARING_deserialize(const char* data, std::size_t size, CPPY_RoaringBitmap* const result);
+
+/* Validate a serialized buffer and wrap it in a view without copying.
+ *
+ *  Raises ValueError if the buffer is truncated or malformed.
+ */
+CPPY_API CPPY_ERROR_t CPPY_ROARING_view_init(CPPY_RoaringBitmap_view* const self, const char* data, std::size_t size);
+
+CPPY_API CPPY_ERROR_t CPPY_SET_iscontain(const CPPY_RoaringBitmap_view& self, uint32_t element, bool* const result);
+
+CPPY_API CPPY_ERROR_t CPPY_SET_len(const CPPY_RoaringBitmap_view& self, std::size_t* const len);
@@ -2,9 +2,13 @@
 
 #include <algorithm>
 #include <set>
+#include <utility>
 
 #include "cppy/exception.h"
+#include "cppy/flat_set.hpp"
 #include "cppy/internal/declare.h"
+#include "cppy/internal/parallel.h"
+#include "cppy/thread.h"
 
 /* set(iterable) -> new set object
  *
@@ -35,6 +39,23 @@ CPPY_ERROR_t CPPY_SET_add(std::set<T>* const self, const T& element)
     self->insert(element);
     return CPPY_ERROR_t::Ok;
 }
+template <typename T>
+CPPY_ERROR_t CPPY_SET_add(std::set<T>* const self, T&& element)
+{
+    self->insert(std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Construct an element in place and add it to a set.
+ *
+ *  This has no effect if an equal element is already present.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_SET_emplace(std::set<T>* const self, Args&&... args)
+{
+    self->emplace(std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
 
 /* Remove all elements from this set.
  */
@@ -152,6 +173,17 @@ CPPY_ERROR_t CPPY_SET_update(std::set<T>* self, Iterable first, Iterable last)
     return CPPY_ERROR_t::Ok;
 }
 
+/* Update a set with the union of itself and a set that is consumed.
+ *
+ *  Nodes are relinked, not copied; duplicates stay behind in other.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_SET_update(std::set<T>* self, std::set<T>&& other)
+{
+    self->merge(other);
+    return CPPY_ERROR_t::Ok;
+}
+
 /* Remove and return an arbitrary set element.
  *  Raises KeyError if the set is empty.
  */
@@ -161,7 +193,7 @@ CPPY_ERROR_t CPPY_SET_pop(std::set<T>* self, T* element)
     if (self->empty())
         return CPPY_ERROR_t::KeyError;
 
-    *element = self->extract(self->begin()).value();
+    *element = std::move(self->extract(self->begin()).value());
     return CPPY_ERROR_t::Ok;
 }
 
@@ -255,3 +287,101 @@ CPPY_SET_isequal(Iterable1 first_1, Iterable1 last_1, Iterable2 first_2, Iterabl
     *result = true;
     return CPPY_ERROR_t::Ok;
 }
+
+namespace cppy
+{
+namespace internal
+{
+template <typename T>
+void concatenate_parts(std::vector<std::vector<T>>* parts, std::set<T>* const result)
+{
+    result->clear();
+    for (auto& part : *parts)
+        for (auto& element : part)
+            result->insert(result->end(), std::move(element));
+}
+
+template <typename T>
+void concatenate_parts(std::vector<std::vector<T>>* parts, CPPY_FlatSet<T>* const result)
+{
+    std::size_t size = 0;
+    for (const auto& part : *parts)
+        size += part.size();
+    result->items.clear();
+    result->items.reserve(size);
+    for (auto& part : *parts)
+        std::move(part.begin(), part.end(), std::back_inserter(result->items));
+}
+} // namespace internal
+} // namespace cppy
+
+/* Parallel set operations.
+ *
+ *  Same results as the serial overloads above; both inputs must be sorted. The inputs are
+ *  cut into value intervals by splitter elements and each interval is merged on `executor`.
+ *  Small inputs run on the calling thread only. `result` is a std::set or CPPY_FlatSet.
+ */
+template <class Set, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_difference(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                 Iterable1 first_1,
+                                 Iterable1 last_1,
+                                 Iterable2 first_2,
+                                 Iterable2 last_2,
+                                 Set* const result)
+{
+    std::vector<std::vector<typename Set::value_type>> parts;
+    cppy::internal::parallel_set_operation(
+        executor, first_1, last_1, first_2, last_2,
+        [](auto f1, auto l1, auto f2, auto l2, auto out) { std::set_difference(f1, l1, f2, l2, out); }, &parts);
+    cppy::internal::concatenate_parts(&parts, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <class Set, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_intersection(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                   Iterable1 first_1,
+                                   Iterable1 last_1,
+                                   Iterable2 first_2,
+                                   Iterable2 last_2,
+                                   Set* const result)
+{
+    std::vector<std::vector<typename Set::value_type>> parts;
+    cppy::internal::parallel_set_operation(
+        executor, first_1, last_1, first_2, last_2,
+        [](auto f1, auto l1, auto f2, auto l2, auto out) { std::set_intersection(f1, l1, f2, l2, out); }, &parts);
+    cppy::internal::concatenate_parts(&parts, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <class Set, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_symmetric_difference(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                                           Iterable1 first_1,
+                                           Iterable1 last_1,
+                                           Iterable2 first_2,
+                                           Iterable2 last_2,
+                                           Set* const result)
+{
+    std::vector<std::vector<typename Set::value_type>> parts;
+    cppy::internal::parallel_set_operation(
+        executor, first_1, last_1, first_2, last_2,
+        [](auto f1, auto l1, auto f2, auto l2, auto out) { std::set_symmetric_difference(f1, l1, f2, l2, out); },
+        &parts);
+    cppy::internal::concatenate_parts(&parts, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+template <class Set, class Iterable1, class Iterable2>
+CPPY_ERROR_t CPPY_SET_union(CPPY_CONCURRENT_ThreadPoolExecutor* const executor,
+                            Iterable1 first_1,
+                            Iterable1 last_1,
+                            Iterable2 first_2,
+                            Iterable2 last_2,
+                            Set* const result)
+{
+    std::vector<std::vector<typename Set::value_type>> parts;
+    cppy::internal::parallel_set_operation(
+        executor, first_1, last_1, first_2, last_2,
+        [](auto f1, auto l1, auto f2, auto l2, auto out) { std::set_union(f1, l1, f2, l2, out); }, &parts);
+    cppy::internal::concatenate_parts(&parts, result);
+    return CPPY_ERROR_t::Ok;
+}
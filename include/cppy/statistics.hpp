@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "cppy/exception.h"
+#include "cppy/internal/declare.h"
+#include "cppy/internal/select.h"
+
+/* Return the median (middle value) of numeric data.
+ *
+ *  When the number of data points is odd, return the middle data point.
+ *  When the number of data points is even, the median is interpolated by
+ *  taking the average of the two middle values.
+ *
+ *  The data is copied and partially ordered with introselect, so this runs in
+ *  linear time instead of sorting. Raises ValueError if the data is empty.
+ */
+template <class Iterable>
+CPPY_ERROR_t CPPY_STATISTICS_median(Iterable first, Iterable last, double* const result)
+{
+    using T = typename std::iterator_traits<Iterable>::value_type;
+    std::vector<T> data(first, last);
+    const std::size_t n = data.size();
+    if (n == 0)
+        return CPPY_ERROR_t::ValueError;
+
+    if (n % 2 == 1)
+    {
+        const std::size_t positions[] = {n / 2};
+        cppy::internal::select_positions(data.begin(), data.end(), positions, positions + 1);
+        *result = static_cast<double>(data[n / 2]);
+    }
+    else
+    {
+        const std::size_t positions[] = {n / 2 - 1, n / 2};
+        cppy::internal::select_positions(data.begin(), data.end(), positions, positions + 2);
+        *result = (static_cast<double>(data[n / 2 - 1]) + static_cast<double>(data[n / 2])) / 2.0;
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the low median of data.
+ *
+ *  When the number of data points is odd, the middle value is returned.
+ *  When it is even, the smaller of the two middle values is returned.
+ */
+template <class Iterable, typename T>
+CPPY_ERROR_t CPPY_STATISTICS_median_low(Iterable first, Iterable last, T* const result)
+{
+    std::vector<T> data(first, last);
+    if (data.empty())
+        return CPPY_ERROR_t::ValueError;
+
+    const std::size_t positions[] = {(data.size() - 1) / 2};
+    cppy::internal::select_positions(data.begin(), data.end(), positions, positions + 1);
+    *result = data[positions[0]];
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Return the high median of data.
+ *
+ *  When the number of data points is odd, the middle value is returned.
+ *  When it is even, the larger of the two middle values is returned.
+ */
+template <class Iterable, typename T>
+CPPY_ERROR_t CPPY_STATISTICS_median_high(Iterable first, Iterable last, T* const result)
+{
+    std::vector<T> data(first, last);
+    if (data.empty())
+        return CPPY_ERROR_t::ValueError;
+
+    const std::size_t positions[] = {data.size() / 2};
+    cppy::internal::select_positions(data.begin(), data.end(), positions, positions + 1);
+    *result = data[positions[0]];
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Divide data into n continuous intervals with equal probability.
+ *
+ *  Returns a list of n - 1 cut points separating the intervals.
+ *
+ *  Set n to 4 for quartiles (the default). Set n to 10 for deciles.
+ *  Set n to 100 for percentiles which gives the 99 cuts points that
+ *  separate data into 100 equal sized groups.
+ *
+ *  The data can be any iterable containing sample. The cut points are
+ *  linearly interpolated between data points. If inclusive is false (the
+ *  default, Python's method='exclusive'), the data is treated as a sample
+ *  from a larger population; if true, as the whole population.
+ *
+ *  Only the order statistics that the cut points read are selected, rather
+ *  than sorting the data. Raises ValueError if n < 1 or the data is empty.
+ */
+template <class Iterable>
+CPPY_ERROR_t CPPY_STATISTICS_quantiles(
+    Iterable first, Iterable last, std::vector<double>* const result, int n = 4, bool inclusive = false)
+{
+    using T = typename std::iterator_traits<Iterable>::value_type;
+    if (n < 1)
+        return CPPY_ERROR_t::ValueError;
+    std::vector<T> data(first, last);
+    const long long ld = static_cast<long long>(data.size());
+    if (ld == 0)
+        return CPPY_ERROR_t::ValueError;
+
+    result->clear();
+    if (ld == 1)
+    {
+        result->assign(static_cast<std::size_t>(n - 1), static_cast<double>(data[0]));
+        return CPPY_ERROR_t::Ok;
+    }
+
+    // (lower index, weight numerator of the upper neighbour) for each cut point
+    const long long m = inclusive ? ld - 1 : ld + 1;
+    std::vector<std::pair<long long, long long>> cuts;
+    std::vector<std::size_t> positions;
+    for (long long i = 1; i < n; ++i)
+    {
+        long long j = i * m / n;
+        long long delta = i * m - j * n;
+        if (!inclusive)
+        {
+            j = j < 1 ? 1 : (j > ld - 1 ? ld - 1 : j);
+            delta = i * m - j * n;
+            j -= 1;
+        }
+        cuts.push_back({j, delta});
+        positions.push_back(static_cast<std::size_t>(j));
+        positions.push_back(static_cast<std::size_t>(j + 1));
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    cppy::internal::select_positions(
+        data.begin(), data.end(), positions.data(), positions.data() + positions.size());
+
+    for (const auto& [j, delta] : cuts)
+    {
+        const double low = static_cast<double>(data[static_cast<std::size_t>(j)]);
+        const double high = static_cast<double>(data[static_cast<std::size_t>(j + 1)]);
+        result->push_back((low * static_cast<double>(n - delta) + high * static_cast<double>(delta)) / n);
+    }
+    return CPPY_ERROR_t::Ok;
+}
@@ -1,19 +1,242 @@
 ﻿#pragma once
 
+#include <algorithm>          //sort
+#include <atomic>             //atomic
+#include <chrono>             //milliseconds
 #include <condition_variable> //condition_variable
+#include <deque>              //deque
 #include <future>             //packaged_task
+#include <iterator>           //iterator_traits
+#include <limits>             //numeric_limits
+#include <memory>             //unique_ptr
 #include <mutex>              //unique_lock
-#include <queue>              //queue
+#include <optional>           //optional
+#include <stdexcept>          //runtime_error
+#include <string>             //string
 #include <thread>             //thread
+#include <tuple>              //make_tuple, apply
 #include <type_traits>        //invoke_result, enable_if, is_invocable
+#include <utility>            //pair
 #include <vector>             //vector
 
 #include "cppy/internal/declare.h"
+#include "cppy/internal/deque.h"
+#include "cppy/internal/histogram.h"
+#include "cppy/internal/ring.h"
+#include "cppy/internal/task.h"
 #include "cppy/exception.h"
+#include "cppy/future.h"
+#include "cppy/platform.h"
+
+// What a bounded CPPY_CONCURRENT_ThreadPoolExecutor does with a task its queue has no place for.
+enum class CPPY_CONCURRENT_overflow_t : unsigned int {
+    Block = 0,
+    Reject = 1,
+    CallerRuns = 2,
+};
+
+/* How a CPPY_CONCURRENT_ThreadPoolExecutor is built.
+ *
+ *  max_workers
+ *    The number of worker threads.
+ *  work_stealing
+ *    Give every worker its own Chase-Lev deque. A task submitted from inside a worker is
+ *    pushed to that worker's deque and popped LIFO, while it is still in cache; an idle worker
+ *    takes from the shared queue and then steals, oldest first, from randomly chosen workers.
+ *    Otherwise all workers share one FIFO queue.
+ *  pin_workers
+ *    Pin every worker to one CPU, taking the CPUs the process may run on in turn, so that
+ *    the OS does not move it away from its cache.
+ *  numa_aware
+ *    Deal the workers out over the NUMA nodes round robin and keep each one on the CPUs of
+ *    its node, with pin_workers on one of them. Every node gets its own submission queue: a
+ *    task goes to the queue of the node it is submitted from, or of the node named by
+ *    post_on or spawn_on, and the workers of a node take from its queue first and from the
+ *    other nodes' only when theirs is empty.
+ *  spin_count, yield_count
+ *    The idle policy. A worker that runs out of tasks polls for new ones spin_count times
+ *    with a pause instruction in between, then yield_count times giving up its CPU in
+ *    between, and only then sleeps on a condition variable, which costs a system call to
+ *    wake from. Polling longer answers a burst after a quiet spell sooner, at the price of
+ *    CPU time. On a single CPU the spinning is skipped: nobody could submit meanwhile.
+ *  min_workers, idle_timeout
+ *    The elastic size. The pool starts min_workers workers (at most max_workers, which is
+ *    the default) and starts more, up to max_workers, while tasks queue up with no idle
+ *    worker to take them. A worker above min_workers that sleeps idle_timeout without
+ *    finding a task exits.
+ *  starvation_limit
+ *    How long tasks of a priority class may wait while workers keep taking tasks of higher
+ *    classes. Once they have waited that long, the next free worker takes one of them.
+ *  max_queued, overflow
+ *    Bounded mode: with max_queued > 0, at most that many tasks wait for a worker, and a
+ *    submission beyond it is handled by the overflow policy. Block waits for a place, or
+ *    runs the task on the spot when the submitter is a worker of the pool, which might
+ *    otherwise wait for itself. Reject raises CPPY_CONCURRENT_QueueFullError. CallerRuns
+ *    runs the task on the submitting thread, which slows the submitter down to the pace
+ *    of the pool. Continuations and the helpers of parallel loops are never refused, but
+ *    count towards the bound.
+ */
+struct CPPY_CONCURRENT_ThreadPoolOptions {
+    size_t max_workers = std::thread::hardware_concurrency();
+    bool work_stealing = false;
+    bool pin_workers = false;
+    bool numa_aware = false;
+    size_t spin_count = 256;
+    size_t yield_count = 8;
+    size_t min_workers = static_cast<size_t>(-1);
+    std::chrono::milliseconds idle_timeout{1000};
+    std::chrono::milliseconds starvation_limit{50};
+    size_t max_queued = 0;
+    CPPY_CONCURRENT_overflow_t overflow = CPPY_CONCURRENT_overflow_t::Block;
+};
+
+// Raised by a submission to a bounded pool whose queue is full, under the Reject policy.
+class CPPY_CONCURRENT_QueueFullError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// What the future of a task holds when its cancellation token was cancelled before it ran.
+class CPPY_CONCURRENT_CancelledError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// The observing side of a CPPY_CONCURRENT_CancellationSource. A default-constructed token
+//  is never cancelled.
+class CPPY_CONCURRENT_CancellationToken {
+public:
+    CPPY_CONCURRENT_CancellationToken() = default;
+
+    bool cancelled() const { return _state && _state->load(std::memory_order_acquire); }
+    // Whether a source can cancel this token at all.
+    bool cancellable() const { return _state != nullptr; }
+
+private:
+    friend class CPPY_CONCURRENT_CancellationSource;
+    explicit CPPY_CONCURRENT_CancellationToken(std::shared_ptr<const std::atomic<bool>> state)
+        : _state(std::move(state)) {}
+
+    std::shared_ptr<const std::atomic<bool>> _state;
+};
+
+/* Cooperative cancellation, shared by any number of tasks.
+ *
+ *  Pass source.token() in the CPPY_CONCURRENT_TaskOptions of spawn_with or post_with. Once
+ *  source.cancel() is called, a task that has not started yet is dropped when a worker
+ *  takes it: it does not run, and its future raises CPPY_CONCURRENT_CancelledError. A task
+ *  that is running is not interrupted; it can check token.cancelled() and return early.
+ */
+class CPPY_CONCURRENT_CancellationSource {
+public:
+    CPPY_CONCURRENT_CancellationSource() : _state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() { _state->store(true, std::memory_order_release); }
+    bool cancelled() const { return _state->load(std::memory_order_acquire); }
+    CPPY_CONCURRENT_CancellationToken token() const { return CPPY_CONCURRENT_CancellationToken(_state); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> _state;
+};
+
+// The priority classes of the tasks of a CPPY_CONCURRENT_ThreadPoolExecutor, highest first.
+enum class CPPY_CONCURRENT_priority_t : unsigned int {
+    High = 0,
+    Normal = 1,
+    Low = 2,
+};
+
+/* How a task given to spawn_with or post_with is scheduled.
+ *
+ *  priority
+ *    A free worker takes a task of the highest class that has one waiting, except that a
+ *    class passed over for the pool's starvation_limit goes first.
+ *  deadline
+ *    Within a class, tasks with a deadline are taken earliest deadline first, ahead of the
+ *    ones without, which are taken in submission order. A task that misses its deadline
+ *    still runs.
+ *  cancellation
+ *    A token of a CPPY_CONCURRENT_CancellationSource, to drop the task if it is cancelled
+ *    before the task starts.
+ */
+struct CPPY_CONCURRENT_TaskOptions {
+    CPPY_CONCURRENT_priority_t priority = CPPY_CONCURRENT_priority_t::Normal;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    CPPY_CONCURRENT_CancellationToken cancellation{};
+};
+
+/* A distribution of durations in nanoseconds, in log-linear buckets: percentiles are exact
+ *  to within 1/16 of the value. Durations past about 18 minutes count as 18 minutes.
+ */
+class CPPY_API CPPY_CONCURRENT_Histogram {
+public:
+    CPPY_CONCURRENT_Histogram();
+
+    void record(uint64_t value, uint64_t times = 1);
+    void merge(const CPPY_CONCURRENT_Histogram& other);
+
+    uint64_t count() const { return _count; }
+    uint64_t min() const { return _count ? _min : 0; }
+    uint64_t max() const { return _max; }
+    double mean() const { return _count ? static_cast<double>(_sum) / static_cast<double>(_count) : 0.0; }
+    // The value that `p` percent of the recorded values are at most, for p in [0, 100].
+    uint64_t percentile(double p) const;
+
+private:
+    friend class CPPY_CONCURRENT_ThreadPoolExecutor;
+
+    std::vector<uint64_t> _counts;
+    uint64_t _count = 0;
+    uint64_t _sum = 0;
+    uint64_t _min = std::numeric_limits<uint64_t>::max();
+    uint64_t _max = 0;
+};
+
+// What one worker of a CPPY_CONCURRENT_ThreadPoolExecutor has done since the pool started.
+struct CPPY_CONCURRENT_WorkerStats {
+    uint64_t completed = 0;
+    uint64_t steals = 0;
+    std::chrono::nanoseconds busy{0}; // running tasks
+    std::chrono::nanoseconds idle{0}; // looking for a task, polling or asleep
+    CPPY_CONCURRENT_Histogram queue_wait;
+    CPPY_CONCURRENT_Histogram run_time;
+
+    // The share of its time the worker spent running tasks, in [0, 1].
+    double utilisation() const;
+};
+
+/* A snapshot of the counters of a CPPY_CONCURRENT_ThreadPoolExecutor.
+ *
+ *  The pool records only when cppy is built with CPPY_THREAD_STATS; otherwise `enabled` is
+ *  false, only `pending` is counted and the other fields are unavailable, left zero. Each
+ *  worker writes counters of its own, so recording adds two clock reads per task and no
+ *  shared writes from the workers; a snapshot sums them. `submitted` counts the tasks the
+ *  pool accepted, continuations of its futures included, and `ran_inline` those of them the
+ *  submitting thread ran itself because the queue was full. The helper tasks of parallel_for
+ *  and map are counted in neither these nor `completed`. Once the pool is idle, submitted is
+ *  completed + ran_inline + discarded. to_text and to_json format the snapshot for a log or
+ *  a metrics scraper.
+ */
+struct CPPY_API CPPY_CONCURRENT_ThreadPoolStats {
+    bool enabled = false;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t ran_inline = 0; // run by the submitting thread: CallerRuns, or a full queue met from a worker
+    uint64_t discarded = 0;  // dropped by shutdown without running
+    size_t pending = 0;     // queued and not yet taken by a worker
+    uint64_t steals = 0;
+    CPPY_CONCURRENT_Histogram queue_wait; // from submission to the start of the task
+    CPPY_CONCURRENT_Histogram run_time;
+    std::vector<CPPY_CONCURRENT_WorkerStats> workers;
+
+    std::string to_text() const;
+    std::string to_json() const;
+};
 
 class CPPY_API CPPY_CONCURRENT_ThreadPoolExecutor {
 public:
     CPPY_CONCURRENT_ThreadPoolExecutor(size_t max_workers = std::thread::hardware_concurrency());
+    CPPY_CONCURRENT_ThreadPoolExecutor(const CPPY_CONCURRENT_ThreadPoolOptions& options);
     ~CPPY_CONCURRENT_ThreadPoolExecutor();
 
     CPPY_CONCURRENT_ThreadPoolExecutor(const CPPY_CONCURRENT_ThreadPoolExecutor& other) = delete;
@@ -23,79 +246,425 @@ public:
         std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
     auto submit(F&&, Args &&...);
 
-    void shutdown();
+    // Like submit, but the result is a CPPY_CONCURRENT_Future, whose shared state is
+    //  recycled instead of allocated, and whose continuations (then()) run on this pool.
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    auto spawn(F&&, Args &&...);
+
+    // Fire and forget: run function(args...) with no way to wait for it or get its result.
+    //  An exception it throws is dropped. A callable of up to Task::kInlineSize bytes is
+    //  stored in a recycled task, so this does not allocate.
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    void post(F&&, Args &&...);
+
+    // spawn and post with a locality hint: queue the task on NUMA node `node`, the id of a
+    //  CPPY_PLATFORM_NumaNode, e.g. the node that holds the task's data. A worker of that node
+    //  runs it unless they are all busy while another node's are idle. In a pool that is not
+    //  numa_aware, or for a node it has no workers on, these are spawn and post.
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    auto spawn_on(int node, F&&, Args &&...);
+
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    void post_on(int node, F&&, Args &&...);
+
+    // spawn and post with a priority class and a deadline. Continuations of the future run
+    //  at normal priority. Tasks with the default options take the same path as spawn and
+    //  post; the others wait in one queue per class, shared by all NUMA nodes.
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    auto spawn_with(const CPPY_CONCURRENT_TaskOptions& options, F&&, Args &&...);
+
+    template <typename F, typename... Args,
+        std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int> = 0>
+    void post_with(const CPPY_CONCURRENT_TaskOptions& options, F&&, Args &&...);
+
+    // Python's Executor.map: func(x) for every x in [first, last), computed in parallel and
+    //  written to result in input order. Returns the end of the output.
+    //
+    //  The calls are grouped into chunks of `grain` items. With grain 0 the chunk size is
+    //  adaptive: the calling thread times growing chunks first and sizes the rest to take
+    //  about 50 us, and a short input never leaves the calling thread. The first exception
+    //  func throws is rethrown, once the chunks already started have finished.
+    template <class Func, class Iterable, class OutputIter>
+    OutputIter map(Func func, Iterable first, Iterable last, OutputIter result, size_t grain = 0);
+
+    // func(i) for every i in [begin, end), in parallel, chunked as in map. The calling
+    //  thread takes chunks too, so this may be called from inside a task of this pool.
+    template <class Func>
+    void parallel_for(size_t begin, size_t end, Func func, size_t grain = 0);
+
+    // init op x0 op x1 ... op xn-1 over [first, last), with op associative. Each chunk is
+    //  folded on its own and the partial results are combined in input order, so op need
+    //  not be commutative. Floating-point results depend on the chunking; give a grain for
+    //  reproducible ones.
+    template <class Iterable, class T, class Op>
+    T parallel_reduce(Iterable first, Iterable last, T init, Op op, size_t grain = 0);
+
+    // Python's Executor.shutdown: refuse new tasks, then with `wait` return once the queued
+    //  tasks have run and the workers have stopped, and otherwise at once, leaving the
+    //  workers to finish in the background. With `cancel_futures` the tasks that have not
+    //  started yet are dropped instead of run; their futures raise
+    //  CPPY_CONCURRENT_CancelledError. Submitting from outside the workers afterwards raises
+    //  std::runtime_error; the tasks still running may submit more, which are run (or
+    //  dropped) too. Safe to call more than once; the destructor calls shutdown().
+    void shutdown(bool wait = true, bool cancel_futures = false);
+
+    size_t max_workers() const { return _worker_count; }
+    // The number of workers running now: between min_workers and max_workers, and 0 once a
+    //  shutdown has waited for them.
+    size_t workers() const { return _live.load(); }
+    bool work_stealing() const { return _work_stealing; }
+    // The number of submission queues: one per NUMA node in a numa_aware pool, otherwise one.
+    size_t numa_nodes() const { return _queue_count; }
+    // The number of tasks of a priority class waiting for a worker. The count of the normal
+    //  class is approximate while tasks are being submitted.
+    size_t queue_depth(CPPY_CONCURRENT_priority_t priority) const;
+    // The instrumentation counters; see CPPY_CONCURRENT_ThreadPoolStats.
+    CPPY_CONCURRENT_ThreadPoolStats stats() const;
 
 private:
-    //_task_container_base and _task_container exist simply as a wrapper around a
-    //  MoveConstructible - but not CopyConstructible - Callable object. Since an
-    //  std::function requires a given Callable to be CopyConstructible, we
-    //  cannot construct one from a lambda function that captures a
-    //  non-CopyConstructible object (such as the packaged_task declared in
-    //  execute) - because a lambda capturing a non-CopyConstructible object is
-    //  not CopyConstructible.
-
-    //_task_container_base exists only to serve as an abstract base for
-    //  _task_container.
-    class _task_container_base {
-    public:
-        virtual ~_task_container_base() {};
-
-        virtual void operator()() = 0;
+    using _task = cppy::internal::Task;
+
+    // tasks submitted from outside the workers go to a lock-free ring of this many
+    //  slots, and on to a locked overflow queue only when it is full
+    static constexpr size_t _ring_capacity = 4096;
+
+    // a submission queue; there is one per NUMA node in a numa_aware pool
+    struct alignas(64) _queue {
+        cppy::internal::MpmcRing<_task*> tasks{_ring_capacity};
+        std::mutex mutex;
+        std::deque<_task*> overflow;
+        std::atomic<size_t> overflowed{0}; // tasks in overflow
+    };
+
+    // the queue of the submitting thread's node
+    static constexpr size_t _home_queue = static_cast<size_t>(-1);
+
+    static constexpr size_t _priority_count = 3;
+
+    // a task waiting in the queue of its priority class, a heap on (deadline, sequence)
+    struct _prioritized {
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t sequence;
+        _task* task;
+        // heap order: true when a is taken after b
+        static bool later(const _prioritized& a, const _prioritized& b) {
+            return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
+        }
     };
-    using _task_ptr = std::unique_ptr<_task_container_base>;
-
-    //_task_container takes a typename F, which must be Callable and
-    // MoveConstructible.
-    //  Furthermore, F must be callable with no arguments; it can, for example,
-    //  be a bind object with no placeholders. F may or may not be
-    //  CopyConstructible.
-    template <typename F, std::enable_if_t<std::is_invocable_v<F&&>, int> = 0>
-    class _task_container : public _task_container_base {
-    public:
-        // here, std::forward is needed because we need the construction of _f not
-        //  to bind an lvalue reference - it is not a guarantee that an object of
-        //  type F is CopyConstructible, only that it is MoveConstructible.
-        _task_container(F&& func) : _f(std::forward<F>(func)) {}
-
-        void operator()() override { _f(); }
-
-    private:
-        F _f;
+
+    // a place for a worker: where it runs, and its thread while it does
+    struct _slot {
+        std::thread thread;
+        std::vector<int> cpus; // the CPUs it is restricted to, none for all
+        size_t queue = 0;      // the submission queue it takes from first
+        bool running = false;  // guarded by _grow_mutex
+    };
+
+    // what a worker slot has done, written by its worker only
+    struct alignas(64) _slot_stats {
+        cppy::internal::HistogramRecorder queue_wait;
+        cppy::internal::HistogramRecorder run_time;
+        std::atomic<uint64_t> submitted{0}; // by the worker, as the submitting thread
+        std::atomic<uint64_t> ran_inline{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<int64_t> busy{0};       // nanoseconds
+        std::atomic<int64_t> idle{0};       // nanoseconds
+        std::atomic<int64_t> idle_since{0}; // when the worker ran out of tasks, 0 while it has one
+    };
+
+    // per-worker state of the work-stealing mode, on its own cache lines
+    struct alignas(64) _worker {
+        cppy::internal::WorkStealingDeque<_task*> tasks;
+        uint64_t random = 0;
+    };
+
+    // what the futures spawned here schedule their continuations through. It outlives the
+    //  pool while they do: the destructor clears `pool`, then waits out the callers that
+    //  read it, and later continuations run inline.
+    struct _scheduling {
+        std::atomic<CPPY_CONCURRENT_ThreadPoolExecutor*> pool;
+        std::atomic<size_t> callers{0};
     };
 
-    template <typename F> _task_container(F) -> _task_container<std::decay<F>>;
+    using _chunk_body = void (*)(void* context, size_t begin, size_t end);
+    struct _loop;
+    // a task of _parallel, which the task statistics leave out
+    struct _helper;
+
+    template <class Body>
+    static void _call_chunk(void* body, size_t begin, size_t end) {
+        (*static_cast<Body*>(body))(begin, end);
+    }
+
+    // Indexed access to [first, last): random-access iterators directly, others through a
+    //  vector of iterators.
+    template <class Iterable, bool = std::is_base_of_v<std::random_access_iterator_tag,
+        typename std::iterator_traits<Iterable>::iterator_category>>
+    struct _indexed {
+        _indexed(Iterable first, Iterable last) : first(first), size(static_cast<size_t>(last - first)) {}
+        decltype(auto) operator[](size_t i) const { return first[i]; }
+        Iterable first;
+        size_t size;
+    };
+    template <class Iterable>
+    struct _indexed<Iterable, false> {
+        _indexed(Iterable first, Iterable last) {
+            for (; first != last; ++first)
+                positions.push_back(first);
+            size = positions.size();
+        }
+        decltype(auto) operator[](size_t i) const { return *positions[i]; }
+        std::vector<Iterable> positions;
+        size_t size;
+    };
+
+    void _parallel(size_t begin, size_t end, size_t grain, _chunk_body body, void* context);
+    template <typename F, typename... Args>
+    auto _spawn(size_t queue, const CPPY_CONCURRENT_TaskOptions& options, F&&, Args &&...);
+    template <typename F, typename... Args>
+    void _post(size_t queue, const CPPY_CONCURRENT_TaskOptions& options, F&&, Args &&...);
+
+    // the Scheduler of the futures spawned here
+    static void _schedule(void* scheduling, _task* task);
+    size_t _node_queue(int node) const;
+    size_t _submitter_queue() const;
+    void _push(_task* task, size_t queue = _home_queue);
+    void _push_batch(_task* const* tasks, size_t n, size_t queue = _home_queue);
+    // what the public submissions go through: the stop flag and the bound, then _enqueue
+    void _submit(_task* task, size_t queue, const CPPY_CONCURRENT_TaskOptions& options);
+    bool _reserve();
+    void _unreserve(size_t n);
+    void _enqueue(_task* const* tasks, size_t n, size_t queue);
+    void _enqueue(_task* task, size_t queue, const CPPY_CONCURRENT_TaskOptions& options);
+    _task* _take_prioritized(bool plain_waiting);
+    _task* _take(size_t index, size_t queue);
+    _task* _steal(size_t index);
+    bool _idle_poll();
+    void _start(size_t index);
+    void _grow();
+    bool _retire(size_t index);
+    void _run(size_t index);
+    void _discard_queued();
+
+    // instrumentation, which does nothing unless built with CPPY_THREAD_STATS
+    void _task_submitted(bool ran_inline);
+    int64_t _task_started(size_t index, const _task* task, bool counted);
+    void _task_finished(size_t index, int64_t started, bool counted);
+    void _worker_idle(size_t index);
+    void _worker_stopped(size_t index);
+    static void _snapshot(const cppy::internal::HistogramRecorder& recorder, CPPY_CONCURRENT_Histogram* histogram);
+
+    std::vector<_slot> _slots;
+#if defined(CPPY_THREAD_STATS)
+    std::unique_ptr<_slot_stats[]> _stats;
+    std::atomic<uint64_t> _submitted{0}; // by threads outside the pool
+    std::atomic<uint64_t> _ran_inline{0};
+    std::atomic<uint64_t> _discarded{0};
+#endif
+    std::unique_ptr<_worker[]> _workers;
+    size_t _worker_count = 0; // the number of slots, set before any thread starts
+    bool _work_stealing = false;
+
+    size_t _spin_count = 0;
+    size_t _yield_count = 0;
+    size_t _min_workers = 0;
+    std::chrono::milliseconds _idle_timeout{0};
+    std::mutex _grow_mutex;       // starting and retiring workers
+    std::atomic<size_t> _live{0}; // workers running
+
+    std::unique_ptr<_queue[]> _queues;
+    size_t _queue_count = 1;
+    std::vector<int> _queue_nodes;   // the NUMA node of each queue
+    std::vector<size_t> _cpu_queues; // the queue of each CPU
+    // tasks with a priority or a deadline, one heap per class. The normal class only holds
+    //  the ones with a deadline, which go before the plain tasks of the queues above.
+    std::mutex _priority_mutex;
+    std::vector<_prioritized> _priority_heaps[_priority_count];
+    // since when each class has had tasks waiting while a higher one was served, or max()
+    std::chrono::steady_clock::time_point _passed_over[_priority_count];
+    uint64_t _priority_sequence = 0;
+    std::chrono::milliseconds _starvation_limit{0};
+    std::atomic<size_t> _heap_sizes[_priority_count] = {};
+    std::atomic<size_t> _prioritized_count{0}; // tasks in all heaps, for the workers' fast check
+
+    size_t _max_queued = 0; // 0 for no bound
+    CPPY_CONCURRENT_overflow_t _overflow = CPPY_CONCURRENT_overflow_t::Block;
+    std::mutex _space_mutex;
+    std::condition_variable _space_cv;
+    std::atomic<size_t> _blocked{0}; // submitters waiting on _space_cv
 
-    std::vector<std::thread> _threads;
-    std::queue<_task_ptr> _tasks;
     std::mutex _task_mutex;
     std::condition_variable _task_cv;
-    bool _stop_threads = false;
+    std::atomic<size_t> _pending{0};  // tasks submitted and not yet taken by a worker
+    std::atomic<size_t> _sleepers{0}; // workers waiting on _task_cv
+    std::atomic<size_t> _spinning{0}; // workers polling before they sleep
+    std::atomic<bool> _stop_threads{false};
+    std::atomic<bool> _cancel_futures{false}; // set by a shutdown that cancels the queued tasks
+    std::shared_ptr<_scheduling> _scheduler;
 };
 
 template <typename F, typename... Args,
     std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
     auto CPPY_CONCURRENT_ThreadPoolExecutor::submit(F&& function, Args &&...args) {
-    std::unique_lock<std::mutex> queue_lock(_task_mutex, std::defer_lock);
-    std::packaged_task<std::invoke_result_t<F, Args...>()> task_pkg(
-        // in C++20, this could be:
-        // [..., _fargs = std::forward<Args>(args)...]
-        [_f = std::move(function),
+    using R = std::invoke_result_t<F, Args...>;
+    // a promise rather than a packaged_task, so that a task dropped by
+    //  shutdown(cancel_futures=true) can store CancelledError in its future
+    cppy::internal::StdPromise<R> promise;
+    std::future<R> future = promise.get_future();
+
+    // this lambda move-captures the promise declared above. Since the promise
+    //  type is not CopyConstructible, the function is not CopyConstructible
+    //  either - hence the need for a Task to wrap around it. In C++20, the
+    //  arguments could be captured as [..., _fargs = std::forward<Args>(args)...]
+    _submit(_task::make([promise = std::move(promise), _f = std::forward<F>(function),
         _fargs = std::make_tuple(std::forward<Args>(args)...)]() mutable {
-            return std::apply(std::move(_f), std::move(_fargs));
-        });
-    std::future<std::invoke_result_t<F, Args...>> future = task_pkg.get_future();
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    std::apply(std::move(_f), std::move(_fargs));
+                    promise.set_value();
+                }
+                else {
+                    promise.set_value(std::apply(std::move(_f), std::move(_fargs)));
+                }
+            }
+            catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }), _home_queue, CPPY_CONCURRENT_TaskOptions{});
 
-    queue_lock.lock();
-    // this lambda move-captures the packaged_task declared above. Since the
-    //  packaged_task type is not CopyConstructible, the function is not
-    //  CopyConstructible either - hence the need for a _task_container to wrap
-    //  around it.
-    _tasks.emplace(_task_ptr(
-        new _task_container([task(std::move(task_pkg))]() mutable { task(); })));
+    return future;
+}
 
-    queue_lock.unlock();
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    auto CPPY_CONCURRENT_ThreadPoolExecutor::spawn(F&& function, Args &&...args) {
+    return _spawn(_home_queue, CPPY_CONCURRENT_TaskOptions{}, std::forward<F>(function), std::forward<Args>(args)...);
+}
 
-    _task_cv.notify_one();
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    auto CPPY_CONCURRENT_ThreadPoolExecutor::spawn_on(int node, F&& function, Args &&...args) {
+    return _spawn(_node_queue(node), CPPY_CONCURRENT_TaskOptions{}, std::forward<F>(function),
+        std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    auto CPPY_CONCURRENT_ThreadPoolExecutor::spawn_with(
+        const CPPY_CONCURRENT_TaskOptions& options, F&& function, Args &&...args) {
+    return _spawn(_home_queue, options, std::forward<F>(function), std::forward<Args>(args)...);
+}
 
+template <typename F, typename... Args>
+auto CPPY_CONCURRENT_ThreadPoolExecutor::_spawn(
+    size_t queue, const CPPY_CONCURRENT_TaskOptions& options, F&& function, Args &&...args) {
+    auto [promise, future] = cppy::internal::make_promise<std::invoke_result_t<F, Args...>>(
+        cppy::internal::Scheduler{&_schedule, _scheduler});
+    if (options.cancellation.cancellable()) {
+        _submit(_task::make([token = options.cancellation, promise = std::move(promise), _f = std::forward<F>(function),
+            _fargs = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                if (token.cancelled())
+                    promise.set_exception(std::make_exception_ptr(CPPY_CONCURRENT_CancelledError("task cancelled")));
+                else
+                    promise.run([&]() { return std::apply(std::move(_f), std::move(_fargs)); });
+            }), queue, options);
+    }
+    else {
+        _submit(_task::make([promise = std::move(promise), _f = std::forward<F>(function),
+            _fargs = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                promise.run([&]() { return std::apply(std::move(_f), std::move(_fargs)); });
+            }), queue, options);
+    }
     return std::move(future);
 }
+
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    void CPPY_CONCURRENT_ThreadPoolExecutor::post(F&& function, Args &&...args) {
+    _post(_home_queue, CPPY_CONCURRENT_TaskOptions{}, std::forward<F>(function), std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    void CPPY_CONCURRENT_ThreadPoolExecutor::post_on(int node, F&& function, Args &&...args) {
+    _post(_node_queue(node), CPPY_CONCURRENT_TaskOptions{}, std::forward<F>(function),
+        std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args,
+    std::enable_if_t<std::is_invocable_v<F&&, Args &&...>, int>>
+    void CPPY_CONCURRENT_ThreadPoolExecutor::post_with(
+        const CPPY_CONCURRENT_TaskOptions& options, F&& function, Args &&...args) {
+    _post(_home_queue, options, std::forward<F>(function), std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args>
+void CPPY_CONCURRENT_ThreadPoolExecutor::_post(
+    size_t queue, const CPPY_CONCURRENT_TaskOptions& options, F&& function, Args &&...args) {
+    if (options.cancellation.cancellable()) {
+        _submit(_task::make([token = options.cancellation, _f = std::forward<F>(function),
+            _fargs = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                if (!token.cancelled())
+                    std::apply(std::move(_f), std::move(_fargs));
+            }), queue, options);
+    }
+    else if constexpr (sizeof...(Args) == 0 && std::is_invocable_v<std::decay_t<F>&>) {
+        _submit(_task::make(std::forward<F>(function)), queue, options);
+    }
+    else {
+        _submit(_task::make([_f = std::forward<F>(function),
+            _fargs = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                std::apply(std::move(_f), std::move(_fargs));
+            }), queue, options);
+    }
+}
+
+template <class Func, class Iterable, class OutputIter>
+OutputIter CPPY_CONCURRENT_ThreadPoolExecutor::map(
+    Func func, Iterable first, Iterable last, OutputIter result, size_t grain) {
+    using T = std::decay_t<std::invoke_result_t<Func&, typename std::iterator_traits<Iterable>::reference>>;
+    const _indexed<Iterable> items(first, last);
+    std::vector<std::optional<T>> values(items.size);
+    parallel_for(0, items.size, [&](size_t i) { values[i].emplace(func(items[i])); }, grain);
+    for (std::optional<T>& value : values) {
+        *result = std::move(*value);
+        ++result;
+    }
+    return result;
+}
+
+template <class Func>
+void CPPY_CONCURRENT_ThreadPoolExecutor::parallel_for(size_t begin, size_t end, Func func, size_t grain) {
+    auto body = [&func](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i)
+            func(i);
+    };
+    _parallel(begin, end, grain, &_call_chunk<decltype(body)>, &body);
+}
+
+template <class Iterable, class T, class Op>
+T CPPY_CONCURRENT_ThreadPoolExecutor::parallel_reduce(Iterable first, Iterable last, T init, Op op, size_t grain) {
+    const _indexed<Iterable> items(first, last);
+    std::mutex partials_mutex;
+    std::vector<std::pair<size_t, T>> partials;
+    auto body = [&](size_t lo, size_t hi) {
+        T partial(items[lo]);
+        for (size_t i = lo + 1; i < hi; ++i)
+            partial = op(std::move(partial), items[i]);
+        std::lock_guard<std::mutex> lock(partials_mutex);
+        partials.emplace_back(lo, std::move(partial));
+    };
+    _parallel(0, items.size, grain, &_call_chunk<decltype(body)>, &body);
+
+    std::sort(partials.begin(), partials.end(),
+        [](const std::pair<size_t, T>& a, const std::pair<size_t, T>& b) { return a.first < b.first; });
+    for (std::pair<size_t, T>& partial : partials)
+        init = op(std::move(init), std::move(partial.second));
+    return init;
+}
@@ -2,15 +2,123 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "cppy/exception.h"
 #include "cppy/internal/declare.h"
+#include "cppy/internal/simd.h"
+
+namespace cppy
+{
+namespace internal
+{
+// Raw pointers and std::vector iterators address contiguous memory.
+template <typename Iterable>
+struct is_contiguous_iterator
+{
+    using value_type = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    static constexpr bool value =
+        std::is_pointer_v<Iterable> ||
+        (!std::is_same_v<value_type, bool> &&
+         (std::is_same_v<Iterable, typename std::vector<value_type>::iterator> ||
+          std::is_same_v<Iterable, typename std::vector<value_type>::const_iterator>));
+};
+
+template <typename Iterable>
+inline constexpr bool is_contiguous_iterator_v = is_contiguous_iterator<Iterable>::value;
+
+// Python's list.insert() index rule: negative counts from the end, out of range clamps.
+inline int insert_position(int index, int len)
+{
+    if (index >= len)
+        return len;
+    if (index < 0)
+    {
+        index += len;
+        if (index < 0)
+            index = 0;
+    }
+    return index;
+}
+
+// Grow capacity to at least `needed`, never less than doubling, so that a run of
+// planned extends stays amortised O(1) instead of reallocating to each exact size.
+template <class Vector>
+void reserve_at_least(Vector* const self, std::size_t needed)
+{
+    if (needed > self->capacity())
+        self->reserve(std::max(needed, 2 * self->capacity()));
+}
+
+// Append [first, last) to a std::vector, allocating at most once.
+//
+// Sized ranges reserve their exact length; input ranges reserve `size_hint`. A contiguous
+// range of trivially copyable T is passed down as raw pointers, which the library copies
+// with a single memmove, and may alias the vector itself.
+template <typename T, class Iterable>
+void vector_append(std::vector<T>* const self, Iterable first, Iterable last, std::size_t size_hint = 0)
+{
+    using value_type = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    using iterator_category = typename std::iterator_traits<Iterable>::iterator_category;
+
+    if constexpr (is_contiguous_iterator_v<Iterable> && std::is_same_v<value_type, T> &&
+                  std::is_trivially_copyable_v<T>)
+    {
+        const auto n = static_cast<std::size_t>(last - first);
+        if (n == 0)
+            return;
+        const T* source = std::addressof(*first);
+        const T* data = self->data();
+        const bool aliased =
+            std::less_equal<const T*>()(data, source) && std::less<const T*>()(source, data + self->size());
+        const auto offset = aliased ? static_cast<std::size_t>(source - data) : 0;
+        reserve_at_least(self, self->size() + n);
+        if (aliased)
+            source = self->data() + offset;
+        self->insert(self->end(), source, source + n);
+    }
+    else if constexpr (std::is_base_of_v<std::forward_iterator_tag, iterator_category>)
+    {
+        reserve_at_least(self, self->size() + static_cast<std::size_t>(std::distance(first, last)));
+        self->insert(self->end(), first, last);
+    }
+    else
+    {
+        reserve_at_least(self, self->size() + size_hint);
+        for (; first != last; ++first)
+            self->push_back(*first);
+    }
+}
+
+// Whether searching [first, last) for an Element can use the simd_find/simd_count kernels.
+template <typename Iterable, typename Element>
+inline constexpr bool is_simd_searchable_v = [] {
+    using value_type = std::remove_cv_t<typename std::iterator_traits<Iterable>::value_type>;
+    return is_contiguous_iterator_v<Iterable> && std::is_same_v<value_type, std::decay_t<Element>> &&
+           (std::is_same_v<value_type, int> || std::is_same_v<value_type, float> ||
+            std::is_same_v<value_type, double>);
+}();
+} // namespace internal
+} // namespace cppy
 
 template <typename Iterable, typename Element>
 CPPY_ERROR_t CPPY_Container_iscontain(Iterable first, Iterable last, const Element& element, bool* const result)
 {
-    *result = std::find(first, last, element) != last;
+    if constexpr (cppy::internal::is_simd_searchable_v<Iterable, Element>)
+    {
+        const auto n = static_cast<std::size_t>(last - first);
+        *result = n > 0 && cppy::internal::simd_find(&*first, n, element) != n;
+    }
+    else
+    {
+        *result = std::find(first, last, element) != last;
+    }
     return CPPY_ERROR_t::Ok;
 }
 
@@ -88,6 +196,17 @@ CPPY_ERROR_t CPPY_Sequence_index(
 
     auto begin = first;
     std::advance(begin, start);
+    if constexpr (cppy::internal::is_simd_searchable_v<Iterable, Element>)
+    {
+        const auto n = static_cast<std::size_t>(end - start);
+        const std::size_t i = cppy::internal::simd_find(&*begin, n, element);
+        if (i != n)
+        {
+            *index = start + static_cast<int>(i);
+            return CPPY_ERROR_t::Ok;
+        }
+        return CPPY_ERROR_t::ValueError;
+    }
     auto end_it = first;
     std::advance(end_it, end);
     auto it = std::find(begin, end_it, element);
@@ -102,7 +221,15 @@ CPPY_ERROR_t CPPY_Sequence_index(
 template <typename Iterable, typename Element>
 CPPY_ERROR_t CPPY_Sequence_count(Iterable first, Iterable last, const Element& element, int* const count)
 {
-    *count = static_cast<int>(std::count(first, last, element));
+    if constexpr (cppy::internal::is_simd_searchable_v<Iterable, Element>)
+    {
+        const auto n = static_cast<std::size_t>(last - first);
+        *count = n > 0 ? static_cast<int>(cppy::internal::simd_count(&*first, n, element)) : 0;
+    }
+    else
+    {
+        *count = static_cast<int>(std::count(first, last, element));
+    }
     return CPPY_ERROR_t::Ok;
 }
 
@@ -111,18 +238,18 @@ CPPY_ERROR_t CPPY_Sequence_count(Iterable first, Iterable last, const Element& e
 /* Insert object before index.
  */
 template <typename Iterable, typename Element>
-CPPY_ERROR_t CPPY_MutableSequence_insert(Iterable inserter, const Element& element)
+CPPY_ERROR_t CPPY_MutableSequence_insert(Iterable inserter, Element&& element)
 {
-    *inserter = element;
+    *inserter = std::forward<Element>(element);
     return CPPY_ERROR_t::Ok;
 }
 
 /* Append object to the end of the list
  */
 template <typename Iterable, typename Element>
-CPPY_ERROR_t CPPY_MutableSequence_append(Iterable back_inserter, const Element& element)
+CPPY_ERROR_t CPPY_MutableSequence_append(Iterable back_inserter, Element&& element)
 {
-    *back_inserter = element;
+    *back_inserter = std::forward<Element>(element);
     return CPPY_ERROR_t::Ok;
 }
 
@@ -159,9 +286,9 @@ CPPY_ERROR_t CPPY_MutableSequence_pop(MutableSequence* self, Element* const elem
         return CPPY_ERROR_t::IndexError;
 
     index = index >= 0 ? index : index + len;
-    CPPY_Sequence_at(*self, index, element);
     auto it = self->begin();
     std::advance(it, index);
+    *element = std::move(*it);
     self->erase(it);
     return CPPY_ERROR_t::Ok;
 }
@@ -1,17 +1,26 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 #include "cppy/exception.h"
 #include "cppy/internal/declare.h"
+#include "cppy/internal/sort.h"
+#include "cppy/thread.h"
 #include "cppy/typing.hpp"
 
 /* Built-in vector.
+ *
+ *  size_hint is the expected length of an input range that cannot be measured up front.
  */
 template <typename T, class Iterable>
-CPPY_ERROR_t CPPY_VECTOR_init(std::vector<T>* const self, Iterable first, Iterable last)
+CPPY_ERROR_t CPPY_VECTOR_init(std::vector<T>* const self, Iterable first, Iterable last, std::size_t size_hint = 0)
 {
-    self->assign(first, last);
+    self->clear();
+    cppy::internal::vector_append(self, first, last, size_hint);
     return CPPY_ERROR_t::Ok;
 }
 
@@ -29,6 +38,21 @@ CPPY_ERROR_t CPPY_VECTOR_append(std::vector<T>* const self, const T& element)
     self->push_back(element);
     return CPPY_ERROR_t::Ok;
 }
+template <typename T>
+CPPY_ERROR_t CPPY_VECTOR_append(std::vector<T>* const self, T&& element)
+{
+    self->push_back(std::move(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Construct an object in place at the end of the list.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_VECTOR_emplace_back(std::vector<T>* const self, Args&&... args)
+{
+    self->emplace_back(std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
 
 /* Remove all items from list.
  */
@@ -44,7 +68,7 @@ CPPY_ERROR_t CPPY_VECTOR_clear(std::vector<T>* const self)
 template <typename T>
 CPPY_ERROR_t CPPY_VECTOR_copy(const std::vector<T>& self, std::vector<T>* const result)
 {
-    result->insert(result->end(), self.begin(), self.end());
+    cppy::internal::vector_append(result, self.begin(), self.end());
     return CPPY_ERROR_t::Ok;
 }
 
@@ -57,11 +81,47 @@ CPPY_ERROR_t CPPY_VECTOR_count(const std::vector<T>& self, const T& element, int
 }
 
 /* Extend list by appending elements from the iterable.
+ *
+ *  size_hint is the expected length of an input range that cannot be measured up front.
  */
 template <typename T, class Iterable>
-CPPY_ERROR_t CPPY_VECTOR_extend(std::vector<T>* const self, Iterable first, Iterable last)
+CPPY_ERROR_t CPPY_VECTOR_extend(std::vector<T>* const self, Iterable first, Iterable last, std::size_t size_hint = 0)
+{
+    cppy::internal::vector_append(self, first, last, size_hint);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Extend list by appending the elements of several sized ranges in order.
+ *
+ *  Capacity for all of them is reserved once up front.
+ */
+template <typename T, class... Ranges>
+CPPY_ERROR_t CPPY_VECTOR_extend_many(std::vector<T>* const self, const Ranges&... ranges)
+{
+    cppy::internal::reserve_at_least(self, self->size() + (std::size_t(0) + ... + std::size(ranges)));
+    (cppy::internal::vector_append(self, std::begin(ranges), std::end(ranges)), ...);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Make room for n more items so that the next appends do not reallocate.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_VECTOR_reserve(std::vector<T>* const self, std::size_t n)
 {
-    self->insert(self->end(), first, last);
+    cppy::internal::reserve_at_least(self, self->size() + n);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Extend list by moving the elements out of another list.
+ */
+template <typename T>
+CPPY_ERROR_t CPPY_VECTOR_extend(std::vector<T>* const self, std::vector<T>&& other)
+{
+    if (self->empty())
+        self->swap(other);
+    else
+        self->insert(self->end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+    other.clear();
     return CPPY_ERROR_t::Ok;
 }
 
@@ -76,26 +136,27 @@ CPPY_VECTOR_index(const std::vector<T>& self, const T& element, int* const index
     return CPPY_Sequence_index(self.begin(), self.end(), element, index, start, end);
 }
 
+/* Construct an object in place before index.
+ */
+template <typename T, typename... Args>
+CPPY_ERROR_t CPPY_VECTOR_emplace(std::vector<T>* const self, int index, Args&&... args)
+{
+    index = cppy::internal::insert_position(index, static_cast<int>(self->size()));
+    self->emplace(self->begin() + index, std::forward<Args>(args)...);
+    return CPPY_ERROR_t::Ok;
+}
+
 /* Insert object before index.
  */
 template <typename T>
 CPPY_ERROR_t CPPY_VECTOR_insert(std::vector<T>* const self, int index, const T& element)
 {
-    int len = static_cast<int>(self->size());
-
-    if (index >= len)
-    {
-        self->push_back(element);
-        return CPPY_ERROR_t::Ok;
-    }
-    if (index < 0)
-    {
-        index += len;
-        if (index < 0)
-            index = 0;
-    }
-    self->insert(self->begin() + index, element);
-    return CPPY_ERROR_t::Ok;
+    return CPPY_VECTOR_emplace(self, index, element);
+}
+template <typename T>
+CPPY_ERROR_t CPPY_VECTOR_insert(std::vector<T>* const self, int index, T&& element)
+{
+    return CPPY_VECTOR_emplace(self, index, std::move(element));
 }
 
 /* Remove and return item at index (default last).
@@ -127,11 +188,44 @@ CPPY_ERROR_t CPPY_VECTOR_reverse(std::vector<T>* self)
 }
 
 /* Sort the list in ascending order and return None.
+ *
+ *  The sort is in-place (i.e. the list itself is modified) and stable (i.e. the
+ *  order of two equal elements is maintained).
+ *
+ *  If a key function is given, apply it once to each list item and sort them,
+ *  ascending or descending, according to their function values.
+ *
+ *  The reverse flag can be set to sort in descending order.
  */
 template <typename T>
-CPPY_ERROR_t CPPY_VECTOR_sort(std::vector<T>* self)
+CPPY_ERROR_t CPPY_VECTOR_sort(std::vector<T>* self, bool reverse = false)
+{
+    if (reverse)
+        cppy::internal::sort_stable(self->begin(), self->end(), std::greater<T>());
+    else
+        cppy::internal::sort_stable(self->begin(), self->end(), std::less<T>());
+    return CPPY_ERROR_t::Ok;
+}
+template <typename T, typename Callable>
+CPPY_ERROR_t CPPY_VECTOR_sort(std::vector<T>* self, Callable key, bool reverse = false)
+{
+    cppy::internal::sort_by_key(self->begin(), self->end(), key, reverse);
+    return CPPY_ERROR_t::Ok;
+}
+
+/* Sort the list on the executor's workers.
+ *
+ *  Chunks are sorted concurrently and then merged in parallel rounds; small
+ *  lists are sorted on the calling thread.
+ */
+template <typename T>
+CPPY_ERROR_t
+CPPY_VECTOR_sort(CPPY_CONCURRENT_ThreadPoolExecutor* const executor, std::vector<T>* self, bool reverse = false)
 {
-    std::sort(self->begin(), self->end());
+    if (reverse)
+        cppy::internal::parallel_sort(executor, self->begin(), self->end(), std::greater<T>());
+    else
+        cppy::internal::parallel_sort(executor, self->begin(), self->end(), std::less<T>());
     return CPPY_ERROR_t::Ok;
 }
 
@@ -147,9 +241,8 @@ CPPY_ERROR_t CPPY_VECTOR_mul(const std::vector<T>& self, int n, std::vector<T>*
 {
     if (n <= 0)
         return CPPY_ERROR_t::Ok;
-    if (n == 1)
-        return CPPY_VECTOR_extend(result, self.begin(), self.end());
 
+    cppy::internal::reserve_at_least(result, result->size() + self.size() * static_cast<std::size_t>(n));
     for (int i = 0; i < n; ++i)
         CPPY_VECTOR_extend(result, self.begin(), self.end());
 
@@ -1,23 +1,134 @@
 #include "cppy/builtins.h"
 
+#include <cmath>
+
+#include "cppy/internal/parallel.h"
+#include "cppy/internal/simd.h"
+
+namespace
+{
+// Samples below this many are filled on the calling thread.
+constexpr std::size_t kParallelGrain = 1 << 16;
+
+// Parameters of linspace(start, end, num, endpoint) shared by the array and lazy forms.
+struct Spacing
+{
+    double step;
+    bool exact_stop;
+};
+
+Spacing linspace_spacing(double start, double end, int num, bool endpoint) {
+    const int div = endpoint ? num - 1 : num;
+    return {div > 0 ? (end - start) / div : 0.0, endpoint && num > 1};
+}
+
+// Fill result[begin, end) of linspace. Each sample is start + i * step on its own, so chunks
+//  can be filled independently and in any order.
+void fill_linspace(double start, double stop, double step, bool exact_stop, std::size_t num, double result[],
+                   std::size_t begin, std::size_t end) {
+    cppy::internal::simd_arange(result + begin, end - begin, start, step, begin);
+    if (exact_stop && end == num)
+        result[num - 1] = stop;
+}
+
+void fill_logspace(double start, double stop, double step, bool exact_stop, std::size_t num, double base,
+                   double result[], std::size_t begin, std::size_t end) {
+    fill_linspace(start, stop, step, exact_stop, num, result, begin, end);
+    for (std::size_t i = begin; i < end; ++i)
+        result[i] = std::pow(base, result[i]);
+}
+
+// Run fill(begin, end) over [0, num) in chunks on the executor.
+template <class Fill>
+void parallel_fill(CPPY_CONCURRENT_ThreadPoolExecutor* const executor, std::size_t num, Fill fill) {
+    const std::size_t chunks = cppy::internal::parallel_chunks(executor, num, kParallelGrain);
+    cppy::internal::parallel_invoke(
+        executor, chunks, [&](std::size_t i) { fill(num * i / chunks, num * (i + 1) / chunks); });
+}
+} // namespace
 
 CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(double start, double end, int num, double result[], bool endpoint) {
-    if (num < 1)
-        return CPPY_ERROR_t::Ok;
-
-    result[0] = start;
-    if (num == 1)
-        return CPPY_ERROR_t::Ok;
-
-    if (num == 2 && endpoint)
-    {
-        result[1] = end;
-        return CPPY_ERROR_t::Ok;
-    }
-
-    double step = endpoint ? (end - start) / (num - 1) : (end - start) / num;
-    for (int i = 1; i < num - 1; ++i)
-        result[i] = result[i-1] + step;
-    result[num - 1] = endpoint ? end : result[num - 2] + step;
+    if (num < 0)
+        return CPPY_ERROR_t::ValueError;
+    const Spacing spacing = linspace_spacing(start, end, num, endpoint);
+    fill_linspace(start, end, spacing.step, spacing.exact_stop, num, result, 0, num);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(CPPY_CONCURRENT_ThreadPoolExecutor* const executor, double start,
+                                             double end, int num, double result[], bool endpoint) {
+    if (num < 0)
+        return CPPY_ERROR_t::ValueError;
+    const Spacing spacing = linspace_spacing(start, end, num, endpoint);
+    parallel_fill(executor, num, [&](std::size_t begin, std::size_t stop) {
+        fill_linspace(start, end, spacing.step, spacing.exact_stop, num, result, begin, stop);
+    });
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_linspace(double start, double end, int num, CPPY_Linspace_view* const result,
+                                             bool endpoint) {
+    if (num < 0)
+        return CPPY_ERROR_t::ValueError;
+    const Spacing spacing = linspace_spacing(start, end, num, endpoint);
+    *result = CPPY_Linspace_view{start, spacing.step, end, static_cast<std::size_t>(num), spacing.exact_stop};
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_arange(double start, double stop, double step, CPPY_Linspace_view* const result) {
+    if (step == 0.0)
+        return CPPY_ERROR_t::ValueError;
+    const double len = std::ceil((stop - start) / step);
+    if (std::isnan(len))
+        return CPPY_ERROR_t::ValueError;
+    const std::size_t num = len > 0.0 ? static_cast<std::size_t>(len) : 0;
+    *result = CPPY_Linspace_view{start, step, stop, num, false};
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_arange(double start, double stop, double step, std::vector<double>* const result) {
+    CPPY_Linspace_view view;
+    const CPPY_ERROR_t error = CPPY_BUILTINS_arange(start, stop, step, &view);
+    if (error != CPPY_ERROR_t::Ok)
+        return error;
+    result->resize(view.size());
+    cppy::internal::simd_arange(result->data(), view.size(), start, step);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_logspace(double start, double stop, int num, double result[], bool endpoint,
+                                             double base) {
+    if (num < 0)
+        return CPPY_ERROR_t::ValueError;
+    const Spacing spacing = linspace_spacing(start, stop, num, endpoint);
+    fill_logspace(start, stop, spacing.step, spacing.exact_stop, num, base, result, 0, num);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_logspace(CPPY_CONCURRENT_ThreadPoolExecutor* const executor, double start,
+                                             double stop, int num, double result[], bool endpoint, double base) {
+    if (num < 0)
+        return CPPY_ERROR_t::ValueError;
+    const Spacing spacing = linspace_spacing(start, stop, num, endpoint);
+    parallel_fill(executor, num, [&](std::size_t begin, std::size_t end) {
+        fill_logspace(start, stop, spacing.step, spacing.exact_stop, num, base, result, begin, end);
+    });
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_BUILTINS_geomspace(double start, double stop, int num, double result[], bool endpoint) {
+    if (num < 0 || start == 0.0 || stop == 0.0 || (start < 0.0) != (stop < 0.0))
+        return CPPY_ERROR_t::ValueError;
+    // a sequence of negative numbers is the positive one, negated
+    const double sign = start < 0.0 ? -1.0 : 1.0;
+    CPPY_BUILTINS_logspace(std::log10(sign * start), std::log10(sign * stop), num, result, endpoint, 10.0);
+    // the ends are set exactly rather than recovered from their logarithms
+    if (num > 0)
+        result[0] = sign * start;
+    if (num > 1 && endpoint)
+        result[num - 1] = sign * stop;
+    if (sign < 0.0)
+        for (int i = 0; i < num; ++i)
+            result[i] = -result[i];
     return CPPY_ERROR_t::Ok;
 }
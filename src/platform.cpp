@@ -63,8 +63,58 @@ CPPY_API CPPY_ERROR_t CPPY_PLATFORM_memory(uint64_t* total, uint64_t* available)
     return CPPY_ERROR_t::Ok;
 }
 
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_numa_nodes(std::vector<CPPY_PLATFORM_NumaNode>* const nodes)
+{
+    nodes->clear();
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+        return CPPY_ERROR_t::ValueError;
+    ULONG highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest))
+        highest = 0;
+    for (ULONG node = 0; node <= highest; ++node)
+    {
+        ULONGLONG mask = 0;
+        if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask))
+            mask = highest == 0 ? ~0ull : 0;
+        mask &= process_mask;
+        CPPY_PLATFORM_NumaNode entry{static_cast<int>(node), {}};
+        for (int cpu = 0; cpu < 64; ++cpu)
+        {
+            if ((mask >> cpu) & 1)
+                entry.cpus.push_back(cpu);
+        }
+        if (!entry.cpus.empty())
+            nodes->push_back(std::move(entry));
+    }
+    return nodes->empty() ? CPPY_ERROR_t::ValueError : CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_set_affinity(const std::vector<int>& cpus)
+{
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+    {
+        if (cpu < 0 || cpu >= 64)
+            return CPPY_ERROR_t::ValueError;
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    if (mask == 0 || SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+        return CPPY_ERROR_t::ValueError;
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_current_cpu(int* const cpu)
+{
+    *cpu = static_cast<int>(GetCurrentProcessorNumber());
+    return CPPY_ERROR_t::Ok;
+}
+
 #elif __linux__
 
+#include <pthread.h>
+#include <sched.h>
+
 static void read_file(const char* path, std::string* result)
 {
     FILE* fp = fopen(path, "r");
@@ -165,4 +215,91 @@ CPPY_API CPPY_ERROR_t CPPY_PLATFORM_cpu_percent(double* const percent, int inter
     return CPPY_ERROR_t::Ok;
 }
 
+// "0-3,8,10-11\n" -> {0, 1, 2, 3, 8, 10, 11}, the list format of sysfs
+static std::vector<int> parse_list(const std::string& text)
+{
+    std::vector<int> values;
+    const char* p = text.c_str();
+    while (true)
+    {
+        char* end = nullptr;
+        const long first = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long value = first; value <= last; ++value)
+            values.push_back(static_cast<int>(value));
+        if (*p != ',')
+            break;
+        ++p;
+    }
+    return values;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_numa_nodes(std::vector<CPPY_PLATFORM_NumaNode>* const nodes)
+{
+    nodes->clear();
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return CPPY_ERROR_t::ValueError;
+
+    std::string online;
+    read_file("/sys/devices/system/node/online", &online);
+    for (int id : parse_list(online))
+    {
+        std::string cpulist;
+        const std::string path = "/sys/devices/system/node/node" + std::to_string(id) + "/cpulist";
+        read_file(path.c_str(), &cpulist);
+        CPPY_PLATFORM_NumaNode node{id, {}};
+        for (int cpu : parse_list(cpulist))
+        {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                node.cpus.push_back(cpu);
+        }
+        if (!node.cpus.empty())
+            nodes->push_back(std::move(node));
+    }
+
+    if (nodes->empty())
+    {
+        // no NUMA information, e.g. a kernel without CONFIG_NUMA
+        CPPY_PLATFORM_NumaNode node{0, {}};
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+                node.cpus.push_back(cpu);
+        }
+        nodes->push_back(std::move(node));
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_set_affinity(const std::vector<int>& cpus)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return CPPY_ERROR_t::ValueError;
+        CPU_SET(cpu, &set);
+    }
+    if (cpus.empty() || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        return CPPY_ERROR_t::ValueError;
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_PLATFORM_current_cpu(int* const cpu)
+{
+    *cpu = sched_getcpu();
+    return *cpu < 0 ? CPPY_ERROR_t::ValueError : CPPY_ERROR_t::Ok;
+}
+
 #endif
@@ -0,0 +1,889 @@
+#include <cstring>
+
+#include "cppy/internal/internal.h"
+#include "cppy/roaring.h"
+
+namespace
+{
+using Container = CPPY_RoaringContainer;
+using Type = CPPY_ROARING_container_t;
+
+constexpr uint32_t kArrayMax = 4096;
+constexpr std::size_t kWords = 1024;
+constexpr char kMagic[4] = {'C', 'P', 'R', 'B'};
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 16;
+constexpr std::size_t kDescriptorSize = 16;
+
+enum class Op
+{
+    And,
+    Or,
+    AndNot,
+    Xor,
+};
+
+void to_words(const Container& c, uint64_t* words)
+{
+    if (c.type == Type::Bitmap)
+    {
+        std::memcpy(words, c.words.data(), kWords * sizeof(uint64_t));
+        return;
+    }
+    std::memset(words, 0, kWords * sizeof(uint64_t));
+    if (c.type == Type::Array)
+    {
+        for (uint16_t v : c.values)
+            words[v >> 6] |= uint64_t(1) << (v & 63);
+        return;
+    }
+    for (std::size_t i = 0; i < c.values.size(); i += 2)
+    {
+        uint32_t start = c.values[i];
+        uint32_t stop = start + c.values[i + 1];
+        for (uint32_t v = start; v <= stop; ++v)
+            words[v >> 6] |= uint64_t(1) << (v & 63);
+    }
+}
+
+void to_array(const Container& c, std::vector<uint16_t>* values)
+{
+    values->clear();
+    values->reserve(c.cardinality);
+    if (c.type == Type::Array)
+    {
+        *values = c.values;
+    }
+    else if (c.type == Type::Bitmap)
+    {
+        for (std::size_t i = 0; i < kWords; ++i)
+        {
+            for (uint64_t w = c.words[i]; w; w &= w - 1)
+                values->push_back(static_cast<uint16_t>(i * 64 + cppy::internal::ctz64(w)));
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < c.values.size(); i += 2)
+        {
+            uint32_t start = c.values[i];
+            uint32_t stop = start + c.values[i + 1];
+            for (uint32_t v = start; v <= stop; ++v)
+                values->push_back(static_cast<uint16_t>(v));
+        }
+    }
+}
+
+// Store `words` into `out` as an array or bitmap container, whichever is smaller.
+void from_words(uint16_t key, const uint64_t* words, Container* out)
+{
+    uint32_t cardinality = 0;
+    for (std::size_t i = 0; i < kWords; ++i)
+        cardinality += cppy::internal::popcount64(words[i]);
+
+    out->key = key;
+    out->cardinality = cardinality;
+    if (cardinality <= kArrayMax)
+    {
+        out->type = Type::Array;
+        out->words.clear();
+        out->words.shrink_to_fit();
+        out->values.clear();
+        out->values.reserve(cardinality);
+        for (std::size_t i = 0; i < kWords; ++i)
+        {
+            for (uint64_t w = words[i]; w; w &= w - 1)
+                out->values.push_back(static_cast<uint16_t>(i * 64 + cppy::internal::ctz64(w)));
+        }
+    }
+    else
+    {
+        out->type = Type::Bitmap;
+        out->values.clear();
+        out->values.shrink_to_fit();
+        out->words.assign(words, words + kWords);
+    }
+}
+
+// Convert a run container back to an array or bitmap container so it can be mutated.
+void normalize(Container* c)
+{
+    if (c->type != Type::Run)
+        return;
+    uint64_t words[kWords];
+    to_words(*c, words);
+    from_words(c->key, words, c);
+}
+
+// `at(i)` returns the i-th uint16_t of the flattened (start, length - 1) run pairs.
+template <typename At>
+bool run_contains(At at, std::size_t nruns, uint16_t low)
+{
+    // find the last run whose start is <= low
+    std::size_t lo = 0, hi = nruns;
+    while (lo < hi)
+    {
+        std::size_t mid = (lo + hi) / 2;
+        if (at(mid * 2) <= low)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return false;
+    return static_cast<uint32_t>(low - at((lo - 1) * 2)) <= at((lo - 1) * 2 + 1);
+}
+
+bool contains(const Container& c, uint16_t low)
+{
+    switch (c.type)
+    {
+    case Type::Array:
+        return std::binary_search(c.values.begin(), c.values.end(), low);
+    case Type::Bitmap:
+        return (c.words[low >> 6] >> (low & 63)) & 1;
+    default:
+        return run_contains([&](std::size_t i) { return c.values[i]; }, c.values.size() / 2, low);
+    }
+}
+
+void container_op(const Container& a, const Container& b, Op op, Container* out)
+{
+    if (a.type == Type::Array && b.type == Type::Array)
+    {
+        std::vector<uint16_t> values;
+        auto inserter = std::back_inserter(values);
+        const auto &va = a.values, &vb = b.values;
+        switch (op)
+        {
+        case Op::And:
+            std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(), inserter);
+            break;
+        case Op::Or:
+            std::set_union(va.begin(), va.end(), vb.begin(), vb.end(), inserter);
+            break;
+        case Op::AndNot:
+            std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(), inserter);
+            break;
+        case Op::Xor:
+            std::set_symmetric_difference(va.begin(), va.end(), vb.begin(), vb.end(), inserter);
+            break;
+        }
+        if (values.size() <= kArrayMax)
+        {
+            out->key = a.key;
+            out->type = Type::Array;
+            out->cardinality = static_cast<uint32_t>(values.size());
+            out->values.swap(values);
+            out->words.clear();
+            return;
+        }
+    }
+
+    uint64_t wa[kWords], wb[kWords];
+    to_words(a, wa);
+    to_words(b, wb);
+    for (std::size_t i = 0; i < kWords; ++i)
+    {
+        switch (op)
+        {
+        case Op::And:
+            wa[i] &= wb[i];
+            break;
+        case Op::Or:
+            wa[i] |= wb[i];
+            break;
+        case Op::AndNot:
+            wa[i] &= ~wb[i];
+            break;
+        case Op::Xor:
+            wa[i] ^= wb[i];
+            break;
+        }
+    }
+    from_words(a.key, wa, out);
+}
+
+void bitmap_op(const CPPY_RoaringBitmap& a, const CPPY_RoaringBitmap& b, Op op, CPPY_RoaringBitmap* result)
+{
+    const bool keep_a = op != Op::And;
+    const bool keep_b = op == Op::Or || op == Op::Xor;
+    std::vector<Container> containers;
+    auto ia = a.containers.begin(), ea = a.containers.end();
+    auto ib = b.containers.begin(), eb = b.containers.end();
+    while (ia != ea || ib != eb)
+    {
+        if (ib == eb || (ia != ea && ia->key < ib->key))
+        {
+            if (keep_a)
+                containers.push_back(*ia);
+            ++ia;
+        }
+        else if (ia == ea || ib->key < ia->key)
+        {
+            if (keep_b)
+                containers.push_back(*ib);
+            ++ib;
+        }
+        else
+        {
+            Container c;
+            container_op(*ia, *ib, op, &c);
+            if (c.cardinality > 0)
+                containers.push_back(std::move(c));
+            ++ia;
+            ++ib;
+        }
+    }
+    result->containers.swap(containers);
+}
+
+// bitmap_op with `self` as both the left operand and the result. Its containers are combined
+//  with other's in place and only moved when keys are added or dropped; other's are copied
+//  in where self has none.
+void bitmap_op_update(CPPY_RoaringBitmap* self, const CPPY_RoaringBitmap& other, Op op)
+{
+    std::vector<Container>& a = self->containers;
+    const std::vector<Container>& b = other.containers;
+    if (self == &other)
+    {
+        if (op == Op::AndNot || op == Op::Xor)
+            a.clear();
+        return;
+    }
+
+    bool emptied = false;
+    if (op == Op::And || op == Op::AndNot)
+    {
+        auto ib = b.begin();
+        for (Container& c : a)
+        {
+            while (ib != b.end() && ib->key < c.key)
+                ++ib;
+            if (ib != b.end() && ib->key == c.key)
+                container_op(c, *ib, op, &c);
+            else if (op == Op::And)
+                c.cardinality = 0;
+            emptied |= c.cardinality == 0;
+        }
+    }
+    else
+    {
+        // make room for other's keys that self lacks, then merge from the back so that
+        //  every container of self moves at most once
+        std::size_t missing = 0;
+        for (std::size_t ia = 0, ib = 0; ib < b.size();)
+        {
+            if (ia == a.size() || b[ib].key < a[ia].key)
+            {
+                ++missing;
+                ++ib;
+            }
+            else
+            {
+                ib += a[ia].key == b[ib].key;
+                ++ia;
+            }
+        }
+        std::size_t ia = a.size(), ib = b.size();
+        a.resize(a.size() + missing);
+        // once other's containers are all in, the rest of self is where it was
+        for (std::size_t out = a.size(); ib > 0;)
+        {
+            --out;
+            if (ia > 0 && a[ia - 1].key > b[ib - 1].key)
+            {
+                if (--ia != out)
+                    a[out] = std::move(a[ia]);
+            }
+            else if (ia == 0 || b[ib - 1].key > a[ia - 1].key)
+            {
+                a[out] = b[--ib];
+            }
+            else
+            {
+                Container& c = a[--ia];
+                container_op(c, b[--ib], op, &c);
+                emptied |= c.cardinality == 0;
+                if (ia != out)
+                    a[out] = std::move(c);
+            }
+        }
+    }
+    if (emptied)
+        a.erase(std::remove_if(a.begin(), a.end(), [](const Container& c) { return c.cardinality == 0; }), a.end());
+}
+
+std::vector<Container>::iterator find_container(CPPY_RoaringBitmap* self, uint16_t key)
+{
+    return std::lower_bound(self->containers.begin(), self->containers.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+std::vector<Container>::const_iterator find_container(const CPPY_RoaringBitmap& self, uint16_t key)
+{
+    return std::lower_bound(self.containers.begin(), self.containers.end(), key,
+                            [](const Container& c, uint16_t k) { return c.key < k; });
+}
+
+template <typename T>
+T load(const char* p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void store(char* p, T value)
+{
+    std::memcpy(p, &value, sizeof(T));
+}
+
+struct Descriptor
+{
+    uint16_t key;
+    uint16_t type;
+    uint32_t cardinality;
+    uint32_t offset;
+    uint32_t bytes;
+};
+
+Descriptor load_descriptor(const char* data, uint32_t i)
+{
+    const char* p = data + kHeaderSize + i * kDescriptorSize;
+    return {load<uint16_t>(p), load<uint16_t>(p + 2), load<uint32_t>(p + 4), load<uint32_t>(p + 8),
+            load<uint32_t>(p + 12)};
+}
+
+CPPY_ERROR_t validate(const char* data, std::size_t size, uint32_t* count)
+{
+    if (size < kHeaderSize || std::memcmp(data, kMagic, 4) != 0 || load<uint32_t>(data + 4) != kVersion)
+        return CPPY_ERROR_t::ValueError;
+    *count = load<uint32_t>(data + 8);
+    if ((size - kHeaderSize) / kDescriptorSize < *count)
+        return CPPY_ERROR_t::ValueError;
+
+    for (uint32_t i = 0; i < *count; ++i)
+    {
+        Descriptor d = load_descriptor(data, i);
+        if (d.offset > size || d.bytes > size - d.offset)
+            return CPPY_ERROR_t::ValueError;
+        if (i > 0 && load_descriptor(data, i - 1).key >= d.key)
+            return CPPY_ERROR_t::ValueError;
+        // containers are never empty: with the payload checks below, this also rules out
+        //  a bitmap of zero words and a run container without runs
+        if (d.cardinality == 0)
+            return CPPY_ERROR_t::ValueError;
+
+        switch (static_cast<Type>(d.type))
+        {
+        case Type::Array:
+            if (d.bytes != d.cardinality * sizeof(uint16_t) || d.cardinality > kArrayMax)
+                return CPPY_ERROR_t::ValueError;
+            // strictly increasing, for the binary searches and merges
+            for (uint32_t v = 1; v < d.cardinality; ++v)
+            {
+                if (load<uint16_t>(data + d.offset + (v - 1) * 2) >= load<uint16_t>(data + d.offset + v * 2))
+                    return CPPY_ERROR_t::ValueError;
+            }
+            break;
+        case Type::Bitmap:
+        {
+            if (d.bytes != kWords * sizeof(uint64_t))
+                return CPPY_ERROR_t::ValueError;
+            uint32_t cardinality = 0;
+            for (std::size_t w = 0; w < kWords; ++w)
+                cardinality += cppy::internal::popcount64(load<uint64_t>(data + d.offset + w * sizeof(uint64_t)));
+            if (cardinality != d.cardinality)
+                return CPPY_ERROR_t::ValueError;
+            break;
+        }
+        case Type::Run:
+        {
+            if (d.bytes % (2 * sizeof(uint16_t)) != 0)
+                return CPPY_ERROR_t::ValueError;
+            // sorted runs that neither overlap nor pass 0xFFFF, and hold `cardinality` values
+            uint32_t cardinality = 0, next = 0;
+            for (uint32_t r = 0; r < d.bytes / (2 * sizeof(uint16_t)); ++r)
+            {
+                const uint32_t start = load<uint16_t>(data + d.offset + r * 4);
+                const uint32_t last = start + load<uint16_t>(data + d.offset + r * 4 + 2);
+                if (start < next || last > 0xFFFF)
+                    return CPPY_ERROR_t::ValueError;
+                cardinality += last - start + 1;
+                next = last + 1;
+            }
+            if (cardinality != d.cardinality)
+                return CPPY_ERROR_t::ValueError;
+            break;
+        }
+        default:
+            return CPPY_ERROR_t::ValueError;
+        }
+    }
+    return CPPY_ERROR_t::Ok;
+}
+} // namespace
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_init_sorted(CPPY_RoaringBitmap* const self, const uint32_t* values, std::size_t n)
+{
+    self->containers.clear();
+    std::size_t i = 0;
+    while (i < n)
+    {
+        const uint16_t key = static_cast<uint16_t>(values[i] >> 16);
+        std::size_t j = i;
+        while (j < n && (values[j] >> 16) == key)
+            ++j;
+
+        Container c;
+        c.key = key;
+        c.cardinality = static_cast<uint32_t>(j - i);
+        if (c.cardinality <= kArrayMax)
+        {
+            c.type = Type::Array;
+            c.values.reserve(c.cardinality);
+            for (std::size_t k = i; k < j; ++k)
+                c.values.push_back(static_cast<uint16_t>(values[k]));
+        }
+        else
+        {
+            c.type = Type::Bitmap;
+            c.words.assign(kWords, 0);
+            for (std::size_t k = i; k < j; ++k)
+                c.words[(values[k] & 0xFFFF) >> 6] |= uint64_t(1) << (values[k] & 63);
+        }
+        self->containers.push_back(std::move(c));
+        i = j;
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_iscontain(const CPPY_RoaringBitmap& self, uint32_t element, bool* const result)
+{
+    const uint16_t key = static_cast<uint16_t>(element >> 16);
+    auto it = find_container(self, key);
+    *result = it != self.containers.end() && it->key == key && contains(*it, static_cast<uint16_t>(element));
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_len(const CPPY_RoaringBitmap& self, std::size_t* const len)
+{
+    *len = 0;
+    for (const Container& c : self.containers)
+        *len += c.cardinality;
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_add(CPPY_RoaringBitmap* const self, uint32_t element)
+{
+    const uint16_t key = static_cast<uint16_t>(element >> 16);
+    const uint16_t low = static_cast<uint16_t>(element);
+    auto it = find_container(self, key);
+    if (it == self->containers.end() || it->key != key)
+    {
+        Container c;
+        c.key = key;
+        c.cardinality = 1;
+        c.values.push_back(low);
+        self->containers.insert(it, std::move(c));
+        return CPPY_ERROR_t::Ok;
+    }
+
+    normalize(&*it);
+    if (it->type == Type::Bitmap)
+    {
+        uint64_t& word = it->words[low >> 6];
+        const uint64_t bit = uint64_t(1) << (low & 63);
+        it->cardinality += (word & bit) == 0;
+        word |= bit;
+        return CPPY_ERROR_t::Ok;
+    }
+
+    auto pos = std::lower_bound(it->values.begin(), it->values.end(), low);
+    if (pos != it->values.end() && *pos == low)
+        return CPPY_ERROR_t::Ok;
+    it->values.insert(pos, low);
+    ++it->cardinality;
+    if (it->cardinality > kArrayMax)
+    {
+        uint64_t words[kWords];
+        to_words(*it, words);
+        from_words(key, words, &*it);
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_clear(CPPY_RoaringBitmap* const self)
+{
+    self->containers.clear();
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_copy(const CPPY_RoaringBitmap& self, CPPY_RoaringBitmap* const result)
+{
+    result->containers = self.containers;
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_difference(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, CPPY_RoaringBitmap* const result)
+{
+    bitmap_op(self, other, Op::AndNot, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_difference_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other)
+{
+    bitmap_op_update(self, other, Op::AndNot);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_intersection(const CPPY_RoaringBitmap& self,
+                                            const CPPY_RoaringBitmap& other,
+                                            CPPY_RoaringBitmap* const result)
+{
+    bitmap_op(self, other, Op::And, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_intersection_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other)
+{
+    bitmap_op_update(self, other, Op::And);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_symmetric_difference(const CPPY_RoaringBitmap& self,
+                                                    const CPPY_RoaringBitmap& other,
+                                                    CPPY_RoaringBitmap* const result)
+{
+    bitmap_op(self, other, Op::Xor, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_symmetric_difference_update(CPPY_RoaringBitmap* const self,
+                                                           const CPPY_RoaringBitmap& other)
+{
+    bitmap_op_update(self, other, Op::Xor);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_union(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, CPPY_RoaringBitmap* const result)
+{
+    bitmap_op(self, other, Op::Or, result);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_update(CPPY_RoaringBitmap* const self, const CPPY_RoaringBitmap& other)
+{
+    bitmap_op_update(self, other, Op::Or);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_pop(CPPY_RoaringBitmap* const self, uint32_t* const element)
+{
+    if (self->containers.empty())
+        return CPPY_ERROR_t::KeyError;
+
+    const Container& c = self->containers.front();
+    uint32_t low;
+    if (c.type == Type::Bitmap)
+    {
+        std::size_t i = 0;
+        while (c.words[i] == 0)
+            ++i;
+        low = static_cast<uint32_t>(i * 64 + cppy::internal::ctz64(c.words[i]));
+    }
+    else
+    {
+        low = c.values.front();
+    }
+    *element = (uint32_t(c.key) << 16) | low;
+    return CPPY_SET_remove(self, *element);
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_remove(CPPY_RoaringBitmap* const self, uint32_t element)
+{
+    const uint16_t key = static_cast<uint16_t>(element >> 16);
+    const uint16_t low = static_cast<uint16_t>(element);
+    auto it = find_container(self, key);
+    if (it == self->containers.end() || it->key != key || !contains(*it, low))
+        return CPPY_ERROR_t::KeyError;
+
+    normalize(&*it);
+    if (it->type == Type::Bitmap)
+    {
+        it->words[low >> 6] &= ~(uint64_t(1) << (low & 63));
+        if (--it->cardinality <= kArrayMax)
+        {
+            std::vector<uint64_t> words;
+            words.swap(it->words);
+            from_words(key, words.data(), &*it);
+        }
+    }
+    else
+    {
+        it->values.erase(std::lower_bound(it->values.begin(), it->values.end(), low));
+        --it->cardinality;
+    }
+    if (it->cardinality == 0)
+        self->containers.erase(it);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_discard(CPPY_RoaringBitmap* const self, uint32_t element)
+{
+    CPPY_SET_remove(self, element);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_isdisjoint(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result)
+{
+    *result = true;
+    for (const Container& c : self.containers)
+    {
+        auto it = find_container(other, c.key);
+        if (it == other.containers.end() || it->key != c.key)
+            continue;
+        Container common;
+        container_op(c, *it, Op::And, &common);
+        if (common.cardinality > 0)
+        {
+            *result = false;
+            break;
+        }
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_issubset(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result)
+{
+    *result = true;
+    for (const Container& c : self.containers)
+    {
+        auto it = find_container(other, c.key);
+        if (it == other.containers.end() || it->key != c.key || it->cardinality < c.cardinality)
+        {
+            *result = false;
+            break;
+        }
+        Container common;
+        container_op(c, *it, Op::And, &common);
+        if (common.cardinality != c.cardinality)
+        {
+            *result = false;
+            break;
+        }
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_issuperset(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result)
+{
+    return CPPY_SET_issubset(other, self, result);
+}
+
+CPPY_API CPPY_ERROR_t
+CPPY_SET_isequal(const CPPY_RoaringBitmap& self, const CPPY_RoaringBitmap& other, bool* const result)
+{
+    std::size_t len_self, len_other;
+    CPPY_SET_len(self, &len_self);
+    CPPY_SET_len(other, &len_other);
+    if (len_self != len_other || self.containers.size() != other.containers.size())
+    {
+        *result = false;
+        return CPPY_ERROR_t::Ok;
+    }
+    return CPPY_SET_issubset(self, other, result);
+}
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_run_optimize(CPPY_RoaringBitmap* const self)
+{
+    std::vector<uint16_t> values;
+    for (Container& c : self->containers)
+    {
+        to_array(c, &values);
+        std::vector<uint16_t> runs;
+        for (std::size_t i = 0; i < values.size();)
+        {
+            std::size_t j = i + 1;
+            while (j < values.size() && values[j] == values[j - 1] + 1)
+                ++j;
+            runs.push_back(values[i]);
+            runs.push_back(static_cast<uint16_t>(j - i - 1));
+            i = j;
+        }
+
+        const std::size_t current_bytes = c.type == Type::Bitmap ? kWords * sizeof(uint64_t)
+                                                                 : c.values.size() * sizeof(uint16_t);
+        if (runs.size() * sizeof(uint16_t) < current_bytes)
+        {
+            c.type = Type::Run;
+            c.values.swap(runs);
+            c.words.clear();
+            c.words.shrink_to_fit();
+        }
+        else if (c.type == Type::Run)
+        {
+            normalize(&c);
+        }
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_tolist(const CPPY_RoaringBitmap& self, std::vector<uint32_t>* const result)
+{
+    result->clear();
+    std::vector<uint16_t> values;
+    for (const Container& c : self.containers)
+    {
+        to_array(c, &values);
+        for (uint16_t v : values)
+            result->push_back((uint32_t(c.key) << 16) | v);
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_serialize(const CPPY_RoaringBitmap& self, std::vector<char>* const result)
+{
+    const uint32_t count = static_cast<uint32_t>(self.containers.size());
+    std::size_t offset = kHeaderSize + count * kDescriptorSize;
+    std::vector<std::size_t> offsets;
+    for (const Container& c : self.containers)
+    {
+        offset = (offset + 7) & ~std::size_t(7);
+        offsets.push_back(offset);
+        offset += c.type == Type::Bitmap ? kWords * sizeof(uint64_t) : c.values.size() * sizeof(uint16_t);
+    }
+
+    result->assign(offset, 0);
+    char* data = result->data();
+    std::memcpy(data, kMagic, 4);
+    store<uint32_t>(data + 4, kVersion);
+    store<uint32_t>(data + 8, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Container& c = self.containers[i];
+        const std::size_t bytes =
+            c.type == Type::Bitmap ? kWords * sizeof(uint64_t) : c.values.size() * sizeof(uint16_t);
+        char* p = data + kHeaderSize + i * kDescriptorSize;
+        store<uint16_t>(p, c.key);
+        store<uint16_t>(p + 2, static_cast<uint16_t>(c.type));
+        store<uint32_t>(p + 4, c.cardinality);
+        store<uint32_t>(p + 8, static_cast<uint32_t>(offsets[i]));
+        store<uint32_t>(p + 12, static_cast<uint32_t>(bytes));
+        if (bytes > 0)
+            std::memcpy(data + offsets[i], c.type == Type::Bitmap ? static_cast<const void*>(c.words.data())
+                                                                  : static_cast<const void*>(c.values.data()),
+                        bytes);
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_deserialize(const char* data, std::size_t size, CPPY_RoaringBitmap* const result)
+{
+    uint32_t count;
+    CPPY_ERROR_t err = validate(data, size, &count);
+    if (err != CPPY_ERROR_t::Ok)
+        return err;
+
+    std::vector<Container> containers(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        Descriptor d = load_descriptor(data, i);
+        Container& c = containers[i];
+        c.key = d.key;
+        c.type = static_cast<Type>(d.type);
+        c.cardinality = d.cardinality;
+        if (c.type == Type::Bitmap)
+        {
+            c.words.resize(kWords);
+            std::memcpy(c.words.data(), data + d.offset, d.bytes);
+        }
+        else
+        {
+            c.values.resize(d.bytes / sizeof(uint16_t));
+            std::memcpy(c.values.data(), data + d.offset, d.bytes);
+        }
+    }
+    result->containers.swap(containers);
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_ROARING_view_init(CPPY_RoaringBitmap_view* const self, const char* data, std::size_t size)
+{
+    uint32_t count;
+    CPPY_ERROR_t err = validate(data, size, &count);
+    if (err != CPPY_ERROR_t::Ok)
+        return err;
+
+    self->data = data;
+    self->size = size;
+    self->count = count;
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_iscontain(const CPPY_RoaringBitmap_view& self, uint32_t element, bool* const result)
+{
+    *result = false;
+    const uint16_t key = static_cast<uint16_t>(element >> 16);
+    const uint16_t low = static_cast<uint16_t>(element);
+
+    uint32_t lo = 0, hi = self.count;
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (load<uint16_t>(self.data + kHeaderSize + mid * kDescriptorSize) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == self.count)
+        return CPPY_ERROR_t::Ok;
+
+    Descriptor d = load_descriptor(self.data, lo);
+    if (d.key != key)
+        return CPPY_ERROR_t::Ok;
+
+    const char* payload = self.data + d.offset;
+    switch (static_cast<Type>(d.type))
+    {
+    case Type::Array:
+    {
+        uint32_t first = 0, last = d.cardinality;
+        while (first < last)
+        {
+            uint32_t mid = (first + last) / 2;
+            if (load<uint16_t>(payload + mid * sizeof(uint16_t)) < low)
+                first = mid + 1;
+            else
+                last = mid;
+        }
+        *result = first < d.cardinality && load<uint16_t>(payload + first * sizeof(uint16_t)) == low;
+        break;
+    }
+    case Type::Bitmap:
+        *result = (load<uint64_t>(payload + (low >> 6) * sizeof(uint64_t)) >> (low & 63)) & 1;
+        break;
+    default:
+    {
+        auto at = [&](std::size_t i) { return load<uint16_t>(payload + i * sizeof(uint16_t)); };
+        *result = run_contains(at, d.bytes / (2 * sizeof(uint16_t)), low);
+        break;
+    }
+    }
+    return CPPY_ERROR_t::Ok;
+}
+
+CPPY_API CPPY_ERROR_t CPPY_SET_len(const CPPY_RoaringBitmap_view& self, std::size_t* const len)
+{
+    *len = 0;
+    for (uint32_t i = 0; i < self.count; ++i)
+        *len += load_descriptor(self.data, i).cardinality;
+    return CPPY_ERROR_t::Ok;
+}
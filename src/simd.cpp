@@ -0,0 +1,1036 @@
+#include "cppy/internal/simd.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "cppy/internal/internal.h"
+
+// SSE2 is part of the x86-64 baseline, AVX2 is detected at runtime.
+#if defined(__x86_64__) || defined(_M_X64)
+#    define CPPY_SIMD_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#    endif
+#endif
+
+#if defined(CPPY_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#    define CPPY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#    define CPPY_TARGET_AVX2
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#    define CPPY_SIMD_INLINE __attribute__((always_inline)) inline
+#elif defined(_MSC_VER)
+#    define CPPY_SIMD_INLINE __forceinline
+#else
+#    define CPPY_SIMD_INLINE inline
+#endif
+
+namespace
+{
+template <typename T>
+std::size_t find_scalar(const T* data, std::size_t n, T value)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        if (data[i] == value)
+            return i;
+    return n;
+}
+
+template <typename T>
+std::size_t find_not_scalar(const T* data, std::size_t n, T value)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        if (!(data[i] == value))
+            return i;
+    return n;
+}
+
+template <typename T>
+std::size_t count_scalar(const T* data, std::size_t n, T value)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        count += data[i] == value;
+    return count;
+}
+
+using cppy::internal::SimdReduceBlock;
+
+// Add x to the running total sum + compensation (Neumaier's variant of Kahan summation).
+inline void neumaier_add(double* sum, double* compensation, double x)
+{
+    const double t = *sum + x;
+    if (std::fabs(*sum) >= std::fabs(x))
+        *compensation += (*sum - t) + x;
+    else
+        *compensation += (x - t) + *sum;
+    *sum = t;
+}
+
+// out[i] = start + (offset + i) * step: simd_arange without simd, and its tails.
+void arange_scalar(double* out, std::size_t n, double start, double step, std::size_t offset)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = start + static_cast<double>(offset + i) * step;
+}
+
+// Branchless stream compaction: every element is stored, but the output position only
+//  advances past the ones that are kept.
+template <typename T>
+std::size_t compact_scalar(const T* data, const unsigned char* keep, std::size_t n, T* out)
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        out[count] = data[i];
+        count += keep[i] != 0;
+    }
+    return count;
+}
+
+// Fold data[begin, n) into a result that already holds data[0, begin).
+template <bool MinMax, bool Sum, bool Kahan, typename T>
+void reduce_scalar_from(const T* data, std::size_t begin, std::size_t n, SimdReduceBlock<T>* result)
+{
+    for (std::size_t i = begin; i < n; ++i)
+    {
+        const T x = data[i];
+        if constexpr (MinMax)
+        {
+            if (x < result->min)
+            {
+                result->min = x;
+                result->argmin = i;
+            }
+            if (result->max < x)
+            {
+                result->max = x;
+                result->argmax = i;
+            }
+            if constexpr (std::is_floating_point_v<T>)
+                result->unordered |= x != x;
+        }
+        if constexpr (Sum)
+        {
+            if constexpr (Kahan && std::is_floating_point_v<T>)
+                neumaier_add(&result->sum, &result->compensation, static_cast<double>(x));
+            else
+                result->sum += x;
+        }
+    }
+}
+
+template <bool MinMax, bool Sum, bool Kahan, typename T>
+void reduce_scalar(const T* data, std::size_t n, SimdReduceBlock<T>* result)
+{
+    result->min = result->max = data[0];
+    result->argmin = result->argmax = 0;
+    result->sum = 0;
+    result->compensation = 0.0;
+    result->unordered = false;
+    reduce_scalar_from<MinMax, Sum, Kahan>(data, 0, n, result);
+}
+
+#if defined(CPPY_SIMD_X86)
+// Each kernel compares one register of elements against `value` and packs the result into a
+// bitmask with one bit per element (movemask), then either locates the lowest set bit (find)
+// or adds the popcount (count). The scalar loop handles the remaining tail.
+
+struct Sse2Int
+{
+    using vector = __m128i;
+    static constexpr std::size_t width = 4;
+    static vector splat(int v) { return _mm_set1_epi32(v); }
+    static unsigned mask(const int* p, vector v)
+    {
+        __m128i cmp = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), v);
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(cmp)));
+    }
+};
+
+struct Sse2Float
+{
+    using vector = __m128;
+    static constexpr std::size_t width = 4;
+    static vector splat(float v) { return _mm_set1_ps(v); }
+    static unsigned mask(const float* p, vector v)
+    {
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), v)));
+    }
+};
+
+struct Sse2Double
+{
+    using vector = __m128d;
+    static constexpr std::size_t width = 2;
+    static vector splat(double v) { return _mm_set1_pd(v); }
+    static unsigned mask(const double* p, vector v)
+    {
+        return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p), v)));
+    }
+};
+
+template <class Kernel, typename T>
+std::size_t find_sse2(const T* data, std::size_t n, T value)
+{
+    const auto v = Kernel::splat(value);
+    std::size_t i = 0;
+    for (; i + Kernel::width <= n; i += Kernel::width)
+    {
+        unsigned m = Kernel::mask(data + i, v);
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_scalar(data + i, n - i, value);
+}
+
+template <class Kernel, typename T>
+std::size_t find_not_sse2(const T* data, std::size_t n, T value)
+{
+    constexpr unsigned all = (1u << Kernel::width) - 1;
+    const auto v = Kernel::splat(value);
+    std::size_t i = 0;
+    for (; i + Kernel::width <= n; i += Kernel::width)
+    {
+        unsigned m = Kernel::mask(data + i, v) ^ all;
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_not_scalar(data + i, n - i, value);
+}
+
+template <class Kernel, typename T>
+std::size_t count_sse2(const T* data, std::size_t n, T value)
+{
+    const auto v = Kernel::splat(value);
+    std::size_t i = 0, count = 0;
+    for (; i + Kernel::width <= n; i += Kernel::width)
+        count += cppy::internal::popcount64(Kernel::mask(data + i, v));
+    return count + count_scalar(data + i, n - i, value);
+}
+
+// AVX2 kernels are written out per type: target("avx2") functions cannot be
+//  inlined into the generic templates above on GCC.
+CPPY_TARGET_AVX2 std::size_t find_avx2(const int* data, std::size_t n, int value)
+{
+    const __m256i v = _mm256_set1_epi32(value);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), v);
+        unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)));
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t find_avx2(const float* data, std::size_t n, float value)
+{
+    const __m256 v = _mm256_set1_ps(value);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), v, _CMP_EQ_OQ)));
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t find_avx2(const double* data, std::size_t n, double value)
+{
+    const __m256d v = _mm256_set1_pd(value);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        unsigned m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), v, _CMP_EQ_OQ)));
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t find_not_avx2(const int* data, std::size_t n, int value)
+{
+    const __m256i v = _mm256_set1_epi32(value);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), v);
+        unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp))) ^ 0xFFu;
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_not_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t find_not_avx2(const float* data, std::size_t n, float value)
+{
+    const __m256 v = _mm256_set1_ps(value);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        unsigned m = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), v, _CMP_NEQ_UQ)));
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_not_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t find_not_avx2(const double* data, std::size_t n, double value)
+{
+    const __m256d v = _mm256_set1_pd(value);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        unsigned m = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), v, _CMP_NEQ_UQ)));
+        if (m)
+            return i + cppy::internal::ctz64(m);
+    }
+    return i + find_not_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t count_avx2(const int* data, std::size_t n, int value)
+{
+    const __m256i v = _mm256_set1_epi32(value);
+    std::size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)), v);
+        count += cppy::internal::popcount64(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp))));
+    }
+    return count + count_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t count_avx2(const float* data, std::size_t n, float value)
+{
+    const __m256 v = _mm256_set1_ps(value);
+    std::size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8)
+        count += cppy::internal::popcount64(
+            static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(data + i), v, _CMP_EQ_OQ))));
+    return count + count_scalar(data + i, n - i, value);
+}
+
+CPPY_TARGET_AVX2 std::size_t count_avx2(const double* data, std::size_t n, double value)
+{
+    const __m256d v = _mm256_set1_pd(value);
+    std::size_t i = 0, count = 0;
+    for (; i + 4 <= n; i += 4)
+        count += cppy::internal::popcount64(
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(data + i), v, _CMP_EQ_OQ))));
+    return count + count_scalar(data + i, n - i, value);
+}
+
+// Reduction kernels. Every trait below supplies the same set of lane operations, so one
+//  loop (reduce_lanes) serves all of them: min/max are kept with compare + blend, the
+//  index of each lane's winner is blended alongside, and sums are widened (int -> int64,
+//  float -> double) before they are added. Strict comparisons keep the first occurrence
+//  within a lane; the lanes are then combined preferring the lower index on ties.
+//
+//  The AVX2 traits pass __m256 values between inlined helpers that GCC compiles before it
+//  knows they end up inside a target("avx2") function, which makes it warn about the ABI.
+//  Nothing here is called across an ABI boundary, so the warning is silenced.
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wpsabi"
+#    endif
+
+struct Sse2ReduceInt
+{
+    using value_type = int;
+    using vector = __m128i;
+    using index = __m128i;
+    using index_type = std::int32_t;
+    using accumulator = __m128i;
+    using sum_type = long long;
+    static constexpr std::size_t width = 4;
+    static constexpr std::size_t parts = 2;
+    static constexpr std::size_t acc_width = 2;
+    static constexpr bool has_nan = false;
+
+    static vector load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static vector less(vector a, vector b) { return _mm_cmplt_epi32(a, b); }
+    static vector select(vector m, vector a, vector b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static index select_index(vector m, index a, index b) { return select(m, a, b); }
+    static index index_start(index_type offset) { return _mm_setr_epi32(offset, offset + 1, offset + 2, offset + 3); }
+    static index index_splat(index_type step) { return _mm_set1_epi32(step); }
+    static index index_add(index a, index b) { return _mm_add_epi32(a, b); }
+    static void store(int* p, vector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static void store_index(index_type* p, index v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static void widen(vector x, accumulator* out)
+    {
+        const __m128i sign = _mm_srai_epi32(x, 31);
+        out[0] = _mm_unpacklo_epi32(x, sign);
+        out[1] = _mm_unpackhi_epi32(x, sign);
+    }
+    static accumulator acc_zero() { return _mm_setzero_si128(); }
+    static accumulator acc_add(accumulator a, accumulator b) { return _mm_add_epi64(a, b); }
+    static accumulator acc_sub(accumulator a, accumulator b) { return _mm_sub_epi64(a, b); }
+    static void acc_store(sum_type* p, accumulator v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+};
+
+struct Sse2ReduceFloat
+{
+    using value_type = float;
+    using vector = __m128;
+    using index = __m128i;
+    using index_type = std::int32_t;
+    using accumulator = __m128d;
+    using sum_type = double;
+    static constexpr std::size_t width = 4;
+    static constexpr std::size_t parts = 2;
+    static constexpr std::size_t acc_width = 2;
+    static constexpr bool has_nan = true;
+
+    static vector load(const float* p) { return _mm_loadu_ps(p); }
+    static vector zero() { return _mm_setzero_ps(); }
+    static vector less(vector a, vector b) { return _mm_cmplt_ps(a, b); }
+    static vector unordered(vector x) { return _mm_cmpunord_ps(x, x); }
+    static vector mask_or(vector a, vector b) { return _mm_or_ps(a, b); }
+    static bool any(vector m) { return _mm_movemask_ps(m) != 0; }
+    static vector select(vector m, vector a, vector b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static index select_index(vector m, index a, index b)
+    {
+        const __m128i mi = _mm_castps_si128(m);
+        return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+    }
+    static index index_start(index_type offset) { return _mm_setr_epi32(offset, offset + 1, offset + 2, offset + 3); }
+    static index index_splat(index_type step) { return _mm_set1_epi32(step); }
+    static index index_add(index a, index b) { return _mm_add_epi32(a, b); }
+    static void store(float* p, vector v) { _mm_storeu_ps(p, v); }
+    static void store_index(index_type* p, index v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static void widen(vector x, accumulator* out)
+    {
+        out[0] = _mm_cvtps_pd(x);
+        out[1] = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+    }
+    static accumulator acc_zero() { return _mm_setzero_pd(); }
+    static accumulator acc_add(accumulator a, accumulator b) { return _mm_add_pd(a, b); }
+    static accumulator acc_sub(accumulator a, accumulator b) { return _mm_sub_pd(a, b); }
+    static void acc_store(sum_type* p, accumulator v) { _mm_storeu_pd(p, v); }
+};
+
+struct Sse2ReduceDouble
+{
+    using value_type = double;
+    using vector = __m128d;
+    using index = __m128i;
+    using index_type = std::int64_t;
+    using accumulator = __m128d;
+    using sum_type = double;
+    static constexpr std::size_t width = 2;
+    static constexpr std::size_t parts = 1;
+    static constexpr std::size_t acc_width = 2;
+    static constexpr bool has_nan = true;
+
+    static vector load(const double* p) { return _mm_loadu_pd(p); }
+    static vector zero() { return _mm_setzero_pd(); }
+    static vector less(vector a, vector b) { return _mm_cmplt_pd(a, b); }
+    static vector unordered(vector x) { return _mm_cmpunord_pd(x, x); }
+    static vector mask_or(vector a, vector b) { return _mm_or_pd(a, b); }
+    static bool any(vector m) { return _mm_movemask_pd(m) != 0; }
+    static vector select(vector m, vector a, vector b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    static index select_index(vector m, index a, index b)
+    {
+        const __m128i mi = _mm_castpd_si128(m);
+        return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b));
+    }
+    static index index_start(index_type offset) { return _mm_set_epi64x(offset + 1, offset); }
+    static index index_splat(index_type step) { return _mm_set1_epi64x(step); }
+    static index index_add(index a, index b) { return _mm_add_epi64(a, b); }
+    static void store(double* p, vector v) { _mm_storeu_pd(p, v); }
+    static void store_index(index_type* p, index v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static void widen(vector x, accumulator* out) { out[0] = x; }
+    static accumulator acc_zero() { return _mm_setzero_pd(); }
+    static accumulator acc_add(accumulator a, accumulator b) { return _mm_add_pd(a, b); }
+    static accumulator acc_sub(accumulator a, accumulator b) { return _mm_sub_pd(a, b); }
+    static void acc_store(sum_type* p, accumulator v) { _mm_storeu_pd(p, v); }
+};
+
+struct Avx2ReduceInt
+{
+    using value_type = int;
+    using vector = __m256i;
+    using index = __m256i;
+    using index_type = std::int32_t;
+    using accumulator = __m256i;
+    using sum_type = long long;
+    static constexpr std::size_t width = 8;
+    static constexpr std::size_t parts = 2;
+    static constexpr std::size_t acc_width = 4;
+    static constexpr bool has_nan = false;
+
+    CPPY_TARGET_AVX2 static vector load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    CPPY_TARGET_AVX2 static vector less(vector a, vector b) { return _mm256_cmpgt_epi32(b, a); }
+    CPPY_TARGET_AVX2 static vector select(vector m, vector a, vector b) { return _mm256_blendv_epi8(b, a, m); }
+    CPPY_TARGET_AVX2 static index select_index(vector m, index a, index b) { return _mm256_blendv_epi8(b, a, m); }
+    CPPY_TARGET_AVX2 static index index_start(index_type offset)
+    {
+        return _mm256_add_epi32(_mm256_set1_epi32(offset), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    CPPY_TARGET_AVX2 static index index_splat(index_type step) { return _mm256_set1_epi32(step); }
+    CPPY_TARGET_AVX2 static index index_add(index a, index b) { return _mm256_add_epi32(a, b); }
+    CPPY_TARGET_AVX2 static void store(int* p, vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    CPPY_TARGET_AVX2 static void store_index(index_type* p, index v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    CPPY_TARGET_AVX2 static void widen(vector x, accumulator* out)
+    {
+        out[0] = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x));
+        out[1] = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1));
+    }
+    CPPY_TARGET_AVX2 static accumulator acc_zero() { return _mm256_setzero_si256(); }
+    CPPY_TARGET_AVX2 static accumulator acc_add(accumulator a, accumulator b) { return _mm256_add_epi64(a, b); }
+    CPPY_TARGET_AVX2 static accumulator acc_sub(accumulator a, accumulator b) { return _mm256_sub_epi64(a, b); }
+    CPPY_TARGET_AVX2 static void acc_store(sum_type* p, accumulator v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+};
+
+struct Avx2ReduceFloat
+{
+    using value_type = float;
+    using vector = __m256;
+    using index = __m256i;
+    using index_type = std::int32_t;
+    using accumulator = __m256d;
+    using sum_type = double;
+    static constexpr std::size_t width = 8;
+    static constexpr std::size_t parts = 2;
+    static constexpr std::size_t acc_width = 4;
+    static constexpr bool has_nan = true;
+
+    CPPY_TARGET_AVX2 static vector load(const float* p) { return _mm256_loadu_ps(p); }
+    CPPY_TARGET_AVX2 static vector zero() { return _mm256_setzero_ps(); }
+    CPPY_TARGET_AVX2 static vector less(vector a, vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    CPPY_TARGET_AVX2 static vector unordered(vector x) { return _mm256_cmp_ps(x, x, _CMP_UNORD_Q); }
+    CPPY_TARGET_AVX2 static vector mask_or(vector a, vector b) { return _mm256_or_ps(a, b); }
+    CPPY_TARGET_AVX2 static bool any(vector m) { return _mm256_movemask_ps(m) != 0; }
+    CPPY_TARGET_AVX2 static vector select(vector m, vector a, vector b) { return _mm256_blendv_ps(b, a, m); }
+    CPPY_TARGET_AVX2 static index select_index(vector m, index a, index b)
+    {
+        return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m));
+    }
+    CPPY_TARGET_AVX2 static index index_start(index_type offset)
+    {
+        return _mm256_add_epi32(_mm256_set1_epi32(offset), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    CPPY_TARGET_AVX2 static index index_splat(index_type step) { return _mm256_set1_epi32(step); }
+    CPPY_TARGET_AVX2 static index index_add(index a, index b) { return _mm256_add_epi32(a, b); }
+    CPPY_TARGET_AVX2 static void store(float* p, vector v) { _mm256_storeu_ps(p, v); }
+    CPPY_TARGET_AVX2 static void store_index(index_type* p, index v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    CPPY_TARGET_AVX2 static void widen(vector x, accumulator* out)
+    {
+        out[0] = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+        out[1] = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+    }
+    CPPY_TARGET_AVX2 static accumulator acc_zero() { return _mm256_setzero_pd(); }
+    CPPY_TARGET_AVX2 static accumulator acc_add(accumulator a, accumulator b) { return _mm256_add_pd(a, b); }
+    CPPY_TARGET_AVX2 static accumulator acc_sub(accumulator a, accumulator b) { return _mm256_sub_pd(a, b); }
+    CPPY_TARGET_AVX2 static void acc_store(sum_type* p, accumulator v) { _mm256_storeu_pd(p, v); }
+};
+
+struct Avx2ReduceDouble
+{
+    using value_type = double;
+    using vector = __m256d;
+    using index = __m256i;
+    using index_type = std::int64_t;
+    using accumulator = __m256d;
+    using sum_type = double;
+    static constexpr std::size_t width = 4;
+    static constexpr std::size_t parts = 1;
+    static constexpr std::size_t acc_width = 4;
+    static constexpr bool has_nan = true;
+
+    CPPY_TARGET_AVX2 static vector load(const double* p) { return _mm256_loadu_pd(p); }
+    CPPY_TARGET_AVX2 static vector zero() { return _mm256_setzero_pd(); }
+    CPPY_TARGET_AVX2 static vector less(vector a, vector b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    CPPY_TARGET_AVX2 static vector unordered(vector x) { return _mm256_cmp_pd(x, x, _CMP_UNORD_Q); }
+    CPPY_TARGET_AVX2 static vector mask_or(vector a, vector b) { return _mm256_or_pd(a, b); }
+    CPPY_TARGET_AVX2 static bool any(vector m) { return _mm256_movemask_pd(m) != 0; }
+    CPPY_TARGET_AVX2 static vector select(vector m, vector a, vector b) { return _mm256_blendv_pd(b, a, m); }
+    CPPY_TARGET_AVX2 static index select_index(vector m, index a, index b)
+    {
+        return _mm256_blendv_epi8(b, a, _mm256_castpd_si256(m));
+    }
+    CPPY_TARGET_AVX2 static index index_start(index_type offset)
+    {
+        return _mm256_setr_epi64x(offset, offset + 1, offset + 2, offset + 3);
+    }
+    CPPY_TARGET_AVX2 static index index_splat(index_type step) { return _mm256_set1_epi64x(step); }
+    CPPY_TARGET_AVX2 static index index_add(index a, index b) { return _mm256_add_epi64(a, b); }
+    CPPY_TARGET_AVX2 static void store(double* p, vector v) { _mm256_storeu_pd(p, v); }
+    CPPY_TARGET_AVX2 static void store_index(index_type* p, index v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    CPPY_TARGET_AVX2 static void widen(vector x, accumulator* out) { out[0] = x; }
+    CPPY_TARGET_AVX2 static accumulator acc_zero() { return _mm256_setzero_pd(); }
+    CPPY_TARGET_AVX2 static accumulator acc_add(accumulator a, accumulator b) { return _mm256_add_pd(a, b); }
+    CPPY_TARGET_AVX2 static accumulator acc_sub(accumulator a, accumulator b) { return _mm256_sub_pd(a, b); }
+    CPPY_TARGET_AVX2 static void acc_store(sum_type* p, accumulator v) { _mm256_storeu_pd(p, v); }
+};
+
+// Two independent sets of lanes are kept so the compare/blend and add chains of one
+//  register do not wait on the previous register.
+template <class K, bool MinMax, bool Sum, bool Kahan>
+CPPY_SIMD_INLINE void reduce_lanes(const typename K::value_type* data,
+                                   std::size_t n,
+                                   SimdReduceBlock<typename K::value_type>* result)
+{
+    using T = typename K::value_type;
+    using vector = typename K::vector;
+    using index = typename K::index;
+    using accumulator = typename K::accumulator;
+    using index_type = typename K::index_type;
+    using sum_type = typename K::sum_type;
+    constexpr std::size_t w = K::width;
+    constexpr bool compensated = Kahan && K::has_nan;
+    if (n < 2 * w)
+        return reduce_scalar<MinMax, Sum, Kahan>(data, n, result);
+
+    vector vmin[2], vmax[2];
+    index imin[2], imax[2], position[2];
+    accumulator sums[2][K::parts], comps[2][K::parts];
+    const index step = K::index_splat(static_cast<index_type>(2 * w));
+    for (std::size_t u = 0; u < 2; ++u)
+    {
+        vmin[u] = vmax[u] = K::load(data + u * w);
+        position[u] = imin[u] = imax[u] = K::index_start(static_cast<index_type>(u * w));
+        for (std::size_t p = 0; p < K::parts; ++p)
+            sums[u][p] = comps[u][p] = K::acc_zero();
+    }
+    vector unordered{};
+    if constexpr (K::has_nan)
+        unordered = K::zero();
+
+    std::size_t i = 0;
+    for (; i + 2 * w <= n; i += 2 * w)
+    {
+        for (std::size_t u = 0; u < 2; ++u)
+        {
+            const vector x = K::load(data + i + u * w);
+            if constexpr (MinMax)
+            {
+                const vector lt = K::less(x, vmin[u]);
+                vmin[u] = K::select(lt, x, vmin[u]);
+                imin[u] = K::select_index(lt, position[u], imin[u]);
+                const vector gt = K::less(vmax[u], x);
+                vmax[u] = K::select(gt, x, vmax[u]);
+                imax[u] = K::select_index(gt, position[u], imax[u]);
+                position[u] = K::index_add(position[u], step);
+                if constexpr (K::has_nan)
+                    unordered = K::mask_or(unordered, K::unordered(x));
+            }
+            if constexpr (Sum)
+            {
+                accumulator parts[K::parts];
+                K::widen(x, parts);
+                for (std::size_t p = 0; p < K::parts; ++p)
+                {
+                    if constexpr (compensated)
+                    {
+                        const accumulator y = K::acc_sub(parts[p], comps[u][p]);
+                        const accumulator t = K::acc_add(sums[u][p], y);
+                        comps[u][p] = K::acc_sub(K::acc_sub(t, sums[u][p]), y);
+                        sums[u][p] = t;
+                    }
+                    else
+                        sums[u][p] = K::acc_add(sums[u][p], parts[p]);
+                }
+            }
+        }
+    }
+
+    result->sum = 0;
+    result->compensation = 0.0;
+    result->unordered = false;
+    if constexpr (MinMax)
+    {
+        if constexpr (K::has_nan)
+            result->unordered = K::any(unordered);
+        T lane_min[2 * w], lane_max[2 * w];
+        index_type lane_imin[2 * w], lane_imax[2 * w];
+        for (std::size_t u = 0; u < 2; ++u)
+        {
+            K::store(lane_min + u * w, vmin[u]);
+            K::store(lane_max + u * w, vmax[u]);
+            K::store_index(lane_imin + u * w, imin[u]);
+            K::store_index(lane_imax + u * w, imax[u]);
+        }
+        result->min = lane_min[0];
+        result->max = lane_max[0];
+        result->argmin = static_cast<std::size_t>(lane_imin[0]);
+        result->argmax = static_cast<std::size_t>(lane_imax[0]);
+        for (std::size_t j = 1; j < 2 * w; ++j)
+        {
+            const std::size_t at_min = static_cast<std::size_t>(lane_imin[j]);
+            if (lane_min[j] < result->min || (lane_min[j] == result->min && at_min < result->argmin))
+            {
+                result->min = lane_min[j];
+                result->argmin = at_min;
+            }
+            const std::size_t at_max = static_cast<std::size_t>(lane_imax[j]);
+            if (result->max < lane_max[j] || (lane_max[j] == result->max && at_max < result->argmax))
+            {
+                result->max = lane_max[j];
+                result->argmax = at_max;
+            }
+        }
+    }
+    if constexpr (Sum)
+    {
+        sum_type lanes[K::acc_width];
+        for (std::size_t u = 0; u < 2; ++u)
+        {
+            for (std::size_t p = 0; p < K::parts; ++p)
+            {
+                K::acc_store(lanes, sums[u][p]);
+                for (std::size_t j = 0; j < K::acc_width; ++j)
+                {
+                    if constexpr (compensated)
+                        neumaier_add(&result->sum, &result->compensation, lanes[j]);
+                    else
+                        result->sum += lanes[j];
+                }
+                if constexpr (compensated)
+                {
+                    // each lane's compensation holds the negated low-order part it lost
+                    K::acc_store(lanes, comps[u][p]);
+                    for (std::size_t j = 0; j < K::acc_width; ++j)
+                        neumaier_add(&result->sum, &result->compensation, -lanes[j]);
+                }
+            }
+        }
+    }
+    reduce_scalar_from<MinMax, Sum, Kahan>(data, i, n, result);
+}
+
+template <class K, bool MinMax, bool Sum, bool Kahan>
+void reduce_sse2(const typename K::value_type* data, std::size_t n, SimdReduceBlock<typename K::value_type>* result)
+{
+    reduce_lanes<K, MinMax, Sum, Kahan>(data, n, result);
+}
+
+template <class K, bool MinMax, bool Sum, bool Kahan>
+CPPY_TARGET_AVX2 void reduce_avx2(const typename K::value_type* data,
+                                  std::size_t n,
+                                  SimdReduceBlock<typename K::value_type>* result)
+{
+    reduce_lanes<K, MinMax, Sum, Kahan>(data, n, result);
+}
+
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
+
+// The lane indices are kept as doubles and bumped by the register width, which is exact
+//  below 2^53, so no integer conversion is needed in the loop.
+void arange_sse2(double* out, std::size_t n, double start, double step, std::size_t offset)
+{
+    const __m128d vstart = _mm_set1_pd(start);
+    const __m128d vstep = _mm_set1_pd(step);
+    const __m128d width = _mm_set1_pd(2.0);
+    __m128d index = _mm_add_pd(_mm_set1_pd(static_cast<double>(offset)), _mm_setr_pd(0.0, 1.0));
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        _mm_storeu_pd(out + i, _mm_add_pd(vstart, _mm_mul_pd(index, vstep)));
+        index = _mm_add_pd(index, width);
+    }
+    arange_scalar(out + i, n - i, start, step, offset + i);
+}
+
+CPPY_TARGET_AVX2 void arange_avx2(double* out, std::size_t n, double start, double step, std::size_t offset)
+{
+    const __m256d vstart = _mm256_set1_pd(start);
+    const __m256d vstep = _mm256_set1_pd(step);
+    const __m256d width = _mm256_set1_pd(8.0);
+    __m256d index[2];
+    index[0] = _mm256_add_pd(_mm256_set1_pd(static_cast<double>(offset)), _mm256_setr_pd(0.0, 1.0, 2.0, 3.0));
+    index[1] = _mm256_add_pd(index[0], _mm256_set1_pd(4.0));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(vstart, _mm256_mul_pd(index[0], vstep)));
+        _mm256_storeu_pd(out + i + 4, _mm256_add_pd(vstart, _mm256_mul_pd(index[1], vstep)));
+        index[0] = _mm256_add_pd(index[0], width);
+        index[1] = _mm256_add_pd(index[1], width);
+    }
+    arange_scalar(out + i, n - i, start, step, offset + i);
+}
+
+// Stream compaction with AVX2: the keep flags of one register form a bitmask that selects
+//  a precomputed permutation moving the kept lanes to the front; the whole register is
+//  stored and the output advances by the popcount.
+struct CompactTables
+{
+    alignas(32) std::int32_t lanes32[256][8]; // 8 x 32-bit lanes
+    alignas(32) std::int32_t lanes64[16][8];  // 4 x 64-bit lanes, as pairs of 32-bit lanes
+
+    CompactTables() : lanes32(), lanes64()
+    {
+        for (unsigned m = 0; m < 256; ++m)
+        {
+            int k = 0;
+            for (int lane = 0; lane < 8; ++lane)
+                if (m & (1u << lane))
+                    lanes32[m][k++] = lane;
+        }
+        for (unsigned m = 0; m < 16; ++m)
+        {
+            int k = 0;
+            for (int lane = 0; lane < 4; ++lane)
+                if (m & (1u << lane))
+                {
+                    lanes64[m][k++] = 2 * lane;
+                    lanes64[m][k++] = 2 * lane + 1;
+                }
+        }
+    }
+};
+
+const CompactTables kCompactTables;
+
+// Bitmask of the non-zero flags among keep[0, 8).
+CPPY_TARGET_AVX2 unsigned keep_mask8(const unsigned char* keep)
+{
+    const __m128i flags = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(keep));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(flags, _mm_setzero_si128()))) & 0xFFu;
+}
+
+CPPY_TARGET_AVX2 std::size_t compact_avx2(const int* data, const unsigned char* keep, std::size_t n, int* out)
+{
+    std::size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const unsigned m = keep_mask8(keep + i);
+        const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompactTables.lanes32[m]));
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + count), _mm256_permutevar8x32_epi32(v, perm));
+        count += cppy::internal::popcount64(m);
+    }
+    return count + compact_scalar(data + i, keep + i, n - i, out + count);
+}
+
+CPPY_TARGET_AVX2 std::size_t compact_avx2(const float* data, const unsigned char* keep, std::size_t n, float* out)
+{
+    std::size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const unsigned m = keep_mask8(keep + i);
+        const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompactTables.lanes32[m]));
+        _mm256_storeu_ps(out + count, _mm256_permutevar8x32_ps(_mm256_loadu_ps(data + i), perm));
+        count += cppy::internal::popcount64(m);
+    }
+    return count + compact_scalar(data + i, keep + i, n - i, out + count);
+}
+
+CPPY_TARGET_AVX2 std::size_t compact_avx2(const double* data, const unsigned char* keep, std::size_t n, double* out)
+{
+    std::size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        // one flag mask for two registers of four doubles
+        const unsigned m = keep_mask8(keep + i);
+        for (unsigned half = 0; half < 2; ++half)
+        {
+            const unsigned quad = (m >> (4 * half)) & 0xFu;
+            const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(kCompactTables.lanes64[quad]));
+            const __m256i v = _mm256_castpd_si256(_mm256_loadu_pd(data + i + 4 * half));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + count), _mm256_permutevar8x32_epi32(v, perm));
+            count += cppy::internal::popcount64(quad);
+        }
+    }
+    return count + compact_scalar(data + i, keep + i, n - i, out + count);
+}
+
+bool cpu_has_avx2()
+{
+#    if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#    elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#    else
+    return false;
+#    endif
+}
+
+const bool kHasAvx2 = cpu_has_avx2();
+#endif
+// Instantiate the kernel matching the simd_reduce_* flags in `what`.
+template <class Sse2, class Avx2, typename T>
+void reduce_dispatch(const T* data, std::size_t n, unsigned what, SimdReduceBlock<T>* result)
+{
+    switch (what & 7u)
+    {
+#if defined(CPPY_SIMD_X86)
+#    define CPPY_SIMD_REDUCE(MinMax, Sum, Kahan)                          \
+        if (kHasAvx2)                                                    \
+            return reduce_avx2<Avx2, MinMax, Sum, Kahan>(data, n, result); \
+        return reduce_sse2<Sse2, MinMax, Sum, Kahan>(data, n, result);
+#else
+#    define CPPY_SIMD_REDUCE(MinMax, Sum, Kahan) return reduce_scalar<MinMax, Sum, Kahan>(data, n, result);
+#endif
+    case cppy::internal::simd_reduce_minmax:
+    case cppy::internal::simd_reduce_minmax | cppy::internal::simd_reduce_compensated:
+        CPPY_SIMD_REDUCE(true, false, false)
+    case cppy::internal::simd_reduce_sum:
+        CPPY_SIMD_REDUCE(false, true, false)
+    case cppy::internal::simd_reduce_sum | cppy::internal::simd_reduce_compensated:
+        CPPY_SIMD_REDUCE(false, true, true)
+    case cppy::internal::simd_reduce_minmax | cppy::internal::simd_reduce_sum:
+        CPPY_SIMD_REDUCE(true, true, false)
+    case cppy::internal::simd_reduce_minmax | cppy::internal::simd_reduce_sum | cppy::internal::simd_reduce_compensated:
+        CPPY_SIMD_REDUCE(true, true, true)
+    default:
+        result->sum = 0;
+        result->compensation = 0.0;
+        result->unordered = false;
+        return;
+#undef CPPY_SIMD_REDUCE
+    }
+}
+} // namespace
+
+namespace cppy
+{
+namespace internal
+{
+#if defined(CPPY_SIMD_X86)
+#    define CPPY_SIMD_DISPATCH(name, kernel)                   \
+        if (kHasAvx2)                                          \
+            return name##_avx2(data, n, value);                \
+        return name##_sse2<kernel>(data, n, value);
+#else
+#    define CPPY_SIMD_DISPATCH(name, kernel) return name##_scalar(data, n, value);
+#endif
+
+CPPY_API std::size_t simd_find(const int* data, std::size_t n, int value)
+{
+    CPPY_SIMD_DISPATCH(find, Sse2Int)
+}
+
+CPPY_API std::size_t simd_find(const float* data, std::size_t n, float value)
+{
+    CPPY_SIMD_DISPATCH(find, Sse2Float)
+}
+
+CPPY_API std::size_t simd_find(const double* data, std::size_t n, double value)
+{
+    CPPY_SIMD_DISPATCH(find, Sse2Double)
+}
+
+CPPY_API std::size_t simd_find_not(const int* data, std::size_t n, int value)
+{
+    CPPY_SIMD_DISPATCH(find_not, Sse2Int)
+}
+
+CPPY_API std::size_t simd_find_not(const float* data, std::size_t n, float value)
+{
+    CPPY_SIMD_DISPATCH(find_not, Sse2Float)
+}
+
+CPPY_API std::size_t simd_find_not(const double* data, std::size_t n, double value)
+{
+    CPPY_SIMD_DISPATCH(find_not, Sse2Double)
+}
+
+CPPY_API std::size_t simd_count(const int* data, std::size_t n, int value)
+{
+    CPPY_SIMD_DISPATCH(count, Sse2Int)
+}
+
+CPPY_API std::size_t simd_count(const float* data, std::size_t n, float value)
+{
+    CPPY_SIMD_DISPATCH(count, Sse2Float)
+}
+
+CPPY_API std::size_t simd_count(const double* data, std::size_t n, double value)
+{
+    CPPY_SIMD_DISPATCH(count, Sse2Double)
+}
+
+#undef CPPY_SIMD_DISPATCH
+
+CPPY_API void simd_arange(double* out, std::size_t n, double start, double step, std::size_t offset)
+{
+#if defined(CPPY_SIMD_X86)
+    if (kHasAvx2)
+        return arange_avx2(out, n, start, step, offset);
+    return arange_sse2(out, n, start, step, offset);
+#else
+    return arange_scalar(out, n, start, step, offset);
+#endif
+}
+
+// SSE2 has no variable lane shuffle, so without AVX2 the branchless scalar loop is used.
+#if defined(CPPY_SIMD_X86)
+#    define CPPY_SIMD_COMPACT()                      \
+        if (kHasAvx2)                                \
+            return compact_avx2(data, keep, n, out); \
+        return compact_scalar(data, keep, n, out);
+#else
+#    define CPPY_SIMD_COMPACT() return compact_scalar(data, keep, n, out);
+#endif
+
+CPPY_API std::size_t simd_compact(const int* data, const unsigned char* keep, std::size_t n, int* out)
+{
+    CPPY_SIMD_COMPACT()
+}
+
+CPPY_API std::size_t simd_compact(const float* data, const unsigned char* keep, std::size_t n, float* out)
+{
+    CPPY_SIMD_COMPACT()
+}
+
+CPPY_API std::size_t simd_compact(const double* data, const unsigned char* keep, std::size_t n, double* out)
+{
+    CPPY_SIMD_COMPACT()
+}
+
+#undef CPPY_SIMD_COMPACT
+
+#if defined(CPPY_SIMD_X86)
+#    define CPPY_SIMD_REDUCE_KERNELS(type) Sse2Reduce##type, Avx2Reduce##type
+#else
+#    define CPPY_SIMD_REDUCE_KERNELS(type) void, void
+#endif
+
+CPPY_API void simd_reduce(const int* data, std::size_t n, unsigned what, SimdReduceBlock<int>* result)
+{
+    reduce_dispatch<CPPY_SIMD_REDUCE_KERNELS(Int)>(data, n, what, result);
+}
+
+CPPY_API void simd_reduce(const float* data, std::size_t n, unsigned what, SimdReduceBlock<float>* result)
+{
+    reduce_dispatch<CPPY_SIMD_REDUCE_KERNELS(Float)>(data, n, what, result);
+}
+
+CPPY_API void simd_reduce(const double* data, std::size_t n, unsigned what, SimdReduceBlock<double>* result)
+{
+    reduce_dispatch<CPPY_SIMD_REDUCE_KERNELS(Double)>(data, n, what, result);
+}
+
+#undef CPPY_SIMD_REDUCE_KERNELS
+} // namespace internal
+} // namespace cppy
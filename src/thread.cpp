@@ -1,51 +1,958 @@
 ﻿#include "cppy/thread.h"
 
-CPPY_CONCURRENT_ThreadPoolExecutor::CPPY_CONCURRENT_ThreadPoolExecutor(size_t max_workers) {
-    for (size_t i = 0; i < max_workers; ++i) {
-        // start waiting threads. Workers listen for changes through
-        //  the thread_pool member condition_variable
-        _threads.emplace_back(std::thread([&]() {
-            std::unique_lock<std::mutex> queue_lock(_task_mutex, std::defer_lock);
+#include <chrono>
+#include <cmath>
+#include <sstream>
 
-            while (true) {
-                queue_lock.lock();
-                _task_cv.wait(queue_lock, [&]() -> bool {
-                    return !_tasks.empty() || _stop_threads;
-                    });
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    include <immintrin.h>
+#endif
 
-                // used by dtor to stop all threads without having to
-                //  unceremoniously stop tasks. The tasks must all be
-                //  finished, lest we break a promise and risk a `future`
-                //  object throwing an exception.
-                if (_stop_threads && _tasks.empty())
-                    return;
+namespace {
+// With an automatic grain, chunks of a parallel loop are sized to take about this long:
+//  long enough to hide the cost of claiming one, short enough to balance the load.
+constexpr std::chrono::microseconds kChunkTime(50);
 
-                // to initialize temp_task, we must move the unique_ptr
-                //  from the queue to the local stack. Since a unique_ptr
-                //  cannot be copied (obviously), it must be explicitly
-                //  moved. This transfers ownership of the pointed-to
-                //  object to *this, as specified in 20.11.1.2.1
-                //  [unique.ptr.single.ctor].
-                auto temp_task = std::move(_tasks.front());
+// The pool, worker index and submission queue of the calling thread, when it is a pool worker.
+struct CurrentWorker {
+    const CPPY_CONCURRENT_ThreadPoolExecutor* pool = nullptr;
+    size_t index = 0;
+    size_t queue = 0;
+};
+thread_local CurrentWorker current_worker;
 
-                _tasks.pop();
-                queue_lock.unlock();
+// Tell the CPU this is a spin-wait loop: it saves power and frees the core for a sibling
+//  hyper-thread.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// steady_clock now, in nanoseconds
+inline int64_t clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A duration for people: ns, us, ms or s, with three significant digits or so.
+std::string format_ns(double ns) {
+    static const char* const units[] = {"ns", "us", "ms", "s"};
+    size_t unit = 0;
+    for (; unit < 3 && ns >= 1000.0; ++unit)
+        ns /= 1000.0;
+    std::ostringstream text;
+    text.precision(ns < 10.0 && unit > 0 ? 2 : ns < 100.0 && unit > 0 ? 1 : 0);
+    text << std::fixed << ns << units[unit];
+    return text.str();
+}
+
+void histogram_text(std::ostringstream& text, const CPPY_CONCURRENT_Histogram& histogram) {
+    text << "count " << histogram.count() << " mean " << format_ns(histogram.mean()) << " p50 "
+         << format_ns(static_cast<double>(histogram.percentile(50))) << " p90 "
+         << format_ns(static_cast<double>(histogram.percentile(90))) << " p99 "
+         << format_ns(static_cast<double>(histogram.percentile(99))) << " max "
+         << format_ns(static_cast<double>(histogram.max()));
+}
+
+void histogram_json(std::ostringstream& json, const CPPY_CONCURRENT_Histogram& histogram) {
+    json << "{\"count\":" << histogram.count() << ",\"mean\":" << std::llround(histogram.mean())
+         << ",\"min\":" << histogram.min() << ",\"p50\":" << histogram.percentile(50)
+         << ",\"p90\":" << histogram.percentile(90) << ",\"p99\":" << histogram.percentile(99)
+         << ",\"p999\":" << histogram.percentile(99.9) << ",\"max\":" << histogram.max() << "}";
+}
+
+[[noreturn]] void throw_shut_down() {
+    // Python raises RuntimeError alike
+    throw std::runtime_error("cannot schedule new tasks after shutdown");
+}
 
-                (*temp_task)();
+uint64_t xorshift(uint64_t* const state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+} // namespace
+
+CPPY_CONCURRENT_ThreadPoolExecutor::CPPY_CONCURRENT_ThreadPoolExecutor(size_t max_workers)
+    : CPPY_CONCURRENT_ThreadPoolExecutor(CPPY_CONCURRENT_ThreadPoolOptions{max_workers, false}) {}
+
+CPPY_CONCURRENT_ThreadPoolExecutor::CPPY_CONCURRENT_ThreadPoolExecutor(const CPPY_CONCURRENT_ThreadPoolOptions& options)
+    : _worker_count(options.max_workers),
+      _work_stealing(options.work_stealing),
+      _spin_count(std::thread::hardware_concurrency() > 1 ? options.spin_count : 0),
+      _yield_count(options.yield_count),
+      _min_workers(std::min(options.min_workers, options.max_workers)),
+      _idle_timeout(options.idle_timeout),
+      _starvation_limit(options.starvation_limit),
+      _max_queued(options.max_queued),
+      _overflow(options.overflow),
+      _scheduler(std::make_shared<_scheduling>()) {
+    _scheduler->pool.store(this);
+    for (std::chrono::steady_clock::time_point& since : _passed_over)
+        since = std::chrono::steady_clock::time_point::max();
+#if defined(CPPY_THREAD_STATS)
+    _stats.reset(new _slot_stats[options.max_workers]);
+#endif
+    if (_work_stealing) {
+        _workers.reset(new _worker[options.max_workers]);
+        for (size_t i = 0; i < options.max_workers; ++i)
+            _workers[i].random = 0x9E3779B97F4A7C15ull * (i + 1);
+    }
+
+    // without topology the workers float and share one queue
+    std::vector<CPPY_PLATFORM_NumaNode> nodes;
+    if ((options.numa_aware || options.pin_workers) && CPPY_PLATFORM_numa_nodes(&nodes) != CPPY_ERROR_t::Ok)
+        nodes.clear();
+    if (!options.numa_aware && nodes.size() > 1) {
+        for (size_t n = 1; n < nodes.size(); ++n)
+            nodes[0].cpus.insert(nodes[0].cpus.end(), nodes[n].cpus.begin(), nodes[n].cpus.end());
+        nodes.resize(1);
+    }
+    if (options.numa_aware && !nodes.empty()) {
+        _queue_count = nodes.size();
+        for (size_t q = 0; q < nodes.size(); ++q) {
+            _queue_nodes.push_back(nodes[q].id);
+            for (int cpu : nodes[q].cpus) {
+                if (static_cast<size_t>(cpu) >= _cpu_queues.size())
+                    _cpu_queues.resize(cpu + 1, 0);
+                _cpu_queues[cpu] = q;
             }
-            }));
+        }
+    }
+    _queues.reset(new _queue[_queue_count]);
+
+    _slots.resize(options.max_workers);
+    for (size_t i = 0; i < options.max_workers && !nodes.empty(); ++i) {
+        // worker i goes to node i % nodes, and takes the next CPU there when pinned
+        const size_t node = i % nodes.size();
+        const std::vector<int>& node_cpus = nodes[node].cpus;
+        if (options.pin_workers)
+            _slots[i].cpus.push_back(node_cpus[(i / nodes.size()) % node_cpus.size()]);
+        else if (options.numa_aware)
+            _slots[i].cpus = node_cpus;
+        _slots[i].queue = options.numa_aware ? node : 0;
+    }
+
+    std::lock_guard<std::mutex> grow_lock(_grow_mutex);
+    for (size_t i = 0; i < _min_workers; ++i)
+        _start(i);
+}
+
+// Start the worker of a free slot; _grow_mutex is held.
+void CPPY_CONCURRENT_ThreadPoolExecutor::_start(size_t index) {
+    _slot& slot = _slots[index];
+    if (slot.thread.joinable())
+        slot.thread.join(); // a retired worker, which has left or is about to
+    slot.running = true;
+    _live.fetch_add(1);
+    // start waiting threads. Workers listen for changes through
+    //  the thread_pool member condition_variable
+    slot.thread = std::thread([this, index]() {
+        if (!_slots[index].cpus.empty())
+            CPPY_PLATFORM_set_affinity(_slots[index].cpus); // best effort: the worker still runs unpinned
+        _run(index);
+    });
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_grow() {
+    std::lock_guard<std::mutex> grow_lock(_grow_mutex);
+    if (_stop_threads.load() || _live.load() >= _worker_count)
+        return;
+    for (size_t i = 0; i < _worker_count; ++i) {
+        if (!_slots[i].running) {
+            _start(i);
+            return;
+        }
     }
 }
 
-void CPPY_CONCURRENT_ThreadPoolExecutor::shutdown() {
-    _stop_threads = true;
+bool CPPY_CONCURRENT_ThreadPoolExecutor::_retire(size_t index) {
+    std::lock_guard<std::mutex> grow_lock(_grow_mutex);
+    if (_stop_threads.load() || _live.load() <= _min_workers)
+        return false;
+    _live.fetch_sub(1);
+    // pairs with _push_batch adding to _pending before it reads _live: either this sees the
+    //  new task and stays, or the submitter sees one worker less and starts another
+    if (_pending.load() > 0) {
+        _live.fetch_add(1);
+        return false;
+    }
+    _slots[index].running = false;
+    return true;
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_schedule(void* scheduling, _task* task) {
+    auto* const target = static_cast<_scheduling*>(scheduling);
+    // announce the call before reading the pool, as the destructor clears the pool before
+    //  it waits for the calls to end: either it sees this one or this sees no pool
+    target->callers.fetch_add(1);
+    CPPY_CONCURRENT_ThreadPoolExecutor* const self = target->pool.load();
+    // once the workers are stopping, or gone with the pool, a continuation set off from
+    //  outside them might never be taken: run it here instead
+    const bool queued = self != nullptr && !(self->_stop_threads.load() && current_worker.pool != self);
+    if (queued) {
+        self->_task_submitted(false);
+        self->_push(task);
+    }
+    target->callers.fetch_sub(1);
+    if (!queued)
+        task->run();
+}
+
+size_t CPPY_CONCURRENT_ThreadPoolExecutor::_node_queue(int node) const {
+    for (size_t q = 0; q < _queue_nodes.size(); ++q) {
+        if (_queue_nodes[q] == node)
+            return q;
+    }
+    return _home_queue;
+}
+
+size_t CPPY_CONCURRENT_ThreadPoolExecutor::_submitter_queue() const {
+    if (current_worker.pool == this)
+        return current_worker.queue;
+    int cpu = 0;
+    if (_queue_count > 1 && CPPY_PLATFORM_current_cpu(&cpu) == CPPY_ERROR_t::Ok &&
+        static_cast<size_t>(cpu) < _cpu_queues.size())
+        return _cpu_queues[cpu];
+    return 0;
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_push(_task* task, size_t queue) {
+    _push_batch(&task, 1, queue);
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_push_batch(_task* const* tasks, size_t n, size_t queue) {
+#if defined(CPPY_THREAD_STATS)
+    const int64_t now = clock_ns();
+    for (size_t k = 0; k < n; ++k)
+        tasks[k]->enqueued = now;
+#endif
+    // counted before they are visible, so that _pending never underflows
+    _pending.fetch_add(n);
+    _enqueue(tasks, n, queue);
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_submit(_task* task, size_t queue, const CPPY_CONCURRENT_TaskOptions& options) {
+#if defined(CPPY_THREAD_STATS)
+    // queue wait counts from here, including a wait for a place in a bounded queue
+    task->enqueued = clock_ns();
+#endif
+    const bool from_worker = current_worker.pool == this;
+    if (!_reserve()) {
+        if (_stop_threads.load() && !from_worker) {
+            task->discard();
+            throw_shut_down();
+        }
+        if (_overflow == CPPY_CONCURRENT_overflow_t::Reject) {
+            task->discard();
+            throw CPPY_CONCURRENT_QueueFullError("thread pool queue is full");
+        }
+        if (_overflow == CPPY_CONCURRENT_overflow_t::CallerRuns || from_worker) {
+            _task_submitted(true);
+            try {
+                task->run();
+            }
+            catch (...) {
+                // as on a worker: only a posted task can throw here
+            }
+            return;
+        }
+        bool reserved = false;
+        {
+            std::unique_lock<std::mutex> space_lock(_space_mutex);
+            _blocked.fetch_add(1);
+            _space_cv.wait(space_lock, [&]() { return (reserved = _reserve()) || _stop_threads.load(); });
+            _blocked.fetch_sub(1);
+        }
+        if (!reserved) {
+            task->discard();
+            throw_shut_down();
+        }
+    }
+    // reserved before the stop flag is read, the other way round from the workers: either
+    //  this sees the flag, or a worker sees the task pending and stays to take it
+    if (_stop_threads.load() && !from_worker) {
+        _unreserve(1);
+        task->discard();
+        throw_shut_down();
+    }
+    _task_submitted(false);
+    _enqueue(task, queue, options);
+}
+
+// Count one more task pending, unless that would pass the bound.
+bool CPPY_CONCURRENT_ThreadPoolExecutor::_reserve() {
+    if (_max_queued == 0) {
+        _pending.fetch_add(1);
+        return true;
+    }
+    size_t pending = _pending.load();
+    while (pending < _max_queued) {
+        if (_pending.compare_exchange_weak(pending, pending + 1))
+            return true;
+    }
+    return false;
+}
+
+// Count n tasks less pending, and let blocked submitters into the places that frees.
+void CPPY_CONCURRENT_ThreadPoolExecutor::_unreserve(size_t n) {
+    _pending.fetch_sub(n);
+    // pairs with a blocked submitter incrementing _blocked before it reads _pending
+    if (_blocked.load() > 0) {
+        std::lock_guard<std::mutex> space_lock(_space_mutex);
+        _space_cv.notify_all();
+    }
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_enqueue(_task* const* tasks, size_t n, size_t queue) {
+    size_t i = 0;
+    if (_work_stealing && current_worker.pool == this && (queue == _home_queue || queue == current_worker.queue)) {
+        // a task spawned by a task stays with the worker that spawned it
+        for (; i < n; ++i)
+            _workers[current_worker.index].tasks.push(tasks[i]);
+    }
+    _queue& target = _queues[queue == _home_queue ? _submitter_queue() : queue];
+    while (i < n && target.tasks.try_push(tasks[i]))
+        ++i;
+    if (i < n) {
+        std::lock_guard<std::mutex> queue_lock(target.mutex);
+        target.overflow.insert(target.overflow.end(), tasks + i, tasks + n);
+        target.overflowed.fetch_add(n - i, std::memory_order_relaxed);
+    }
+
+    // pairs with the sleeper incrementing _sleepers before it reads _pending: either the
+    //  sleeper sees the tasks, or this sees the sleeper. Taking the mutex orders the
+    //  notification after the sleeper has started waiting. A batch pays for it once.
+    const size_t sleepers = _sleepers.load();
+    if (sleepers > 0) {
+        { std::lock_guard<std::mutex> queue_lock(_task_mutex); }
+        if (n >= sleepers)
+            _task_cv.notify_all();
+        else
+            for (size_t k = 0; k < n; ++k)
+                _task_cv.notify_one();
+    }
+
+    // an elastic pool grows while more tasks wait than there are idle workers to take them
+    if (_live.load() < _worker_count && _pending.load() > _sleepers.load() + _spinning.load())
+        _grow();
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_enqueue(_task* task, size_t queue, const CPPY_CONCURRENT_TaskOptions& options) {
+    const size_t priority = static_cast<size_t>(options.priority);
+    if (priority == static_cast<size_t>(CPPY_CONCURRENT_priority_t::Normal) &&
+        options.deadline == std::chrono::steady_clock::time_point::max()) {
+        _enqueue(&task, 1, queue);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> priority_lock(_priority_mutex);
+        std::vector<_prioritized>& heap = _priority_heaps[priority];
+        heap.push_back(_prioritized{options.deadline, _priority_sequence++, task});
+        std::push_heap(heap.begin(), heap.end(), &_prioritized::later);
+        _heap_sizes[priority].fetch_add(1, std::memory_order_relaxed);
+        _prioritized_count.fetch_add(1);
+    }
+
+    // as in _enqueue of a batch
+    if (_sleepers.load() > 0) {
+        { std::lock_guard<std::mutex> queue_lock(_task_mutex); }
+        _task_cv.notify_one();
+    }
+    if (_live.load() < _worker_count && _pending.load() > _sleepers.load() + _spinning.load())
+        _grow();
+}
+
+// The next task by priority, or nullptr when it is a plain task of the normal class, which
+//  the caller takes from the submission queues, or when there is none. `plain_waiting` says
+//  whether there may be plain tasks.
+CPPY_CONCURRENT_ThreadPoolExecutor::_task* CPPY_CONCURRENT_ThreadPoolExecutor::_take_prioritized(bool plain_waiting) {
+    constexpr size_t normal = static_cast<size_t>(CPPY_CONCURRENT_priority_t::Normal);
+    constexpr std::chrono::steady_clock::time_point never = std::chrono::steady_clock::time_point::max();
+    std::lock_guard<std::mutex> priority_lock(_priority_mutex);
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    bool waiting[_priority_count];
+    for (size_t c = 0; c < _priority_count; ++c)
+        waiting[c] = !_priority_heaps[c].empty();
+    if (plain_waiting)
+        waiting[normal] = waiting[normal] || _pending.load() > _prioritized_count.load();
+
+    // a class that has waited out the starvation limit goes first, the lowest one first;
+    //  otherwise the highest class with tasks
+    size_t chosen = _priority_count;
+    for (size_t c = _priority_count; c-- > 1 && chosen == _priority_count;) {
+        if (waiting[c] && _passed_over[c] != never && now - _passed_over[c] >= _starvation_limit)
+            chosen = c;
+    }
+    for (size_t c = 0; c < _priority_count && chosen == _priority_count; ++c) {
+        if (waiting[c])
+            chosen = c;
+    }
+    for (size_t c = 0; c < _priority_count; ++c) {
+        if (!waiting[c] || c == chosen)
+            _passed_over[c] = never;
+        else if (c > chosen && _passed_over[c] == never)
+            _passed_over[c] = now;
+    }
+    if (chosen == _priority_count || _priority_heaps[chosen].empty())
+        return nullptr;
+
+    std::vector<_prioritized>& heap = _priority_heaps[chosen];
+    std::pop_heap(heap.begin(), heap.end(), &_prioritized::later);
+    _task* const task = heap.back().task;
+    heap.pop_back();
+    _heap_sizes[chosen].fetch_sub(1, std::memory_order_relaxed);
+    if (_prioritized_count.fetch_sub(1) == 1) {
+        // only plain tasks are left, and nothing is passed over for them
+        for (std::chrono::steady_clock::time_point& since : _passed_over)
+            since = never;
+    }
+    return task;
+}
+
+size_t CPPY_CONCURRENT_ThreadPoolExecutor::queue_depth(CPPY_CONCURRENT_priority_t priority) const {
+    const size_t c = static_cast<size_t>(priority);
+    size_t depth = _heap_sizes[c].load(std::memory_order_relaxed);
+    if (priority == CPPY_CONCURRENT_priority_t::Normal) {
+        // the plain tasks are what _pending counts beyond the heaps
+        const size_t pending = _pending.load();
+        const size_t prioritized = _prioritized_count.load();
+        depth += pending > prioritized ? pending - prioritized : 0;
+    }
+    return depth;
+}
+
+// The shared state of one parallel loop. Helpers hold a reference, so a helper that only
+//  starts after the loop has returned finds nothing left to claim and touches nothing else.
+struct CPPY_CONCURRENT_ThreadPoolExecutor::_loop {
+    _loop(size_t begin, size_t end, size_t grain, _chunk_body body, void* context)
+        : next(begin), end(end), total(end - begin), grain(grain), body(body), context(context) {}
+
+    // Claim and run chunks until none are left.
+    void work() {
+        while (true) {
+            const size_t lo = next.fetch_add(grain);
+            if (lo >= end)
+                return;
+            const size_t hi = std::min(end, lo + grain);
+            try {
+                body(context, lo, hi);
+            }
+            catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                // give up the chunks nobody has claimed yet
+                const size_t unclaimed = next.exchange(end);
+                if (unclaimed < end)
+                    finish(end - unclaimed);
+            }
+            finish(hi - lo);
+        }
+    }
+
+    void finish(size_t n) {
+        if (finished.fetch_add(n) + n == total) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]() { return finished.load() == total; });
+    }
+
+    std::atomic<size_t> next;
+    std::atomic<size_t> finished{0};
+    const size_t end, total, grain;
+    const _chunk_body body;
+    void* const context;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+struct CPPY_CONCURRENT_ThreadPoolExecutor::_helper {
+    void operator()() { loop->work(); }
+    std::shared_ptr<_loop> loop;
+};
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_parallel(
+    size_t begin, size_t end, size_t grain, _chunk_body body, void* context) {
+    if (begin >= end)
+        return;
+    if (_stop_threads.load() && current_worker.pool != this)
+        throw_shut_down();
+
+    if (grain == 0) {
+        // adaptive grain: run doubling chunks on the calling thread until they take long
+        //  enough to time, then size the remaining chunks from the measured cost. A short
+        //  loop finishes here without waking any worker.
+        using clock = std::chrono::steady_clock;
+        const size_t first = begin;
+        const clock::time_point start = clock::now();
+        clock::duration elapsed{};
+        for (size_t size = 1; begin < end && elapsed < kChunkTime; size *= 2) {
+            const size_t hi = begin + std::min(size, end - begin);
+            body(context, begin, hi);
+            begin = hi;
+            elapsed = clock::now() - start;
+        }
+        if (begin >= end)
+            return;
+        const double per_item = std::chrono::duration<double>(elapsed).count() / static_cast<double>(begin - first);
+        grain = std::max<size_t>(1, static_cast<size_t>(std::chrono::duration<double>(kChunkTime).count() / per_item));
+    }
+
+    const size_t chunks = (end - begin + grain - 1) / grain;
+    const size_t helpers = std::min(_worker_count, chunks - 1);
+    if (helpers == 0) {
+        for (; begin < end; begin += std::min(grain, end - begin))
+            body(context, begin, begin + std::min(grain, end - begin));
+        return;
+    }
+
+    // one batch of helpers; the calling thread works too, so the loop completes even when
+    //  every worker is busy, including when it is itself running on one
+    auto loop = std::make_shared<_loop>(begin, end, grain, body, context);
+    std::vector<_task*> tasks(helpers);
+    for (_task*& task : tasks)
+        task = _task::make(_helper{loop});
+    _push_batch(tasks.data(), tasks.size());
+
+    loop->work();
+    loop->wait();
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+CPPY_CONCURRENT_ThreadPoolExecutor::_task* CPPY_CONCURRENT_ThreadPoolExecutor::_take(size_t index, size_t queue) {
+    _task* task = nullptr;
+    // tasks with a priority or a deadline first, unless plain ones are next
+    if (_prioritized_count.load(std::memory_order_relaxed) > 0 && (task = _take_prioritized(true)))
+        return task;
+    if (_work_stealing && _workers[index].tasks.pop(&task))
+        return task;
+
+    // the worker's own node first, then the others
+    for (size_t k = 0; k < _queue_count; ++k) {
+        _queue& source = _queues[(queue + k) % _queue_count];
+        if (source.tasks.try_pop(&task))
+            return task;
+        if (source.overflowed.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> queue_lock(source.mutex);
+            if (!source.overflow.empty()) {
+                task = source.overflow.front();
+                source.overflow.pop_front();
+                source.overflowed.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+    }
+
+    if (_work_stealing && (task = _steal(index)))
+        return task;
+    // the plain tasks counted as waiting were taken meanwhile
+    return _prioritized_count.load(std::memory_order_relaxed) > 0 ? _take_prioritized(false) : nullptr;
+}
+
+CPPY_CONCURRENT_ThreadPoolExecutor::_task* CPPY_CONCURRENT_ThreadPoolExecutor::_steal(size_t index) {
+    // visit every other worker once, starting from a random one
+    const size_t n = _worker_count;
+    const size_t start = static_cast<size_t>(xorshift(&_workers[index].random) % n);
+    _task* task = nullptr;
+    for (size_t k = 0; k < n; ++k) {
+        const size_t victim = (start + k) % n;
+        if (victim != index && _workers[victim].tasks.steal(&task)) {
+#if defined(CPPY_THREAD_STATS)
+            cppy::internal::single_writer_add(_stats[index].steals, uint64_t(1));
+#endif
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool CPPY_CONCURRENT_ThreadPoolExecutor::_idle_poll() {
+    // the idle policy: spin, then yield, before the worker parks. _spinning tells
+    //  submitters this worker will still see their tasks without a wake-up
+    _spinning.fetch_add(1);
+    bool found = false;
+    for (size_t k = 0; k < _spin_count && !found; ++k) {
+        cpu_relax();
+        found = _pending.load(std::memory_order_relaxed) > 0;
+    }
+    for (size_t k = 0; k < _yield_count && !found; ++k) {
+        std::this_thread::yield();
+        found = _pending.load(std::memory_order_relaxed) > 0;
+    }
+    _spinning.fetch_sub(1);
+    return found;
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_run(size_t index) {
+    const size_t queue = _slots[index].queue;
+    current_worker = CurrentWorker{this, index, queue};
+
+    while (true) {
+        if (_task* task = _take(index, queue)) {
+            _unreserve(1);
+            const bool counted = !task->holds<_helper>();
+            const int64_t started = _task_started(index, task, counted);
+            try {
+                task->run();
+            }
+            catch (...) {
+                // only a posted task can throw here; nobody is waiting for its result
+            }
+            _task_finished(index, started, counted);
+            continue;
+        }
+        _worker_idle(index);
+        if (!_stop_threads.load(std::memory_order_relaxed) && _idle_poll())
+            continue;
+
+        // used by dtor to stop all threads without having to
+        //  unceremoniously stop tasks. The tasks must all be
+        //  finished, lest we break a promise and risk a `future`
+        //  object throwing an exception.
+        std::unique_lock<std::mutex> queue_lock(_task_mutex);
+        _sleepers.fetch_add(1);
+        const auto woken = [&]() -> bool {
+            return _pending.load() > 0 || _stop_threads.load();
+        };
+        bool timed_out = false;
+        if (_live.load() > _min_workers)
+            timed_out = !_task_cv.wait_for(queue_lock, _idle_timeout, woken);
+        else
+            _task_cv.wait(queue_lock, woken);
+        _sleepers.fetch_sub(1);
+        if (_stop_threads.load() && _pending.load() == 0) {
+            _live.fetch_sub(1);
+            _worker_stopped(index);
+            return;
+        }
+        if (timed_out) {
+            queue_lock.unlock();
+            // a slot is only started again after its last thread is joined. _retire takes the
+            //  worker out of _live itself, as it has to before it checks for new tasks
+            if (_retire(index)) {
+                _worker_stopped(index);
+                return;
+            }
+        }
+    }
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::shutdown(bool wait, bool cancel_futures) {
+    {
+        std::lock_guard<std::mutex> queue_lock(_task_mutex);
+        _stop_threads = true;
+        if (cancel_futures)
+            _cancel_futures = true;
+    }
     _task_cv.notify_all();
+    {
+        // blocked submitters give up
+        std::lock_guard<std::mutex> space_lock(_space_mutex);
+        _space_cv.notify_all();
+    }
+    if (cancel_futures)
+        _discard_queued();
+    if (!wait)
+        return;
 
-    for (std::thread& thread : _threads) {
+    // no worker starts once _stop_threads is set; take the threads out of the slots so that
+    //  they are joined without holding the lock a retiring worker needs
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> grow_lock(_grow_mutex);
+        for (_slot& slot : _slots) {
+            if (slot.thread.joinable())
+                threads.push_back(std::move(slot.thread));
+        }
+    }
+    for (std::thread& thread : threads)
         thread.join();
+    _discard_queued();
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_discard_queued() {
+    // the tasks not started yet, dropped while the workers may still be taking others: by a
+    //  shutdown that cancels them, or once they are gone, from a pool without workers. Their
+    //  futures see CancelledError in the first case and broken_promise in the second. A task
+    //  is discarded after it is unlinked, since its promise may schedule continuations.
+    std::vector<_task*> tasks;
+    _task* task = nullptr;
+    for (size_t q = 0; q < _queue_count; ++q) {
+        while (_queues[q].tasks.try_pop(&task))
+            tasks.push_back(task);
+        std::lock_guard<std::mutex> queue_lock(_queues[q].mutex);
+        tasks.insert(tasks.end(), _queues[q].overflow.begin(), _queues[q].overflow.end());
+        _queues[q].overflowed.fetch_sub(_queues[q].overflow.size(), std::memory_order_relaxed);
+        _queues[q].overflow.clear();
     }
+    for (size_t i = 0; _workers && i < _worker_count; ++i) {
+        // steal, not pop: the owner may be running
+        while (_workers[i].tasks.steal(&task))
+            tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> priority_lock(_priority_mutex);
+        for (size_t c = 0; c < _priority_count; ++c) {
+            for (_prioritized& waiting : _priority_heaps[c])
+                tasks.push_back(waiting.task);
+            _prioritized_count.fetch_sub(_priority_heaps[c].size());
+            _priority_heaps[c].clear();
+            _heap_sizes[c] = 0;
+        }
+    }
+    if (tasks.empty())
+        return;
+#if defined(CPPY_THREAD_STATS)
+    _discarded.fetch_add(static_cast<uint64_t>(
+        std::count_if(tasks.begin(), tasks.end(), [](const _task* task) { return !task->holds<_helper>(); })));
+#endif
+    _unreserve(tasks.size());
+    const std::exception_ptr cancelled =
+        _cancel_futures.load() ? std::make_exception_ptr(CPPY_CONCURRENT_CancelledError("task cancelled")) : nullptr;
+    cppy::internal::dropped_error = cancelled ? &cancelled : nullptr;
+    for (_task* discarded : tasks)
+        discarded->discard();
+    cppy::internal::dropped_error = nullptr;
 }
 
 CPPY_CONCURRENT_ThreadPoolExecutor::~CPPY_CONCURRENT_ThreadPoolExecutor() {
     shutdown();
-}
\ No newline at end of file
+    // futures may outlive the pool; their continuations run inline from here on
+    _scheduler->pool.store(nullptr);
+    while (_scheduler->callers.load() != 0)
+        std::this_thread::yield();
+}
+
+// Count a task accepted from the calling thread, on its worker's counters when it is one.
+void CPPY_CONCURRENT_ThreadPoolExecutor::_task_submitted(bool ran_inline) {
+#if defined(CPPY_THREAD_STATS)
+    if (current_worker.pool == this) {
+        _slot_stats& stats = _stats[current_worker.index];
+        cppy::internal::single_writer_add(stats.submitted, uint64_t(1));
+        if (ran_inline)
+            cppy::internal::single_writer_add(stats.ran_inline, uint64_t(1));
+        return;
+    }
+    _submitted.fetch_add(1, std::memory_order_relaxed);
+    if (ran_inline)
+        _ran_inline.fetch_add(1, std::memory_order_relaxed);
+#else
+    (void)ran_inline;
+#endif
+}
+
+int64_t CPPY_CONCURRENT_ThreadPoolExecutor::_task_started(size_t index, const _task* task, bool counted) {
+#if defined(CPPY_THREAD_STATS)
+    _slot_stats& stats = _stats[index];
+    const int64_t now = clock_ns();
+    if (const int64_t since = stats.idle_since.load(std::memory_order_relaxed)) {
+        cppy::internal::single_writer_add(stats.idle, now - since);
+        stats.idle_since.store(0, std::memory_order_relaxed);
+    }
+    if (counted)
+        stats.queue_wait.record(static_cast<uint64_t>(std::max<int64_t>(0, now - task->enqueued)));
+    return now;
+#else
+    (void)index;
+    (void)task;
+    (void)counted;
+    return 0;
+#endif
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_task_finished(size_t index, int64_t started, bool counted) {
+#if defined(CPPY_THREAD_STATS)
+    _slot_stats& stats = _stats[index];
+    const int64_t elapsed = clock_ns() - started;
+    cppy::internal::single_writer_add(stats.busy, elapsed);
+    if (!counted)
+        return;
+    stats.run_time.record(static_cast<uint64_t>(elapsed));
+    cppy::internal::single_writer_add(stats.completed, uint64_t(1));
+#else
+    (void)index;
+    (void)started;
+    (void)counted;
+#endif
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_worker_idle(size_t index) {
+#if defined(CPPY_THREAD_STATS)
+    if (_stats[index].idle_since.load(std::memory_order_relaxed) == 0)
+        _stats[index].idle_since.store(clock_ns(), std::memory_order_relaxed);
+#else
+    (void)index;
+#endif
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_worker_stopped(size_t index) {
+#if defined(CPPY_THREAD_STATS)
+    _slot_stats& stats = _stats[index];
+    if (const int64_t since = stats.idle_since.load(std::memory_order_relaxed)) {
+        cppy::internal::single_writer_add(stats.idle, clock_ns() - since);
+        stats.idle_since.store(0, std::memory_order_relaxed);
+    }
+#else
+    (void)index;
+#endif
+}
+
+void CPPY_CONCURRENT_ThreadPoolExecutor::_snapshot(
+    const cppy::internal::HistogramRecorder& recorder, CPPY_CONCURRENT_Histogram* histogram) {
+    histogram->_count = 0;
+    for (size_t b = 0; b < cppy::internal::kHistogramBuckets; ++b) {
+        histogram->_counts[b] = recorder.counts[b].load(std::memory_order_relaxed);
+        histogram->_count += histogram->_counts[b];
+    }
+    histogram->_sum = recorder.sum.load(std::memory_order_relaxed);
+    histogram->_min = recorder.min.load(std::memory_order_relaxed);
+    histogram->_max = recorder.max.load(std::memory_order_relaxed);
+}
+
+CPPY_CONCURRENT_ThreadPoolStats CPPY_CONCURRENT_ThreadPoolExecutor::stats() const {
+    CPPY_CONCURRENT_ThreadPoolStats stats;
+    stats.pending = _pending.load();
+#if defined(CPPY_THREAD_STATS)
+    stats.enabled = true;
+    stats.submitted = _submitted.load(std::memory_order_relaxed);
+    stats.ran_inline = _ran_inline.load(std::memory_order_relaxed);
+    const int64_t now = clock_ns();
+    for (size_t i = 0; i < _worker_count; ++i) {
+        const _slot_stats& slot = _stats[i];
+        CPPY_CONCURRENT_WorkerStats worker;
+        worker.completed = slot.completed.load(std::memory_order_relaxed);
+        worker.steals = slot.steals.load(std::memory_order_relaxed);
+        worker.busy = std::chrono::nanoseconds(slot.busy.load(std::memory_order_relaxed));
+        int64_t idle = slot.idle.load(std::memory_order_relaxed);
+        if (const int64_t since = slot.idle_since.load(std::memory_order_relaxed))
+            idle += std::max<int64_t>(0, now - since); // the spell it is in now
+        worker.idle = std::chrono::nanoseconds(idle);
+        _snapshot(slot.queue_wait, &worker.queue_wait);
+        _snapshot(slot.run_time, &worker.run_time);
+
+        stats.submitted += slot.submitted.load(std::memory_order_relaxed);
+        stats.ran_inline += slot.ran_inline.load(std::memory_order_relaxed);
+        stats.completed += worker.completed;
+        stats.steals += worker.steals;
+        stats.queue_wait.merge(worker.queue_wait);
+        stats.run_time.merge(worker.run_time);
+        stats.workers.push_back(std::move(worker));
+    }
+    stats.discarded = _discarded.load();
+#endif
+    return stats;
+}
+
+CPPY_CONCURRENT_Histogram::CPPY_CONCURRENT_Histogram() : _counts(cppy::internal::kHistogramBuckets, 0) {}
+
+void CPPY_CONCURRENT_Histogram::record(uint64_t value, uint64_t times) {
+    if (times == 0)
+        return;
+    _counts[cppy::internal::histogram_bucket(value)] += times;
+    _count += times;
+    _sum += value * times;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+void CPPY_CONCURRENT_Histogram::merge(const CPPY_CONCURRENT_Histogram& other) {
+    for (size_t b = 0; b < _counts.size(); ++b)
+        _counts[b] += other._counts[b];
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+uint64_t CPPY_CONCURRENT_Histogram::percentile(double p) const {
+    if (_count == 0)
+        return 0;
+    const double rank = std::ceil(std::min(std::max(p, 0.0), 100.0) / 100.0 * static_cast<double>(_count));
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(rank));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < _counts.size(); ++b) {
+        seen += _counts[b];
+        // the last bucket also holds every value past kHistogramMax
+        if (seen >= target && b + 1 < _counts.size())
+            return std::min(std::max(cppy::internal::histogram_bucket_max(b), _min), _max);
+        if (seen >= target)
+            return _max;
+    }
+    return _max;
+}
+
+double CPPY_CONCURRENT_WorkerStats::utilisation() const {
+    const double total = static_cast<double>((busy + idle).count());
+    return total > 0.0 ? static_cast<double>(busy.count()) / total : 0.0;
+}
+
+std::string CPPY_CONCURRENT_ThreadPoolStats::to_text() const {
+    std::ostringstream text;
+    if (!enabled) {
+        text << "pending " << pending << " (no instrumentation: cppy is built without CPPY_THREAD_STATS)\n";
+        return text.str();
+    }
+    text << "submitted " << submitted << " completed " << completed << " ran inline " << ran_inline << " discarded "
+         << discarded << " pending " << pending << " steals " << steals << "\n";
+    text << "queue wait ";
+    histogram_text(text, queue_wait);
+    text << "\nrun time   ";
+    histogram_text(text, run_time);
+    text << "\n";
+    for (size_t i = 0; i < workers.size(); ++i) {
+        const CPPY_CONCURRENT_WorkerStats& worker = workers[i];
+        text << "worker " << i << " completed " << worker.completed << " steals " << worker.steals << " busy "
+             << format_ns(static_cast<double>(worker.busy.count())) << " idle "
+             << format_ns(static_cast<double>(worker.idle.count())) << " utilisation ";
+        text.precision(1);
+        text << std::fixed << worker.utilisation() * 100.0 << "%\n";
+    }
+    return text.str();
+}
+
+std::string CPPY_CONCURRENT_ThreadPoolStats::to_json() const {
+    std::ostringstream json;
+    if (!enabled) {
+        // the counters are unavailable, not zero
+        json << "{\"enabled\":false,\"pending\":" << pending << "}";
+        return json.str();
+    }
+    json << "{\"enabled\":true,\"submitted\":" << submitted << ",\"completed\":" << completed
+         << ",\"ran_inline\":" << ran_inline << ",\"discarded\":" << discarded << ",\"pending\":" << pending
+         << ",\"steals\":" << steals << ",\"queue_wait_ns\":";
+    histogram_json(json, queue_wait);
+    json << ",\"run_time_ns\":";
+    histogram_json(json, run_time);
+    json << ",\"workers\":[";
+    for (size_t i = 0; i < workers.size(); ++i) {
+        const CPPY_CONCURRENT_WorkerStats& worker = workers[i];
+        json << (i ? "," : "") << "{\"completed\":" << worker.completed << ",\"steals\":" << worker.steals
+             << ",\"busy_ns\":" << worker.busy.count() << ",\"idle_ns\":" << worker.idle.count()
+             << ",\"utilisation\":";
+        json.precision(4);
+        json << std::fixed << worker.utilisation() << ",\"queue_wait_ns\":";
+        histogram_json(json, worker.queue_wait);
+        json << ",\"run_time_ns\":";
+        histogram_json(json, worker.run_time);
+        json << "}";
+    }
+    json << "]}";
+    return json.str();
+}
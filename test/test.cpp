@@ -1,5 +1,14 @@
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <forward_list>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <sstream>
 
 #ifdef _WIN32
 #    include <windows.h>
@@ -53,6 +62,37 @@ TEST(TEST_CPPY_BUILTINS, all)
         CPPY_BUILTINS_all(data.begin(), data.end(), &result);
         EXPECT_FALSE(result);
     }
+    {
+        // NaN is true and -0.0 is false, as in Python
+        std::vector<double> data(37, 1.0);
+        data[5] = std::numeric_limits<double>::quiet_NaN();
+        bool result;
+        CPPY_BUILTINS_all(data.begin(), data.end(), &result);
+        EXPECT_TRUE(result);
+        data[30] = -0.0;
+        CPPY_BUILTINS_all(data.begin(), data.end(), &result);
+        EXPECT_FALSE(result);
+        std::vector<std::string> strings{"a", "b"};
+        CPPY_BUILTINS_all(strings.begin(), strings.end(), [](const std::string& s) { return !s.empty(); }, &result);
+        EXPECT_TRUE(result);
+    }
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+        std::vector<int> data(200000, 1);
+        bool result;
+        CPPY_BUILTINS_all(&pool, data.begin(), data.end(), &result);
+        EXPECT_TRUE(result);
+        CPPY_BUILTINS_all(&pool, data.begin(), data.end(), [](int x) { return x == 1; }, &result);
+        EXPECT_TRUE(result);
+        data[150000] = 0;
+        CPPY_BUILTINS_all(&pool, data.begin(), data.end(), &result);
+        EXPECT_FALSE(result);
+        CPPY_BUILTINS_all(&pool, data.begin(), data.end(), [](int x) { return x == 1; }, &result);
+        EXPECT_FALSE(result);
+        std::vector<int> empty;
+        CPPY_BUILTINS_all(&pool, empty.begin(), empty.end(), &result);
+        EXPECT_TRUE(result);
+    }
 }
 
 TEST(TEST_CPPY_BUILTINS, any)
@@ -87,6 +127,29 @@ TEST(TEST_CPPY_BUILTINS, any)
         CPPY_BUILTINS_any(data.begin(), data.end(), &result);
         EXPECT_FALSE(result);
     }
+    {
+        std::vector<float> data(41, -0.0f);
+        bool result;
+        CPPY_BUILTINS_any(data.begin(), data.end(), &result);
+        EXPECT_FALSE(result);
+        data[40] = std::numeric_limits<float>::quiet_NaN();
+        CPPY_BUILTINS_any(data.begin(), data.end(), &result);
+        EXPECT_TRUE(result);
+    }
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+        std::vector<int> data(200000, 0);
+        bool result;
+        CPPY_BUILTINS_any(&pool, data.begin(), data.end(), &result);
+        EXPECT_FALSE(result);
+        CPPY_BUILTINS_any(&pool, data.begin(), data.end(), [](int x) { return x > 0; }, &result);
+        EXPECT_FALSE(result);
+        data[199999] = 7;
+        CPPY_BUILTINS_any(&pool, data.begin(), data.end(), &result);
+        EXPECT_TRUE(result);
+        CPPY_BUILTINS_any(&pool, data.begin(), data.end(), [](int x) { return x > 0; }, &result);
+        EXPECT_TRUE(result);
+    }
 }
 
 TEST(TEST_CPPY_BUILTINS, callable)
@@ -195,6 +258,82 @@ TEST(TEST_CPPY_BUILTINS, filter)
     EXPECT_EQ(empty_out.size(), 0);
 }
 
+TEST(TEST_CPPY_BUILTINS, filter_compact)
+{
+    // every keep pattern of a register, across block boundaries, for each compacted type
+    std::vector<int> ints(5000);
+    for (int i = 0; i < 5000; ++i)
+        ints[i] = (i * 7919) % 1009;
+    auto keep = [](auto x) { return static_cast<int>(x) % 3 != 0; };
+    std::vector<int> expected;
+    std::copy_if(ints.begin(), ints.end(), std::back_inserter(expected), keep);
+
+    std::vector<int> int_out;
+    CPPY_BUILTINS_filter(ints.begin(), ints.end(), keep, std::back_inserter(int_out));
+    EXPECT_EQ(int_out, expected);
+    std::vector<float> floats(ints.begin(), ints.end()), float_out;
+    CPPY_BUILTINS_filter(floats.begin(), floats.end(), keep, std::back_inserter(float_out));
+    EXPECT_EQ(float_out, std::vector<float>(expected.begin(), expected.end()));
+    std::vector<double> doubles(ints.begin(), ints.end()), double_out;
+    CPPY_BUILTINS_filter(doubles.begin(), doubles.end(), keep, std::back_inserter(double_out));
+    EXPECT_EQ(double_out, std::vector<double>(expected.begin(), expected.end()));
+    std::vector<short> shorts(ints.begin(), ints.end()), short_out;
+    CPPY_BUILTINS_filter(shorts.begin(), shorts.end(), keep, std::back_inserter(short_out));
+    EXPECT_EQ(short_out, std::vector<short>(expected.begin(), expected.end()));
+    // into a container without a range insert
+    CPPY_IndexedList<int> indexed_out;
+    CPPY_BUILTINS_filter(ints.begin(), ints.end(), keep, std::back_inserter(indexed_out));
+    EXPECT_EQ(std::vector<int>(indexed_out.begin(), indexed_out.end()), expected);
+
+    // the predicate still sees every element once, in order
+    std::vector<int> seen;
+    int exact[3];
+    std::vector<int> small{5, 6, 7, 8, 9};
+    CPPY_BUILTINS_filter(small.begin(), small.end(), [&seen](int x) { seen.push_back(x); return x % 2 == 1; }, exact);
+    EXPECT_EQ(seen, small);
+    EXPECT_EQ(exact[0], 5);
+    EXPECT_EQ(exact[2], 9);
+
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+    std::vector<int> large(100000);
+    for (int i = 0; i < 100000; ++i)
+        large[i] = i;
+    std::vector<int> parallel_out;
+    CPPY_BUILTINS_filter(&pool, large.begin(), large.end(), [](int x) { return x % 7 == 0; },
+                         std::back_inserter(parallel_out));
+    ASSERT_EQ(parallel_out.size(), 14286u);
+    for (std::size_t i = 0; i < parallel_out.size(); ++i)
+        EXPECT_EQ(parallel_out[i], static_cast<int>(7 * i));
+}
+
+TEST(TEST_CPPY_BUILTINS, fsum)
+{
+    std::vector<double> tenths(10, 0.1);
+    double result;
+    EXPECT_EQ(CPPY_BUILTINS_fsum(tenths.begin(), tenths.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, 1.0);
+
+    // >>> fsum([1e100, 1.0, -1e100, 1e-100, 1e50, -1.0, -1e50])
+    // 1e-100
+    std::vector<double> cancel{1e100, 1.0, -1e100, 1e-100, 1e50, -1.0, -1e50};
+    EXPECT_EQ(CPPY_BUILTINS_fsum(cancel.begin(), cancel.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, 1e-100);
+
+    // >>> fsum([2.0**53, 1.0, 2.0**-100])   (rounds half-even up because of the tiny tail)
+    std::vector<double> halfway{9007199254740992.0, 1.0, std::ldexp(1.0, -100)};
+    EXPECT_EQ(CPPY_BUILTINS_fsum(halfway.begin(), halfway.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, 9007199254740994.0);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> special{1.0, inf, 2.0};
+    EXPECT_EQ(CPPY_BUILTINS_fsum(special.begin(), special.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, inf);
+    special.push_back(-inf);
+    EXPECT_EQ(CPPY_BUILTINS_fsum(special.begin(), special.end(), &result), CPPY_ERROR_t::ValueError);
+    std::vector<double> overflow{1.7e308, 1.7e308};
+    EXPECT_EQ(CPPY_BUILTINS_fsum(overflow.begin(), overflow.end(), &result), CPPY_ERROR_t::OverflowError);
+}
+
 TEST(TEST_CPPY_BUILTINS, linspace)
 {
     {
@@ -209,6 +348,81 @@ TEST(TEST_CPPY_BUILTINS, linspace)
         EXPECT_NEAR(result[0], 0.0, 1.0e-16);
         EXPECT_NEAR(result[4], 0.8, 1.0e-16);
     }
+    {
+        double result[1];
+        EXPECT_EQ(CPPY_BUILTINS_linspace(0.0, 1.0, -1, result), CPPY_ERROR_t::ValueError);
+        CPPY_BUILTINS_linspace(2.0, 3.0, 1, result);
+        EXPECT_EQ(result[0], 2.0);
+    }
+    {
+        // every sample is start + i * step, with no drift, and the endpoint is exact
+        const int n = 1000003;
+        const double step = (0.7 - 0.1) / (n - 1);
+        std::vector<double> result(n), parallel(n);
+        CPPY_BUILTINS_linspace(0.1, 0.7, n, result.data());
+        for (int i = 0; i < n - 1; ++i)
+            ASSERT_EQ(result[i], 0.1 + i * step);
+        EXPECT_EQ(result[n - 1], 0.7);
+
+        CPPY_CONCURRENT_ThreadPoolExecutor executor(3);
+        CPPY_BUILTINS_linspace(&executor, 0.1, 0.7, n, parallel.data());
+        EXPECT_EQ(result, parallel);
+
+        CPPY_Linspace_view view;
+        CPPY_BUILTINS_linspace(0.1, 0.7, n, &view);
+        EXPECT_EQ(view.size(), static_cast<std::size_t>(n));
+        EXPECT_TRUE(std::equal(view.begin(), view.end(), result.begin()));
+        EXPECT_EQ(*std::lower_bound(view.begin(), view.end(), result[1234]), result[1234]);
+    }
+}
+
+TEST(TEST_CPPY_BUILTINS, arange)
+{
+    std::vector<double> result;
+    CPPY_BUILTINS_arange(3.0, 7.0, 1.5, &result);
+    EXPECT_EQ(result, (std::vector<double>{3.0, 4.5, 6.0}));
+    CPPY_BUILTINS_arange(1.0, 0.0, -0.25, &result);
+    EXPECT_EQ(result, (std::vector<double>{1.0, 0.75, 0.5, 0.25}));
+    CPPY_BUILTINS_arange(1.0, 0.0, 0.25, &result);
+    EXPECT_TRUE(result.empty());
+    EXPECT_EQ(CPPY_BUILTINS_arange(0.0, 1.0, 0.0, &result), CPPY_ERROR_t::ValueError);
+
+    CPPY_Linspace_view view;
+    CPPY_BUILTINS_arange(3.0, 7.0, 1.5, &view);
+    EXPECT_EQ(std::vector<double>(view.begin(), view.end()), (std::vector<double>{3.0, 4.5, 6.0}));
+}
+
+TEST(TEST_CPPY_BUILTINS, logspace)
+{
+    double result[4];
+    CPPY_BUILTINS_logspace(2.0, 3.0, 4, result);
+    EXPECT_NEAR(result[0], 100.0, 1.0e-12);
+    EXPECT_NEAR(result[1], 215.443469, 1.0e-6);
+    EXPECT_NEAR(result[2], 464.15888336, 1.0e-8);
+    EXPECT_NEAR(result[3], 1000.0, 1.0e-12);
+    CPPY_BUILTINS_logspace(0.0, 4.0, 4, result, false, 2.0);
+    EXPECT_EQ(result[3], 8.0);
+
+    CPPY_CONCURRENT_ThreadPoolExecutor executor(2);
+    double parallel[4];
+    CPPY_BUILTINS_logspace(&executor, 0.0, 4.0, 4, parallel, false, 2.0);
+    EXPECT_TRUE(std::equal(result, result + 4, parallel));
+}
+
+TEST(TEST_CPPY_BUILTINS, geomspace)
+{
+    double result[4];
+    CPPY_BUILTINS_geomspace(1.0, 1000.0, 4, result);
+    EXPECT_EQ(result[0], 1.0);
+    EXPECT_NEAR(result[1], 10.0, 1.0e-12);
+    EXPECT_NEAR(result[2], 100.0, 1.0e-12);
+    EXPECT_EQ(result[3], 1000.0);
+    CPPY_BUILTINS_geomspace(-1.0, -1000.0, 4, result);
+    EXPECT_EQ(result[0], -1.0);
+    EXPECT_NEAR(result[1], -10.0, 1.0e-12);
+    EXPECT_EQ(result[3], -1000.0);
+    EXPECT_EQ(CPPY_BUILTINS_geomspace(0.0, 10.0, 4, result), CPPY_ERROR_t::ValueError);
+    EXPECT_EQ(CPPY_BUILTINS_geomspace(-1.0, 10.0, 4, result), CPPY_ERROR_t::ValueError);
 }
 
 TEST(TEST_CPPY_BUILTINS, max_)
@@ -243,6 +457,165 @@ TEST(TEST_CPPY_BUILTINS, min_)
     }
 }
 
+TEST(TEST_CPPY_BUILTINS, nlargest_nsmallest)
+{
+    {
+        std::vector<int> data{5, 1, 8, 3, 9, 2, 8, 7};
+        std::vector<int> result;
+        EXPECT_EQ(CPPY_BUILTINS_nlargest(data.begin(), data.end(), 3, std::back_inserter(result)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<int>{9, 8, 8}));
+        result.clear();
+        EXPECT_EQ(CPPY_BUILTINS_nsmallest(data.begin(), data.end(), 2, std::back_inserter(result)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<int>{1, 2}));
+        result.clear();
+        EXPECT_EQ(CPPY_BUILTINS_nsmallest(data.begin(), data.end(), 0, std::back_inserter(result)), CPPY_ERROR_t::Ok);
+        EXPECT_TRUE(result.empty());
+        EXPECT_EQ(CPPY_BUILTINS_nlargest(data.begin(), data.end(), 20, std::back_inserter(result)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<int>{9, 8, 8, 7, 5, 3, 2, 1}));
+    }
+    {
+        // equal keys come out in input order, as with sorted(...)[:n]
+        std::list<std::string> data{"bb", "a", "cc", "dd", "e"};
+        auto len = [](const std::string& s) { return s.size(); };
+        std::vector<std::string> result;
+        EXPECT_EQ(CPPY_BUILTINS_nlargest(data.begin(), data.end(), 2, len, std::back_inserter(result)),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<std::string>{"bb", "cc"}));
+        result.clear();
+        EXPECT_EQ(CPPY_BUILTINS_nsmallest(data.begin(), data.end(), 3, len, std::back_inserter(result)),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<std::string>{"a", "e", "bb"}));
+    }
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+        std::vector<int> data(100000);
+        for (int i = 0; i < 100000; ++i)
+            data[i] = (i * 7919) % 100003;
+        std::vector<int> sorted = data;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> result;
+        EXPECT_EQ(CPPY_BUILTINS_nlargest(&pool, data.begin(), data.end(), 5, std::back_inserter(result)),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<int>(sorted.rbegin(), sorted.rbegin() + 5)));
+        result.clear();
+        EXPECT_EQ(CPPY_BUILTINS_nsmallest(&pool, data.begin(), data.end(), 5, std::back_inserter(result)),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result, (std::vector<int>(sorted.begin(), sorted.begin() + 5)));
+    }
+}
+
+TEST(TEST_CPPY_BUILTINS, reduce)
+{
+    const CPPY_REDUCE_t all = CPPY_REDUCE_t::All;
+    {
+        std::vector<int> data{3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5};
+        CPPY_Reduction<int> result;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.min, 1);
+        EXPECT_EQ(result.argmin, 1u);
+        EXPECT_EQ(result.max, 9);
+        EXPECT_EQ(result.argmax, 5u);
+        EXPECT_EQ(result.sum, 44);
+        EXPECT_DOUBLE_EQ(result.mean, 4.0);
+        EXPECT_EQ(result.count, 11u);
+
+        std::list<int> linked(data.begin(), data.end());
+        CPPY_Reduction<int> same;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(linked.begin(), linked.end(), all, &same), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(same.argmin, result.argmin);
+        EXPECT_EQ(same.argmax, result.argmax);
+        EXPECT_EQ(same.sum, result.sum);
+
+        data.clear();
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), CPPY_REDUCE_t::Sum, &result), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.sum, 0);
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), CPPY_REDUCE_t::Min, &result),
+                  CPPY_ERROR_t::ValueError);
+    }
+    {
+        // every length around the lane widths and block size, with ties for the first occurrence
+        for (int n : {1, 2, 7, 8, 15, 16, 17, 33, 100, 2047, 2048, 2049, 5000})
+        {
+            std::vector<int> ints(n);
+            std::vector<float> floats(n);
+            std::vector<double> doubles(n);
+            for (int i = 0; i < n; ++i)
+            {
+                ints[i] = (i * 7919) % 101 - 50;
+                floats[i] = static_cast<float>(ints[i]) * 0.5f;
+                doubles[i] = static_cast<double>(ints[i]) * 0.25;
+            }
+            CPPY_Reduction<int> ri;
+            CPPY_Reduction<float> rf;
+            CPPY_Reduction<double> rd;
+            ASSERT_EQ(CPPY_BUILTINS_reduce(ints.begin(), ints.end(), all, &ri), CPPY_ERROR_t::Ok);
+            ASSERT_EQ(CPPY_BUILTINS_reduce(floats.begin(), floats.end(), all, &rf, CPPY_SUM_t::Kahan),
+                      CPPY_ERROR_t::Ok);
+            ASSERT_EQ(CPPY_BUILTINS_reduce(doubles.begin(), doubles.end(), all, &rd, CPPY_SUM_t::Fast),
+                      CPPY_ERROR_t::Ok);
+            const auto expected_min = std::min_element(ints.begin(), ints.end()) - ints.begin();
+            const auto expected_max = std::max_element(ints.begin(), ints.end()) - ints.begin();
+            const long long expected_sum = std::accumulate(ints.begin(), ints.end(), 0LL);
+            EXPECT_EQ(ri.argmin, static_cast<std::size_t>(expected_min)) << n;
+            EXPECT_EQ(ri.argmax, static_cast<std::size_t>(expected_max)) << n;
+            EXPECT_EQ(rf.argmin, static_cast<std::size_t>(expected_min)) << n;
+            EXPECT_EQ(rf.argmax, static_cast<std::size_t>(expected_max)) << n;
+            EXPECT_EQ(rd.argmin, static_cast<std::size_t>(expected_min)) << n;
+            EXPECT_EQ(rd.argmax, static_cast<std::size_t>(expected_max)) << n;
+            EXPECT_EQ(ri.sum, expected_sum) << n;
+            EXPECT_EQ(rf.sum, expected_sum * 0.5) << n;
+            EXPECT_EQ(rd.sum, expected_sum * 0.25) << n;
+        }
+    }
+    {
+        // NaN is skipped unless it comes first, like min() and max()
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        std::vector<double> data(40, 1.0);
+        data[3] = nan;
+        data[20] = -2.0;
+        CPPY_Reduction<double> result;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.argmin, 20u);
+        EXPECT_EQ(result.argmax, 0u);
+        EXPECT_TRUE(std::isnan(result.sum));
+        data[0] = nan;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &result), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.argmin, 0u);
+        EXPECT_EQ(result.argmax, 0u);
+        double* found{nullptr};
+        CPPY_BUILTINS_min(data.data(), data.data() + data.size(), &found);
+        EXPECT_EQ(found, std::min_element(data.data(), data.data() + data.size()));
+    }
+    {
+        // 0.1 does not add up exactly; the compensated modes recover the rounded total
+        std::vector<double> data(1000000, 0.1);
+        CPPY_Reduction<double> result;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), CPPY_REDUCE_t::Sum, &result, CPPY_SUM_t::Exact),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.sum, 100000.0);
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), CPPY_REDUCE_t::Sum, &result, CPPY_SUM_t::Kahan),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(result.sum, 100000.0);
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), CPPY_REDUCE_t::Sum, &result), CPPY_ERROR_t::Ok);
+        EXPECT_NEAR(result.sum, 100000.0, 1e-9);
+    }
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+        std::vector<double> data(300000);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<double>((i * 7919) % 100003) * 0.1;
+        CPPY_Reduction<double> serial, parallel;
+        EXPECT_EQ(CPPY_BUILTINS_reduce(data.begin(), data.end(), all, &serial, CPPY_SUM_t::Exact), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_BUILTINS_reduce(&pool, data.begin(), data.end(), all, &parallel, CPPY_SUM_t::Exact),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(parallel.min, serial.min);
+        EXPECT_EQ(parallel.argmin, serial.argmin);
+        EXPECT_EQ(parallel.argmax, serial.argmax);
+        EXPECT_EQ(parallel.sum, serial.sum);
+        EXPECT_EQ(parallel.count, data.size());
+    }
+}
+
 TEST(TEST_CPPY_BUILTINS, reversed)
 {
     std::vector<int> vec{1, 2, 3, 4, 5};
@@ -318,6 +691,88 @@ TEST(TEST_CPPY_BUILTINS, slice)
     EXPECT_EQ((CPPY_BUILTINS_slice(data.begin(), data.end(), 0, 5, 1, raw_out)), CPPY_ERROR_t::Ok);
     EXPECT_EQ(raw_out[0], 0);
     EXPECT_EQ(raw_out[4], 4);
+    // into a container without a range insert
+    CPPY_IndexedList<int> indexed_out;
+    EXPECT_EQ((CPPY_BUILTINS_slice(data.begin(), data.end(), 1, 10, 1, std::back_inserter(indexed_out))),
+              CPPY_ERROR_t::Ok);
+    EXPECT_EQ((CPPY_BUILTINS_slice(data.begin(), data.end(), 9, 0, -3, std::back_inserter(indexed_out))),
+              CPPY_ERROR_t::Ok);
+    EXPECT_EQ(std::vector<int>(indexed_out.begin(), indexed_out.end()),
+              std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9, 9, 6, 3}));
+    // large trivial elements take several blocks of the stack buffer
+    struct Page
+    {
+        int values[1024];
+    };
+    std::vector<Page> pages(9);
+    for (int i = 0; i < 9; ++i)
+        pages[i].values[1023] = i;
+    std::vector<Page> page_out;
+    EXPECT_EQ((CPPY_BUILTINS_slice(pages.begin(), pages.end(), 8, -10, -2, std::back_inserter(page_out))),
+              CPPY_ERROR_t::Ok);
+    ASSERT_EQ(page_out.size(), 5u);
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ(page_out[i].values[1023], 8 - 2 * i);
+
+    // every container walks the same positions as indexing data[i] for each i in range()
+    std::list<int> list(data.begin(), data.end());
+    std::forward_list<int> forward(data.begin(), data.end());
+    const int bounds[] = {-12, -10, -3, -1, 0, 1, 4, 9, 10, 12};
+    for (int start : bounds)
+        for (int stop : bounds)
+            for (int step : {-4, -2, -1, 1, 2, 3, 11})
+            {
+                std::vector<int> expected;
+                int first = start < 0 ? start + 10 : start, last = stop < 0 ? stop + 10 : stop;
+                if (step > 0)
+                    for (int i = std::max(first, 0); i < std::min(last, 10); i += step)
+                        expected.push_back(data[i]);
+                else
+                    for (int i = std::min(first, 9); i > std::max(last, -1); i += step)
+                        expected.push_back(data[i]);
+
+                std::vector<int> from_vector, from_list, from_forward;
+                CPPY_BUILTINS_slice(data.begin(), data.end(), start, stop, step, std::back_inserter(from_vector));
+                CPPY_BUILTINS_slice(list.begin(), list.end(), start, stop, step, std::back_inserter(from_list));
+                CPPY_BUILTINS_slice(forward.begin(), forward.end(), start, stop, step, std::back_inserter(from_forward));
+                EXPECT_EQ(from_vector, expected);
+                EXPECT_EQ(from_list, expected);
+                EXPECT_EQ(from_forward, expected);
+
+                CPPY_Slice_view<std::vector<int>::iterator> view;
+                CPPY_BUILTINS_slice(data.begin(), data.end(), start, stop, step, &view);
+                EXPECT_EQ(std::vector<int>(view.begin(), view.end()), expected);
+                CPPY_Slice_view<std::list<int>::iterator> list_view;
+                CPPY_BUILTINS_slice(list.begin(), list.end(), start, stop, step, &list_view);
+                EXPECT_EQ(std::vector<int>(list_view.begin(), list_view.end()), expected);
+                EXPECT_TRUE(std::equal(expected.rbegin(), expected.rend(), std::make_reverse_iterator(list_view.end())));
+            }
+}
+
+TEST(TEST_CPPY_BUILTINS, slice_view)
+{
+    std::vector<int> data(100);
+    std::iota(data.begin(), data.end(), 0);
+    CPPY_Slice_view<std::vector<int>::iterator> view;
+    EXPECT_EQ(CPPY_BUILTINS_slice(data.begin(), data.end(), 90, 0, -3, &view), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(view.size(), 30u);
+    EXPECT_EQ(view[0], 90);
+    EXPECT_EQ(view[29], 3);
+    EXPECT_EQ(view.end() - view.begin(), 30);
+    EXPECT_EQ(*(view.end() - 1), 3);
+    EXPECT_EQ(*std::lower_bound(view.begin(), view.end(), 42, std::greater<int>()), 42);
+
+    // the view refers to the sequence, it does not copy it
+    view[1] = -1;
+    EXPECT_EQ(data[87], -1);
+
+    std::forward_list<int> forward(data.begin(), data.end());
+    CPPY_Slice_view<std::forward_list<int>::iterator> forward_view;
+    EXPECT_EQ(CPPY_BUILTINS_slice(forward.begin(), forward.end(), 0, 100, 25, &forward_view), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(std::vector<int>(forward_view.begin(), forward_view.end()), (std::vector<int>{0, 25, 50, 75}));
+    EXPECT_EQ(CPPY_BUILTINS_slice(forward.begin(), forward.end(), 0, 100, -1, &forward_view),
+              CPPY_ERROR_t::NotImplementedError);
+    EXPECT_EQ(CPPY_BUILTINS_slice(data.begin(), data.end(), 0, 100, 0, &view), CPPY_ERROR_t::ValueError);
 }
 
 TEST(TEST_CPPY_BUILTINS, sorted)
@@ -417,6 +872,211 @@ TEST(TEST_CPPY_EXPECT, expect)
     CPPY_EXPECT(false) << "this is false";
 }
 
+TEST(TEST_CPPY_FLAT_SET, add_remove)
+{
+    CPPY_FlatSet<int> a;
+    EXPECT_EQ(CPPY_SET_add(&a, 3), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_SET_add(&a, 1), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_SET_add(&a, 3), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.items, std::vector<int>({1, 3}));
+    EXPECT_EQ(CPPY_SET_remove(&a, 2), CPPY_ERROR_t::KeyError);
+    EXPECT_EQ(CPPY_SET_remove(&a, 1), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_SET_discard(&a, 1), CPPY_ERROR_t::Ok);
+    int element;
+    EXPECT_EQ(CPPY_SET_pop(&a, &element), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, 3);
+    EXPECT_EQ(CPPY_SET_pop(&a, &element), CPPY_ERROR_t::KeyError);
+}
+
+TEST(TEST_CPPY_FLAT_SET, init)
+{
+    std::vector<int> v{5, 1, 4, 1, 5, 9, 2, 6};
+    CPPY_FlatSet<int> a;
+    EXPECT_EQ(CPPY_SET_init(&a, v.begin(), v.end()), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.items, std::vector<int>({1, 2, 4, 5, 6, 9}));
+
+    bool result;
+    for (int x : v)
+    {
+        CPPY_SET_iscontain(a, x, &result);
+        EXPECT_TRUE(result);
+    }
+    for (int x : {0, 3, 7, 8, 10})
+    {
+        CPPY_SET_iscontain(a, x, &result);
+        EXPECT_FALSE(result);
+    }
+    CPPY_FlatSet<int> empty;
+    CPPY_SET_iscontain(empty, 1, &result);
+    EXPECT_FALSE(result);
+}
+
+TEST(TEST_CPPY_FLAT_SET, operations)
+{
+    std::vector<int> va{1, 2, 3, 4}, vb{3, 4, 5};
+    CPPY_FlatSet<int> a, b, result;
+    CPPY_SET_init(&a, va.begin(), va.end());
+    CPPY_SET_init(&b, vb.begin(), vb.end());
+
+    CPPY_SET_union(a.begin(), a.end(), b.begin(), b.end(), &result);
+    EXPECT_EQ(result.items, std::vector<int>({1, 2, 3, 4, 5}));
+    CPPY_SET_intersection(a.begin(), a.end(), b.begin(), b.end(), &result);
+    EXPECT_EQ(result.items, std::vector<int>({3, 4}));
+    CPPY_SET_difference(a.begin(), a.end(), b.begin(), b.end(), &result);
+    EXPECT_EQ(result.items, std::vector<int>({1, 2}));
+    CPPY_SET_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), &result);
+    EXPECT_EQ(result.items, std::vector<int>({1, 2, 5}));
+
+    std::vector<int> unsorted{5, 3, 5};
+    CPPY_SET_copy(a, &result);
+    CPPY_SET_difference_update(&result, unsorted.begin(), unsorted.end());
+    EXPECT_EQ(result.items, std::vector<int>({1, 2, 4}));
+    CPPY_SET_copy(a, &result);
+    CPPY_SET_intersection_update(&result, unsorted.begin(), unsorted.end());
+    EXPECT_EQ(result.items, std::vector<int>({3}));
+    CPPY_SET_copy(a, &result);
+    CPPY_SET_symmetric_difference_update(&result, unsorted.begin(), unsorted.end());
+    EXPECT_EQ(result.items, std::vector<int>({1, 2, 4, 5}));
+}
+
+TEST(TEST_CPPY_FLAT_SET, update)
+{
+    std::vector<int> va{1, 3, 5}, vb{6, 2, 3, 0, 2};
+    CPPY_FlatSet<int> a;
+    CPPY_SET_init(&a, va.begin(), va.end());
+    EXPECT_EQ(CPPY_SET_update(&a, vb.begin(), vb.end()), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.items, std::vector<int>({0, 1, 2, 3, 5, 6}));
+    EXPECT_EQ(CPPY_SET_clear(&a), CPPY_ERROR_t::Ok);
+    EXPECT_TRUE(a.empty());
+}
+
+TEST(TEST_CPPY_INDEXED_LIST, api)
+{
+    std::vector<int> v{3, 1, 2};
+    CPPY_IndexedList<int> a;
+    EXPECT_EQ(CPPY_LIST_init(&a, v.begin(), v.end()), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_append(&a, 2), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_insert(&a, 0, 9), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_insert(&a, -1, 8), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_insert(&a, 100, 7), CPPY_ERROR_t::Ok);
+    std::vector<int> expected{9, 3, 1, 2, 8, 2, 7};
+    bool equal;
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+
+    int count, index;
+    CPPY_LIST_count(a, 2, &count);
+    EXPECT_EQ(count, 2);
+    EXPECT_EQ(CPPY_LIST_index(a, 2, &index), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(index, 3);
+    EXPECT_EQ(CPPY_LIST_index(a, 2, &index, 4), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(index, 5);
+    EXPECT_EQ(CPPY_LIST_index(a, 5, &index), CPPY_ERROR_t::ValueError);
+    bool result;
+    CPPY_LIST_iscontain(a, 8, &result);
+    EXPECT_TRUE(result);
+
+    int element;
+    EXPECT_EQ(CPPY_LIST_pop(&a, &element), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, 7);
+    EXPECT_EQ(CPPY_LIST_pop(&a, &element, 1), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, 3);
+    EXPECT_EQ(CPPY_LIST_pop(&a, &element, 10), CPPY_ERROR_t::IndexError);
+    EXPECT_EQ(CPPY_LIST_remove(&a, 2), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_remove(&a, 42), CPPY_ERROR_t::ValueError);
+    expected = {9, 1, 8, 2};
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+
+    CPPY_LIST_reverse(&a);
+    expected = {2, 8, 1, 9};
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+    CPPY_LIST_sort(&a);
+    expected = {1, 2, 8, 9};
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+
+    CPPY_IndexedList<int> b;
+    CPPY_LIST_mul(a, 2, &b);
+    EXPECT_EQ(b.size(), 8);
+    CPPY_IndexedList<int> c;
+    CPPY_LIST_copy(b, &c);
+    CPPY_LIST_isequal(c, b.begin(), b.end(), &equal);
+    EXPECT_TRUE(equal);
+    CPPY_LIST_clear(&c);
+    EXPECT_TRUE(c.empty());
+}
+
+TEST(TEST_CPPY_INDEXED_LIST, self_extend)
+{
+    // l.extend(l) copies l once, though l grows as it is read
+    for (int n : {6, 1000})
+    {
+        CPPY_IndexedList<int> il;
+        std::vector<int> expected;
+        for (int i = 0; i < n; ++i)
+        {
+            il.push_back(i);
+            expected.push_back(i);
+        }
+        EXPECT_EQ(CPPY_LIST_extend(&il, il.begin(), il.end()), CPPY_ERROR_t::Ok);
+        expected.insert(expected.end(), expected.begin(), expected.begin() + n);
+        EXPECT_EQ(std::vector<int>(il.begin(), il.end()), expected);
+    }
+
+    // and CPPY_LIST_mul(x, n, &x) appends n copies of x as it was
+    CPPY_IndexedList<int> x;
+    for (int i = 1; i <= 3; ++i)
+        x.push_back(i);
+    EXPECT_EQ(CPPY_LIST_mul(x, 2, &x), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(std::vector<int>(x.begin(), x.end()), std::vector<int>({1, 2, 3, 1, 2, 3, 1, 2, 3}));
+
+    std::list<int> other{7, 8};
+    CPPY_LIST_extend(&x, other.begin(), other.end());
+    EXPECT_EQ(x.size(), 11u);
+    EXPECT_EQ(x[10], 8);
+}
+
+TEST(TEST_CPPY_INDEXED_LIST, random_positions)
+{
+    // mirror random inserts and pops on std::vector across many block splits and merges
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 7);
+    CPPY_IndexedList<int> a;
+    std::vector<int> expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        int op = 0, position = 0;
+        CPPY_RANDOM_randint(&random, 0, 2, &op);
+        CPPY_RANDOM_randint(&random, 0, static_cast<int>(expected.size()), &position);
+        if (op < 2 || expected.empty())
+        {
+            CPPY_LIST_insert(&a, position, i);
+            expected.insert(expected.begin() + std::min<int>(position, static_cast<int>(expected.size())), i);
+        }
+        else
+        {
+            position = std::min<int>(position, static_cast<int>(expected.size()) - 1);
+            int element;
+            CPPY_LIST_pop(&a, &element, position);
+            EXPECT_EQ(element, expected[position]);
+            expected.erase(expected.begin() + position);
+        }
+    }
+    ASSERT_EQ(a.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); i += 97)
+        EXPECT_EQ(a[i], expected[i]);
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+    EXPECT_EQ(a.end() - a.begin(), static_cast<std::ptrdiff_t>(expected.size()));
+    EXPECT_EQ(*(a.begin() + 1234), expected[1234]);
+    EXPECT_EQ(*(a.end() - 1), expected.back());
+
+    int element;
+    EXPECT_EQ(CPPY_Sequence_at(a, 4321, &element), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, expected[4321]);
+}
+
 TEST(TEST_CPPY_INT, bit_count)
 {
     {
@@ -595,6 +1255,102 @@ TEST(TEST_CPPY_LIST, clear)
     }
 }
 
+TEST(TEST_CPPY_LIST, contiguous)
+{
+    CPPY_List<std::string> a;
+    std::string word = "b";
+    EXPECT_EQ(CPPY_LIST_append(&a, word), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_append(&a, std::string("c")), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_insert(&a, 0, std::string("a")), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_LIST_insert(&a, -1, word), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(word, "b");
+    std::vector<std::string> expected{"a", "b", "b", "c"};
+    bool equal;
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+
+    int count, index;
+    CPPY_LIST_count(a, word, &count);
+    EXPECT_EQ(count, 2);
+    CPPY_LIST_index(a, std::string("c"), &index);
+    EXPECT_EQ(index, 3);
+
+    CPPY_List<std::string> b{"x", "y"};
+    EXPECT_EQ(CPPY_LIST_extend(&a, std::move(b)), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.size(), 6);
+    EXPECT_TRUE(b.empty());
+
+    std::string element;
+    EXPECT_EQ(CPPY_LIST_pop(&a, &element, 0), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, "a");
+    EXPECT_EQ(CPPY_LIST_remove(&a, std::string("x")), CPPY_ERROR_t::Ok);
+    CPPY_LIST_reverse(&a);
+    expected = {"y", "c", "b", "b"};
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+    CPPY_LIST_sort(&a);
+    expected = {"b", "b", "c", "y"};
+    CPPY_LIST_isequal(a, expected.begin(), expected.end(), &equal);
+    EXPECT_TRUE(equal);
+
+    CPPY_List<std::string> c;
+    CPPY_LIST_mul(a, 3, &c);
+    EXPECT_EQ(c.size(), 12);
+    bool result;
+    CPPY_LIST_iscontain(c, std::string("y"), &result);
+    EXPECT_TRUE(result);
+}
+
+TEST(TEST_CPPY_LIST, contiguous_growth)
+{
+    // capacities follow CPython's list_resize(): 4, 8, 16, 24, 32, 40, 52, 64, 76, ...
+    CPPY_List<int> a;
+    std::vector<std::size_t> capacities;
+    for (int i = 0; i < 80; ++i)
+    {
+        CPPY_LIST_append(&a, i);
+        if (capacities.empty() || capacities.back() != a.capacity())
+            capacities.push_back(a.capacity());
+    }
+    EXPECT_EQ(capacities, std::vector<std::size_t>({4, 8, 16, 24, 32, 40, 52, 64, 76, 92}));
+
+    std::vector<int> v(1000);
+    CPPY_List<int> b;
+    CPPY_LIST_extend(&b, v.begin(), v.end());
+    EXPECT_EQ(b.capacity(), 1000);
+}
+
+TEST(TEST_CPPY_LIST, contiguous_aliasing)
+{
+    // appending an element of the list itself when the append reallocates
+    CPPY_List<long> a{1, 2, 3, 4};
+    ASSERT_EQ(a.size(), a.capacity());
+    EXPECT_EQ(CPPY_LIST_append(&a, a[0]), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a[4], 1);
+
+    CPPY_List<std::string> b{"first", "second"};
+    while (b.size() < b.capacity())
+        CPPY_LIST_append(&b, std::string("filler"));
+    CPPY_LIST_append(&b, b[0]);
+    EXPECT_EQ(b.back(), "first");
+    while (b.size() < b.capacity())
+        CPPY_LIST_append(&b, std::string("filler"));
+    CPPY_LIST_emplace_back(&b, b[1]);
+    EXPECT_EQ(b.back(), "second");
+
+    // and inserting one
+    while (b.size() < b.capacity())
+        CPPY_LIST_append(&b, std::string("filler"));
+    EXPECT_EQ(CPPY_LIST_insert(&b, 0, b[1]), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(b[0], "second");
+    EXPECT_EQ(b[1], "first");
+    while (b.size() < b.capacity())
+        CPPY_LIST_append(&b, std::string("filler"));
+    EXPECT_EQ(CPPY_LIST_emplace(&b, 1, b[2]), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(b[1], "second");
+    EXPECT_EQ(b[2], "first");
+}
+
 TEST(TEST_CPPY_LIST, copy)
 {
     std::list<int> data = {1, 2, 3, 4, 5};
@@ -911,6 +1667,37 @@ TEST(TEST_CPPY_PLATFORM, os_info)
     EXPECT_FALSE(result.empty());
 }
 
+TEST(TEST_CPPY_PLATFORM, numa_nodes)
+{
+    std::vector<CPPY_PLATFORM_NumaNode> nodes;
+    EXPECT_EQ(CPPY_PLATFORM_numa_nodes(&nodes), CPPY_ERROR_t::Ok);
+    ASSERT_FALSE(nodes.empty());
+    std::vector<int> cpus;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        EXPECT_FALSE(nodes[i].cpus.empty());
+        if (i > 0)
+        {
+            EXPECT_LT(nodes[i - 1].id, nodes[i].id);
+        }
+        cpus.insert(cpus.end(), nodes[i].cpus.begin(), nodes[i].cpus.end());
+    }
+    std::sort(cpus.begin(), cpus.end());
+    EXPECT_EQ(std::adjacent_find(cpus.begin(), cpus.end()), cpus.end());
+
+    int cpu = -1;
+    EXPECT_EQ(CPPY_PLATFORM_current_cpu(&cpu), CPPY_ERROR_t::Ok);
+    EXPECT_GE(cpu, 0);
+    EXPECT_EQ(CPPY_PLATFORM_set_affinity({}), CPPY_ERROR_t::ValueError);
+    std::thread pinned([&]() {
+        EXPECT_EQ(CPPY_PLATFORM_set_affinity({cpus.back()}), CPPY_ERROR_t::Ok);
+        int now = -1;
+        CPPY_PLATFORM_current_cpu(&now);
+        EXPECT_EQ(now, cpus.back());
+    });
+    pinned.join();
+}
+
 TEST(TEST_CPPY_RANDOM, choice)
 {
     CPPY_Random random;
@@ -1041,6 +1828,296 @@ TEST(TEST_CPPY_RANDOM, seed)
     EXPECT_EQ(x1, x2);
 }
 
+TEST(TEST_CPPY_ROARING, add)
+{
+    {
+        CPPY_RoaringBitmap a;
+        EXPECT_EQ(CPPY_SET_add(&a, 1), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_SET_add(&a, 1), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_SET_add(&a, 70000), CPPY_ERROR_t::Ok);
+        std::size_t len;
+        CPPY_SET_len(a, &len);
+        EXPECT_EQ(len, 2);
+        EXPECT_EQ(a.containers.size(), 2);
+    }
+    {
+        // an array container turns into a bitmap once it holds more than 4096 values
+        CPPY_RoaringBitmap a;
+        for (uint32_t i = 0; i < 5000; ++i)
+            CPPY_SET_add(&a, i * 2);
+        std::size_t len;
+        CPPY_SET_len(a, &len);
+        EXPECT_EQ(len, 5000);
+        EXPECT_EQ(a.containers[0].type, CPPY_ROARING_container_t::Bitmap);
+        bool result;
+        CPPY_SET_iscontain(a, 9998, &result);
+        EXPECT_TRUE(result);
+        CPPY_SET_iscontain(a, 9999, &result);
+        EXPECT_FALSE(result);
+    }
+}
+
+TEST(TEST_CPPY_ROARING, init)
+{
+    std::vector<uint32_t> v{5, 3, 1, 3, 1u << 20, 5};
+    CPPY_RoaringBitmap a;
+    EXPECT_EQ(CPPY_SET_init(&a, v.begin(), v.end()), CPPY_ERROR_t::Ok);
+    std::vector<uint32_t> result;
+    CPPY_ROARING_tolist(a, &result);
+    EXPECT_EQ(result, std::vector<uint32_t>({1, 3, 5, 1u << 20}));
+}
+
+TEST(TEST_CPPY_ROARING, operations)
+{
+    std::set<uint32_t> sa, sb;
+    for (uint32_t i = 0; i < 200000; i += 3)
+        sa.insert(i);
+    for (uint32_t i = 0; i < 200000; i += 7)
+        sb.insert(i);
+    for (uint32_t i = 300000; i < 300010; ++i)
+        sb.insert(i);
+
+    CPPY_RoaringBitmap a, b, result;
+    CPPY_SET_init(&a, sa.begin(), sa.end());
+    CPPY_SET_init(&b, sb.begin(), sb.end());
+    std::vector<uint32_t> values, expected;
+
+    CPPY_SET_union(a, b, &result);
+    CPPY_ROARING_tolist(result, &values);
+    std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    EXPECT_EQ(values, expected);
+
+    expected.clear();
+    CPPY_SET_intersection(a, b, &result);
+    CPPY_ROARING_tolist(result, &values);
+    std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    EXPECT_EQ(values, expected);
+
+    expected.clear();
+    CPPY_SET_difference(a, b, &result);
+    CPPY_ROARING_tolist(result, &values);
+    std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    EXPECT_EQ(values, expected);
+
+    expected.clear();
+    CPPY_SET_symmetric_difference(a, b, &result);
+    CPPY_ROARING_tolist(result, &values);
+    std::set_symmetric_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    EXPECT_EQ(values, expected);
+
+    CPPY_RoaringBitmap c;
+    CPPY_SET_copy(a, &c);
+    CPPY_SET_intersection_update(&c, b);
+    CPPY_SET_difference_update(&c, b);
+    std::size_t len;
+    CPPY_SET_len(c, &len);
+    EXPECT_EQ(len, 0);
+
+    CPPY_SET_update(&c, a);
+    CPPY_SET_symmetric_difference_update(&c, b);
+    CPPY_ROARING_tolist(c, &values);
+    EXPECT_EQ(values, expected);
+
+    bool is;
+    CPPY_SET_intersection(a, b, &result);
+    CPPY_SET_issubset(result, a, &is);
+    EXPECT_TRUE(is);
+    CPPY_SET_issuperset(b, result, &is);
+    EXPECT_TRUE(is);
+    CPPY_SET_issubset(a, b, &is);
+    EXPECT_FALSE(is);
+    CPPY_SET_isdisjoint(a, b, &is);
+    EXPECT_FALSE(is);
+    CPPY_SET_difference(a, b, &result);
+    CPPY_SET_isdisjoint(result, b, &is);
+    EXPECT_TRUE(is);
+    CPPY_SET_isequal(a, a, &is);
+    EXPECT_TRUE(is);
+    CPPY_SET_isequal(a, b, &is);
+    EXPECT_FALSE(is);
+}
+
+TEST(TEST_CPPY_ROARING, update)
+{
+    // keys only in a, only in b and in both, with array, bitmap and run containers
+    std::set<uint32_t> sa, sb;
+    for (uint32_t key : {0u, 2u, 3u, 5u, 8u})
+        for (uint32_t i = 0; i < (key == 3 ? 6000u : 300u); ++i)
+            sa.insert((key << 16) + i * 5);
+    for (uint32_t key : {1u, 2u, 3u, 6u, 8u, 9u})
+        for (uint32_t i = 0; i < (key == 2 ? 5000u : 400u); ++i)
+            sb.insert((key << 16) + i * (key == 8 ? 5 : 3));
+    for (uint32_t i = 0; i < 1000; ++i)
+        sb.insert((5u << 16) + 20000 + i);
+    CPPY_RoaringBitmap b;
+    CPPY_SET_init(&b, sb.begin(), sb.end());
+    CPPY_ROARING_run_optimize(&b);
+
+    using Update = CPPY_ERROR_t (*)(CPPY_RoaringBitmap* const, const CPPY_RoaringBitmap&);
+    const Update updates[] = {&CPPY_SET_update, &CPPY_SET_intersection_update, &CPPY_SET_difference_update,
+                              &CPPY_SET_symmetric_difference_update};
+    for (int op = 0; op < 4; ++op)
+    {
+        std::vector<uint32_t> values, expected;
+        auto out = std::back_inserter(expected);
+        switch (op)
+        {
+        case 0:
+            std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), out);
+            break;
+        case 1:
+            std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), out);
+            break;
+        case 2:
+            std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), out);
+            break;
+        default:
+            std::set_symmetric_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), out);
+            break;
+        }
+        CPPY_RoaringBitmap a;
+        CPPY_SET_init(&a, sa.begin(), sa.end());
+        EXPECT_EQ(updates[op](&a, b), CPPY_ERROR_t::Ok);
+        CPPY_ROARING_tolist(a, &values);
+        EXPECT_EQ(values, expected);
+        for (std::size_t i = 1; i < a.containers.size(); ++i)
+            EXPECT_LT(a.containers[i - 1].key, a.containers[i].key);
+
+        // with itself
+        CPPY_SET_init(&a, sa.begin(), sa.end());
+        updates[op](&a, a);
+        CPPY_ROARING_tolist(a, &values);
+        EXPECT_EQ(values.size(), op < 2 ? sa.size() : 0);
+    }
+}
+
+TEST(TEST_CPPY_ROARING, pop_remove_discard)
+{
+    CPPY_RoaringBitmap a;
+    std::vector<uint32_t> v{7, 3, 100000};
+    CPPY_SET_init(&a, v.begin(), v.end());
+    uint32_t element;
+    EXPECT_EQ(CPPY_SET_pop(&a, &element), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, 3);
+    EXPECT_EQ(CPPY_SET_remove(&a, 3), CPPY_ERROR_t::KeyError);
+    EXPECT_EQ(CPPY_SET_remove(&a, 100000), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.containers.size(), 1);
+    EXPECT_EQ(CPPY_SET_discard(&a, 100000), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(CPPY_SET_pop(&a, &element), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(element, 7);
+    EXPECT_EQ(CPPY_SET_pop(&a, &element), CPPY_ERROR_t::KeyError);
+}
+
+TEST(TEST_CPPY_ROARING, run_optimize)
+{
+    CPPY_RoaringBitmap a;
+    for (uint32_t i = 1000; i < 60000; ++i)
+        CPPY_SET_add(&a, i);
+    EXPECT_EQ(CPPY_ROARING_run_optimize(&a), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(a.containers[0].type, CPPY_ROARING_container_t::Run);
+    bool result;
+    CPPY_SET_iscontain(a, 999, &result);
+    EXPECT_FALSE(result);
+    CPPY_SET_iscontain(a, 1000, &result);
+    EXPECT_TRUE(result);
+    CPPY_SET_iscontain(a, 59999, &result);
+    EXPECT_TRUE(result);
+    CPPY_SET_iscontain(a, 60000, &result);
+    EXPECT_FALSE(result);
+
+    CPPY_SET_add(&a, 70);
+    std::size_t len;
+    CPPY_SET_len(a, &len);
+    EXPECT_EQ(len, 59001);
+}
+
+TEST(TEST_CPPY_ROARING, serialize)
+{
+    CPPY_RoaringBitmap a;
+    for (uint32_t i = 0; i < 10; ++i)
+        CPPY_SET_add(&a, i * 3);
+    for (uint32_t i = 0; i < 10000; ++i)
+        CPPY_SET_add(&a, (1u << 16) + i * 2);
+    for (uint32_t i = 0; i < 5000; ++i)
+        CPPY_SET_add(&a, (5u << 16) + i);
+    CPPY_ROARING_run_optimize(&a);
+
+    std::vector<char> buffer;
+    EXPECT_EQ(CPPY_ROARING_serialize(a, &buffer), CPPY_ERROR_t::Ok);
+
+    CPPY_RoaringBitmap b;
+    EXPECT_EQ(CPPY_ROARING_deserialize(buffer.data(), buffer.size(), &b), CPPY_ERROR_t::Ok);
+    bool equal;
+    CPPY_SET_isequal(a, b, &equal);
+    EXPECT_TRUE(equal);
+
+    CPPY_RoaringBitmap_view view;
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, buffer.data(), buffer.size()), CPPY_ERROR_t::Ok);
+    std::size_t len;
+    CPPY_SET_len(view, &len);
+    EXPECT_EQ(len, 15010);
+    bool result;
+    CPPY_SET_iscontain(view, 27, &result);
+    EXPECT_TRUE(result);
+    CPPY_SET_iscontain(view, 28, &result);
+    EXPECT_FALSE(result);
+    CPPY_SET_iscontain(view, (1u << 16) + 19998, &result);
+    EXPECT_TRUE(result);
+    CPPY_SET_iscontain(view, (5u << 16) + 4999, &result);
+    EXPECT_TRUE(result);
+    CPPY_SET_iscontain(view, (5u << 16) + 5000, &result);
+    EXPECT_FALSE(result);
+
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, buffer.data(), buffer.size() - 1), CPPY_ERROR_t::ValueError);
+    EXPECT_EQ(CPPY_ROARING_deserialize(buffer.data(), 8, &b), CPPY_ERROR_t::ValueError);
+
+    // payloads that disagree with their descriptors: a bitmap (container 1) missing a value,
+    //  and a run (container 2, the single run 0..4999) made longer or past 0xFFFF
+    ASSERT_EQ(a.containers[1].type, CPPY_ROARING_container_t::Bitmap);
+    ASSERT_EQ(a.containers[2].type, CPPY_ROARING_container_t::Run);
+    const auto payload = [&buffer](uint32_t i) {
+        uint32_t offset;
+        std::memcpy(&offset, buffer.data() + 16 + i * 16 + 8, sizeof(offset));
+        return offset;
+    };
+    std::vector<char> corrupt = buffer;
+    corrupt[payload(1)] ^= 1;
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+    EXPECT_EQ(CPPY_ROARING_deserialize(corrupt.data(), corrupt.size(), &b), CPPY_ERROR_t::ValueError);
+    corrupt = buffer;
+    corrupt[payload(2) + 2] += 1;
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+    corrupt = buffer;
+    corrupt[payload(2) + 1] = static_cast<char>(0xF0);
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+
+    // an array (container 0: 0, 3, ..., 27) out of order or with a duplicate
+    ASSERT_EQ(a.containers[0].type, CPPY_ROARING_container_t::Array);
+    corrupt = buffer;
+    corrupt[payload(0) + 2] = 0;
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+    EXPECT_EQ(CPPY_ROARING_deserialize(corrupt.data(), corrupt.size(), &b), CPPY_ERROR_t::ValueError);
+    corrupt = buffer;
+    std::swap(corrupt[payload(0) + 2], corrupt[payload(0) + 4]);
+    EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+
+    // empty containers: an array, a bitmap of zero words and a run container without runs
+    const auto set_field = [](std::vector<char>* bytes, uint32_t i, std::size_t field, uint32_t value) {
+        std::memcpy(bytes->data() + 16 + i * 16 + field, &value, sizeof(value));
+    };
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        corrupt = buffer;
+        set_field(&corrupt, i, 4, 0);
+        if (i == 1)
+            std::fill(corrupt.begin() + payload(1), corrupt.begin() + payload(1) + 8192, 0);
+        else
+            set_field(&corrupt, i, 12, 0);
+        EXPECT_EQ(CPPY_ROARING_view_init(&view, corrupt.data(), corrupt.size()), CPPY_ERROR_t::ValueError);
+        EXPECT_EQ(CPPY_ROARING_deserialize(corrupt.data(), corrupt.size(), &b), CPPY_ERROR_t::ValueError);
+    }
+}
+
 TEST(TEST_CPPY_SET, _union)
 {
     {
@@ -1368,6 +2445,47 @@ TEST(TEST_CPPY_SET, iterator)
     }
 }
 
+TEST(TEST_CPPY_SET, parallel)
+{
+    std::set<int> a, b;
+    for (int i = 0; i < 200000; i += 2)
+        a.insert(i);
+    for (int i = 0; i < 150000; i += 3)
+        b.insert(i);
+    for (int i = 500000; i < 500100; ++i)
+        b.insert(i);
+
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(4));
+    std::set<int> serial, parallel;
+
+    CPPY_SET_union(a.begin(), a.end(), b.begin(), b.end(), &serial);
+    EXPECT_EQ(CPPY_SET_union(&pool, a.begin(), a.end(), b.begin(), b.end(), &parallel), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(serial, parallel);
+
+    CPPY_SET_intersection(a.begin(), a.end(), b.begin(), b.end(), &serial);
+    EXPECT_EQ(CPPY_SET_intersection(&pool, a.begin(), a.end(), b.begin(), b.end(), &parallel), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(serial, parallel);
+
+    CPPY_SET_difference(b.begin(), b.end(), a.begin(), a.end(), &serial);
+    EXPECT_EQ(CPPY_SET_difference(&pool, b.begin(), b.end(), a.begin(), a.end(), &parallel), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(serial, parallel);
+
+    CPPY_SET_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), &serial);
+    EXPECT_EQ(CPPY_SET_symmetric_difference(&pool, a.begin(), a.end(), b.begin(), b.end(), &parallel),
+              CPPY_ERROR_t::Ok);
+    EXPECT_EQ(serial, parallel);
+
+    std::vector<int> va(a.begin(), a.end()), vb(b.begin(), b.end());
+    CPPY_FlatSet<int> flat;
+    CPPY_SET_union(&pool, va.begin(), va.end(), vb.begin(), vb.end(), &flat);
+    CPPY_SET_union(a.begin(), a.end(), b.begin(), b.end(), &serial);
+    EXPECT_TRUE(std::equal(flat.begin(), flat.end(), serial.begin(), serial.end()));
+
+    std::set<int> empty;
+    CPPY_SET_union(&pool, empty.begin(), empty.end(), empty.begin(), empty.end(), &parallel);
+    EXPECT_TRUE(parallel.empty());
+}
+
 TEST(TEST_CPPY_SET, pop)
 {
     {
@@ -1466,6 +2584,47 @@ TEST(TEST_CPPY_SET, update)
     }
 }
 
+TEST(TEST_CPPY_STATISTICS, median)
+{
+    std::vector<int> odd{7, 1, 3, 5, 9};
+    std::vector<int> even{4, 1, 3, 2};
+    double result;
+    EXPECT_EQ(CPPY_STATISTICS_median(odd.begin(), odd.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, 5.0);
+    EXPECT_EQ(CPPY_STATISTICS_median(even.begin(), even.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, 2.5);
+    int low, high;
+    EXPECT_EQ(CPPY_STATISTICS_median_low(even.begin(), even.end(), &low), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(low, 2);
+    EXPECT_EQ(CPPY_STATISTICS_median_high(even.begin(), even.end(), &high), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(high, 3);
+    std::vector<int> empty;
+    EXPECT_EQ(CPPY_STATISTICS_median(empty.begin(), empty.end(), &result), CPPY_ERROR_t::ValueError);
+}
+
+TEST(TEST_CPPY_STATISTICS, quantiles)
+{
+    // >>> quantiles([105, 129, 87, 86, 111, 111, 89, 81, 108, 92, 110, 100, 75, 105, 103, 109, 76, 119, 99, 91, 103,
+    // 129, 106, 101, 84, 111, 74, 87, 86, 103, 103, 106, 86, 111, 75, 87, 102, 121, 111, 88, 89, 101, 106, 95, 103,
+    // 107, 101, 81, 109, 104], n=10)
+    std::vector<int> data{105, 129, 87,  86,  111, 111, 89,  81,  108, 92,  110, 100, 75,  105, 103, 109, 76,
+                          119, 99,  91,  103, 129, 106, 101, 84,  111, 74,  87,  86,  103, 103, 106, 86,  111,
+                          75,  87,  102, 121, 111, 88,  89,  101, 106, 95,  103, 107, 101, 81,  109, 104};
+    std::vector<double> result;
+    EXPECT_EQ(CPPY_STATISTICS_quantiles(data.begin(), data.end(), &result, 10), CPPY_ERROR_t::Ok);
+    const std::vector<double> expected{81.0, 86.2, 89.0, 99.4, 102.5, 103.6, 106.0, 109.8, 111.0};
+    ASSERT_EQ(result.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_NEAR(result[i], expected[i], 1e-9);
+
+    std::vector<int> small{1, 2, 3, 4};
+    EXPECT_EQ(CPPY_STATISTICS_quantiles(small.begin(), small.end(), &result, 4, true), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, (std::vector<double>{1.75, 2.5, 3.25}));
+    EXPECT_EQ(CPPY_STATISTICS_quantiles(small.begin(), small.end(), &result), CPPY_ERROR_t::Ok);
+    EXPECT_EQ(result, (std::vector<double>{1.25, 2.5, 3.75}));
+    EXPECT_EQ(CPPY_STATISTICS_quantiles(small.begin(), small.end(), &result, 0), CPPY_ERROR_t::ValueError);
+}
+
 TEST(TEST_CPPY_STR, at)
 {
     std::string s = "123";
@@ -2134,6 +3293,48 @@ TEST(TEST_CPPY_VECTOR, extend)
     EXPECT_EQ(this_vector[5], 6);
 }
 
+TEST(TEST_CPPY_VECTOR, extend_planned)
+{
+    {
+        std::vector<int> this_vector{1, 2, 3};
+        EXPECT_EQ(CPPY_VECTOR_extend(&this_vector, this_vector.begin(), this_vector.end()), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, (std::vector<int>{1, 2, 3, 1, 2, 3}));
+    }
+    {
+        std::istringstream stream("4 5 6 7");
+        std::vector<int> this_vector;
+        EXPECT_EQ(CPPY_VECTOR_extend(
+                      &this_vector, std::istream_iterator<int>(stream), std::istream_iterator<int>(), 100),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, (std::vector<int>{4, 5, 6, 7}));
+        EXPECT_GE(this_vector.capacity(), 100);
+    }
+    {
+        std::vector<std::string> this_vector{"a"};
+        std::list<std::string> first{"b", "c"};
+        std::string second[] = {"d"};
+        EXPECT_EQ(CPPY_VECTOR_extend_many(&this_vector, first, second), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, (std::vector<std::string>{"a", "b", "c", "d"}));
+    }
+    {
+        std::vector<int> this_vector{1};
+        EXPECT_EQ(CPPY_VECTOR_reserve(&this_vector, 50), CPPY_ERROR_t::Ok);
+        const int* data = this_vector.data();
+        std::vector<int> other(50, 7);
+        EXPECT_EQ(CPPY_VECTOR_extend(&this_vector, other.begin(), other.end()), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector.data(), data);
+        EXPECT_EQ(this_vector.size(), 51);
+    }
+    {
+        CPPY_List<int> this_list;
+        std::istringstream stream("1 2 3");
+        EXPECT_EQ(CPPY_LIST_init(&this_list, std::istream_iterator<int>(stream), std::istream_iterator<int>(), 40),
+                  CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_list.size(), 3);
+        EXPECT_GE(this_list.capacity(), 40);
+    }
+}
+
 TEST(TEST_CPPY_VECTOR, index)
 {
     {
@@ -2294,6 +3495,106 @@ TEST(TEST_CPPY_VECTOR, mul)
     }
 }
 
+struct CopyCounter
+{
+    static int copies;
+    int value = 0;
+
+    CopyCounter() = default;
+    CopyCounter(int value) : value(value) {}
+    CopyCounter(const CopyCounter& other) : value(other.value) { ++copies; }
+    CopyCounter(CopyCounter&& other) noexcept : value(other.value) {}
+    CopyCounter& operator=(const CopyCounter& other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    CopyCounter& operator=(CopyCounter&& other) noexcept
+    {
+        value = other.value;
+        return *this;
+    }
+    bool operator<(const CopyCounter& other) const { return value < other.value; }
+    bool operator==(const CopyCounter& other) const { return value == other.value; }
+};
+int CopyCounter::copies = 0;
+
+TEST(TEST_CPPY_VECTOR, move)
+{
+    CopyCounter::copies = 0;
+    {
+        std::vector<CopyCounter> data;
+        EXPECT_EQ(CPPY_VECTOR_append(&data, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_VECTOR_emplace_back(&data, 2), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_VECTOR_insert(&data, 0, CopyCounter(0)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_VECTOR_emplace(&data, -1, 5), CPPY_ERROR_t::Ok);
+        std::vector<CopyCounter> other;
+        other.emplace_back(3);
+        other.emplace_back(4);
+        EXPECT_EQ(CPPY_VECTOR_extend(&data, std::move(other)), CPPY_ERROR_t::Ok);
+        EXPECT_TRUE(other.empty());
+        EXPECT_EQ(data.size(), 6);
+        EXPECT_EQ(data[2].value, 5);
+        CopyCounter element;
+        EXPECT_EQ(CPPY_VECTOR_pop(&data, &element), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 4);
+        EXPECT_EQ(CPPY_VECTOR_pop(&data, &element, 0), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 0);
+    }
+    {
+        std::list<CopyCounter> data;
+        EXPECT_EQ(CPPY_LIST_append(&data, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_emplace_back(&data, 2), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_insert(&data, 0, CopyCounter(0)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_emplace(&data, 1, 5), CPPY_ERROR_t::Ok);
+        std::list<CopyCounter> other;
+        other.emplace_back(3);
+        EXPECT_EQ(CPPY_LIST_extend(&data, std::move(other)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(data.size(), 5);
+        CopyCounter element;
+        EXPECT_EQ(CPPY_LIST_pop(&data, &element, 1), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 5);
+    }
+    {
+        CPPY_List<CopyCounter> data;
+        EXPECT_EQ(CPPY_LIST_append(&data, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_emplace_back(&data, 2), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_emplace(&data, 0, 0), CPPY_ERROR_t::Ok);
+        CopyCounter element;
+        EXPECT_EQ(CPPY_LIST_pop(&data, &element, 0), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 0);
+    }
+    {
+        CPPY_IndexedList<CopyCounter> data;
+        EXPECT_EQ(CPPY_LIST_append(&data, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_emplace_back(&data, 2), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_LIST_insert(&data, 1, CopyCounter(5)), CPPY_ERROR_t::Ok);
+        CopyCounter element;
+        EXPECT_EQ(CPPY_LIST_pop(&data, &element, 1), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 5);
+    }
+    {
+        std::set<CopyCounter> data;
+        EXPECT_EQ(CPPY_SET_add(&data, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_SET_emplace(&data, 2), CPPY_ERROR_t::Ok);
+        std::set<CopyCounter> other;
+        other.emplace(3);
+        EXPECT_EQ(CPPY_SET_update(&data, std::move(other)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(data.size(), 3);
+        CopyCounter element;
+        EXPECT_EQ(CPPY_SET_pop(&data, &element), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 1);
+
+        CPPY_FlatSet<CopyCounter> flat;
+        EXPECT_EQ(CPPY_SET_add(&flat, CopyCounter(2)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_SET_add(&flat, CopyCounter(1)), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(CPPY_SET_pop(&flat, &element), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(element.value, 2);
+    }
+    EXPECT_EQ(CopyCounter::copies, 0);
+}
+
 TEST(TEST_CPPY_VECTOR, pop)
 {
     {
@@ -2373,6 +3674,136 @@ TEST(TEST_CPPY_VECTOR, sort)
     }
 }
 
+TEST(TEST_CPPY_VECTOR, sort_engine)
+{
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 7);
+    auto random_ints = [&](int n, int high) {
+        std::vector<int> values(n);
+        for (int& x : values)
+            CPPY_RANDOM_randint(&random, -high, high, &x);
+        return values;
+    };
+    {
+        // radix path (large int input) and pdqsort path (small input), both directions
+        for (int n : {100, 100000})
+        {
+            std::vector<int> this_vector = random_ints(n, 1000);
+            std::vector<int> expected = this_vector;
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(CPPY_VECTOR_sort(&this_vector), CPPY_ERROR_t::Ok);
+            EXPECT_EQ(this_vector, expected);
+            EXPECT_EQ(CPPY_VECTOR_sort(&this_vector, true), CPPY_ERROR_t::Ok);
+            EXPECT_TRUE(std::equal(this_vector.begin(), this_vector.end(), expected.rbegin()));
+        }
+    }
+    {
+        std::vector<double> this_vector{0.5, -2.0, 3.25, -0.0, 1e300, -1e-300};
+        for (int i = 0; i < 5000; ++i)
+            this_vector.push_back(static_cast<double>(i % 97) - 48.5);
+        std::vector<double> expected = this_vector;
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(CPPY_VECTOR_sort(&this_vector), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, expected);
+    }
+    {
+        // pdqsort on patterns: sorted, reversed, organ pipe, all equal
+        std::vector<std::string> patterns[4];
+        for (int i = 0; i < 3000; ++i)
+        {
+            patterns[0].push_back(std::to_string(100000 + i));
+            patterns[1].push_back(std::to_string(200000 - i));
+            patterns[2].push_back(std::to_string(100000 + (i < 1500 ? i : 3000 - i)));
+            patterns[3].push_back("same");
+        }
+        for (auto& this_vector : patterns)
+        {
+            std::vector<std::string> expected = this_vector;
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(CPPY_VECTOR_sort(&this_vector), CPPY_ERROR_t::Ok);
+            EXPECT_EQ(this_vector, expected);
+        }
+    }
+    {
+        // key evaluated once per element; equal keys keep their order, also when reversed
+        std::vector<std::string> this_vector{"bb", "a", "cc", "d", "eee"};
+        int calls = 0;
+        auto key = [&calls](const std::string& s) {
+            ++calls;
+            return s.size();
+        };
+        EXPECT_EQ(CPPY_VECTOR_sort(&this_vector, key), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, (std::vector<std::string>{"a", "d", "bb", "cc", "eee"}));
+        EXPECT_EQ(calls, 5);
+        EXPECT_EQ(CPPY_VECTOR_sort(&this_vector, key, true), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, (std::vector<std::string>{"eee", "bb", "cc", "a", "d"}));
+    }
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+        std::vector<int> this_vector = random_ints(300000, 1 << 30);
+        std::vector<int> expected = this_vector;
+        std::sort(expected.begin(), expected.end(), std::greater<int>());
+        EXPECT_EQ(CPPY_VECTOR_sort(&pool, &this_vector, true), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(this_vector, expected);
+
+        std::vector<std::string> strings;
+        for (int i = 0; i < 200000; ++i)
+            strings.push_back(std::to_string((i * 7919) % 100003));
+        std::vector<std::string> sorted_strings = strings;
+        std::sort(sorted_strings.begin(), sorted_strings.end());
+        EXPECT_EQ(CPPY_BUILTINS_sorted(&pool, strings.begin(), strings.end()), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(strings, sorted_strings);
+    }
+}
+
+TEST(TEST_CPPY_VECTOR, sort_stable)
+{
+    // sorted, reversed, sawtooth and random keys; the second member records input order
+    std::vector<std::vector<std::pair<int, int>>> inputs(4);
+    CPPY_Random random;
+    CPPY_RANDOM_init(&random, 11);
+    for (int i = 0; i < 20000; ++i)
+    {
+        int x;
+        CPPY_RANDOM_randint(&random, 0, 50, &x);
+        inputs[0].push_back({i / 4, i});
+        inputs[1].push_back({-i / 4, i});
+        inputs[2].push_back({i % 300, i});
+        inputs[3].push_back({x, i});
+    }
+    for (auto& input : inputs)
+    {
+        for (bool reverse : {false, true})
+        {
+            std::vector<std::pair<int, int>> this_vector = input;
+            std::vector<std::pair<int, int>> expected = input;
+            std::stable_sort(expected.begin(), expected.end(), [reverse](const auto& a, const auto& b) {
+                return reverse ? b.first < a.first : a.first < b.first;
+            });
+            EXPECT_EQ(CPPY_VECTOR_sort(&this_vector, [](const auto& p) { return p.first; }, reverse),
+                      CPPY_ERROR_t::Ok);
+            EXPECT_EQ(this_vector, expected);
+        }
+    }
+    {
+        std::vector<std::pair<int, int>> this_vector = inputs[3];
+        std::vector<std::pair<int, int>> expected = this_vector;
+        std::stable_sort(
+            expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(2));
+        // the merge rounds keep chunk order on ties, so the parallel sort is stable too
+        cppy::internal::parallel_sort(
+            &pool, this_vector.begin(), this_vector.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        EXPECT_EQ(this_vector, expected);
+    }
+    {
+        CPPY_List<std::string> this_list{"b", "a", "c", "a"};
+        EXPECT_EQ(CPPY_LIST_sort(&this_list), CPPY_ERROR_t::Ok);
+        EXPECT_EQ(std::vector<std::string>(this_list.begin(), this_list.end()),
+                  (std::vector<std::string>{"a", "a", "b", "c"}));
+    }
+}
+
 TEST(TEST_CPPY_thread, thread_pool)
 {
     CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(4));
@@ -2390,6 +3821,916 @@ TEST(TEST_CPPY_thread, thread_pool)
     }
 }
 
+TEST(TEST_CPPY_thread, work_stealing_deque)
+{
+    {
+        // the owner pops LIFO, thieves steal FIFO, and the ring grows past its capacity
+        cppy::internal::WorkStealingDeque<int> deque(4);
+        for (int i = 0; i < 100; ++i)
+            deque.push(i);
+        int value = -1;
+        EXPECT_TRUE(deque.pop(&value));
+        EXPECT_EQ(value, 99);
+        EXPECT_TRUE(deque.steal(&value));
+        EXPECT_EQ(value, 0);
+        int count = 2;
+        while (deque.pop(&value))
+            ++count;
+        EXPECT_EQ(count, 100);
+        EXPECT_TRUE(deque.empty());
+        EXPECT_FALSE(deque.steal(&value));
+    }
+    {
+        // every value is taken exactly once, by the owner or by one of the thieves
+        constexpr int n = 200000;
+        cppy::internal::WorkStealingDeque<int> deque(16);
+        std::vector<std::atomic<int>> taken(n);
+        std::atomic<bool> done{false};
+        std::vector<std::thread> thieves;
+        for (int k = 0; k < 3; ++k)
+            thieves.emplace_back([&]() {
+                int value;
+                while (!done.load())
+                    if (deque.steal(&value))
+                        taken[value].fetch_add(1);
+            });
+        int value;
+        for (int i = 0; i < n; ++i)
+        {
+            deque.push(i);
+            if (i % 3 == 0 && deque.pop(&value))
+                taken[value].fetch_add(1);
+        }
+        while (deque.pop(&value))
+            taken[value].fetch_add(1);
+        done = true;
+        for (auto& thief : thieves)
+            thief.join();
+        EXPECT_TRUE(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int>& x) { return x.load() == 1; }));
+    }
+}
+
+TEST(TEST_CPPY_thread, work_stealing)
+{
+    CPPY_CONCURRENT_ThreadPoolOptions options;
+    options.max_workers = 4;
+    options.work_stealing = true;
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+    EXPECT_TRUE(pool.work_stealing());
+    EXPECT_EQ(pool.max_workers(), 4u);
+    EXPECT_EQ(pool.submit([](int x) { return x + 1; }, 41).get(), 42);
+
+    // a binary tree of tasks, each node spawning its children from inside a worker
+    std::atomic<int> nodes{0};
+    std::function<void(int)> spawn = [&](int depth) {
+        nodes.fetch_add(1);
+        if (depth > 0)
+        {
+            pool.submit(spawn, depth - 1);
+            pool.submit(spawn, depth - 1);
+        }
+    };
+    pool.submit(spawn, 13);
+    // shutdown drains the tasks that the running ones keep submitting
+    pool.shutdown();
+    EXPECT_EQ(nodes.load(), (1 << 14) - 1);
+    pool.shutdown();
+}
+
+TEST(TEST_CPPY_thread, mpmc_ring)
+{
+    {
+        cppy::internal::MpmcRing<int> ring(3);
+        EXPECT_EQ(ring.capacity(), 4u);
+        for (int i = 0; i < 4; ++i)
+            EXPECT_TRUE(ring.try_push(i));
+        EXPECT_FALSE(ring.try_push(4));
+        int value = -1;
+        EXPECT_TRUE(ring.try_pop(&value));
+        EXPECT_EQ(value, 0);
+        EXPECT_TRUE(ring.try_push(4));
+        EXPECT_EQ(ring.size(), 4u);
+    }
+    {
+        // two producers, two consumers: every value comes out exactly once
+        constexpr int n = 100000;
+        cppy::internal::MpmcRing<int> ring(64);
+        std::vector<std::atomic<int>> taken(2 * n);
+        std::atomic<int> consumed{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < 2; ++p)
+            threads.emplace_back([&, p]() {
+                for (int i = p * n; i < (p + 1) * n; ++i)
+                    while (!ring.try_push(i))
+                        std::this_thread::yield();
+            });
+        for (int c = 0; c < 2; ++c)
+            threads.emplace_back([&]() {
+                int value;
+                while (consumed.load() < 2 * n)
+                    if (ring.try_pop(&value))
+                    {
+                        taken[value].fetch_add(1);
+                        consumed.fetch_add(1);
+                    }
+                    else
+                        std::this_thread::yield();
+            });
+        for (auto& thread : threads)
+            thread.join();
+        EXPECT_TRUE(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int>& x) { return x.load() == 1; }));
+    }
+}
+
+TEST(TEST_CPPY_thread, spawn_post)
+{
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+    {
+        CPPY_CONCURRENT_Future<int> future = pool.spawn([](int x, int y) { return x * y; }, 6, 7);
+        EXPECT_TRUE(future.valid());
+        EXPECT_EQ(future.get(), 42);
+        EXPECT_FALSE(future.valid());
+
+        auto text = pool.spawn([]() { return std::string(100, 'x'); });
+        auto nothing = pool.spawn([]() {});
+        auto error = pool.spawn([]() -> int { throw std::runtime_error("spawned"); });
+        EXPECT_EQ(text.get().size(), 100u);
+        nothing.get();
+        EXPECT_THROW(error.get(), std::runtime_error);
+    }
+    {
+        // a callable too large to store inline goes to the heap
+        std::array<long long, 64> big{};
+        big[63] = 5;
+        EXPECT_EQ(pool.spawn([big]() { return big[63]; }).get(), 5);
+
+        std::atomic<int> count{0};
+        for (int i = 0; i < 10000; ++i)
+            pool.post([&count](int step) { count.fetch_add(step); }, 1);
+        pool.post([]() { throw std::runtime_error("dropped"); });
+        std::vector<CPPY_CONCURRENT_Future<int>> futures;
+        for (int i = 0; i < 10000; ++i)
+            futures.push_back(pool.spawn([i]() { return i; }));
+        long long sum = 0;
+        for (auto& future : futures)
+            sum += future.get();
+        EXPECT_EQ(sum, 10000LL * 9999 / 2);
+        pool.shutdown();
+        EXPECT_EQ(count.load(), 10000);
+    }
+    {
+        // a task that never runs breaks its promise
+        CPPY_CONCURRENT_ThreadPoolExecutor idle(static_cast<size_t>(0));
+        auto future = idle.spawn([]() { return 1; });
+        idle.shutdown();
+        EXPECT_TRUE(future.done());
+        EXPECT_THROW(future.get(), std::future_error);
+    }
+}
+
+TEST(TEST_CPPY_thread, parallel_loops)
+{
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+    {
+        // results come back in input order, from random-access and from list iterators
+        std::vector<int> data(100000);
+        std::iota(data.begin(), data.end(), 0);
+        std::vector<long long> squares;
+        pool.map([](int x) { return static_cast<long long>(x) * x; }, data.begin(), data.end(),
+                 std::back_inserter(squares));
+        ASSERT_EQ(squares.size(), data.size());
+        for (int i = 0; i < 100000; i += 997)
+            EXPECT_EQ(squares[i], static_cast<long long>(i) * i);
+
+        std::list<int> list{3, 1, 2};
+        std::vector<std::string> strings(3);
+        auto end = pool.map([](int x) { return std::to_string(x); }, list.begin(), list.end(), strings.begin(), 1);
+        EXPECT_EQ(end, strings.end());
+        EXPECT_EQ(strings, (std::vector<std::string>{"3", "1", "2"}));
+    }
+    {
+        std::vector<std::atomic<int>> hits(50000);
+        pool.parallel_for(0, hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+        EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& x) { return x.load() == 1; }));
+        pool.parallel_for(10, 10, [](size_t) { FAIL(); });
+    }
+    {
+        // concatenation is associative but not commutative
+        std::vector<std::string> words;
+        std::string expected;
+        for (int i = 0; i < 2000; ++i)
+        {
+            words.push_back(std::to_string(i));
+            expected += words.back();
+        }
+        auto concat = [](std::string a, const std::string& b) { return a + b; };
+        EXPECT_EQ(pool.parallel_reduce(words.begin(), words.end(), std::string(), concat, 7), expected);
+        EXPECT_EQ(pool.parallel_reduce(words.begin(), words.end(), std::string(), concat), expected);
+        std::vector<int> none;
+        EXPECT_EQ(pool.parallel_reduce(none.begin(), none.end(), 5, std::plus<int>()), 5);
+    }
+    {
+        EXPECT_THROW(pool.parallel_for(0, 1000, [](size_t i) {
+            if (i == 500)
+                throw std::out_of_range("500");
+        }, 10), std::out_of_range);
+
+        // a loop inside a task of a one-worker pool: the task runs it alone
+        CPPY_CONCURRENT_ThreadPoolExecutor single(static_cast<size_t>(1));
+        auto inner = single.spawn([&single]() {
+            std::atomic<int> sum{0};
+            single.parallel_for(0, 1000, [&](size_t i) { sum.fetch_add(static_cast<int>(i)); }, 1);
+            return sum.load();
+        });
+        EXPECT_EQ(inner.get(), 499500);
+    }
+}
+
+TEST(TEST_CPPY_thread, numa_affinity)
+{
+    std::vector<CPPY_PLATFORM_NumaNode> nodes;
+    ASSERT_EQ(CPPY_PLATFORM_numa_nodes(&nodes), CPPY_ERROR_t::Ok);
+    for (bool stealing : {false, true})
+    {
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 3;
+        options.work_stealing = stealing;
+        options.pin_workers = true;
+        options.numa_aware = true;
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        EXPECT_EQ(pool.numa_nodes(), nodes.size());
+
+        // a pinned worker stays on the CPUs of the node it was given
+        std::vector<CPPY_CONCURRENT_Future<int>> cpus;
+        for (int i = 0; i < 64; ++i)
+            cpus.push_back(pool.spawn_on(nodes[0].id, []() {
+                int cpu = -1;
+                CPPY_PLATFORM_current_cpu(&cpu);
+                return cpu;
+            }));
+        for (auto& cpu : cpus)
+        {
+            const int value = cpu.get();
+            bool known = false;
+            for (const auto& node : nodes)
+                known = known || std::count(node.cpus.begin(), node.cpus.end(), value) > 0;
+            EXPECT_TRUE(known);
+        }
+
+        // a hint for a node without workers is ignored
+        std::atomic<int> count{0};
+        for (int i = 0; i < 1000; ++i)
+            pool.post_on(i % 2 == 0 ? nodes.back().id : -7, [&count]() { count.fetch_add(1); });
+        EXPECT_EQ(pool.spawn_on(12345, []() { return 5; }).get(), 5);
+        pool.shutdown();
+        EXPECT_EQ(count.load(), 1000);
+    }
+    CPPY_CONCURRENT_ThreadPoolExecutor plain(static_cast<size_t>(2));
+    EXPECT_EQ(plain.numa_nodes(), 1u);
+}
+
+TEST(TEST_CPPY_thread, elastic_workers)
+{
+    // waits up to two seconds for the pool to settle at `count` workers
+    auto settles_at = [](const CPPY_CONCURRENT_ThreadPoolExecutor& pool, size_t count) {
+        for (int i = 0; i < 200 && pool.workers() != count; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return pool.workers() == count;
+    };
+    for (size_t min_workers : {0, 1})
+    {
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 4;
+        options.min_workers = min_workers;
+        options.idle_timeout = std::chrono::milliseconds(20);
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        EXPECT_EQ(pool.workers(), min_workers);
+
+        // blocked tasks pile up, so the pool grows to take them
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        std::atomic<int> started{0};
+        std::vector<CPPY_CONCURRENT_Future<void>> blocked;
+        for (int i = 0; i < 4; ++i)
+            blocked.push_back(pool.spawn([&started, opened]() {
+                started.fetch_add(1);
+                opened.wait();
+            }));
+        for (int i = 0; i < 200 && started.load() < 4; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EXPECT_EQ(started.load(), 4);
+        EXPECT_EQ(pool.workers(), 4u);
+        gate.set_value();
+        for (auto& future : blocked)
+            future.get();
+
+        // and shrinks back once they have sat idle
+        EXPECT_TRUE(settles_at(pool, min_workers));
+        EXPECT_EQ(pool.spawn([]() { return 3; }).get(), 3);
+        std::atomic<int> items{0};
+        pool.parallel_for(0, 100, [&items](size_t) { items.fetch_add(1); }, 1);
+        EXPECT_EQ(items.load(), 100);
+    }
+    for (size_t spin : {0, 100000})
+    {
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 2;
+        options.spin_count = spin;
+        options.yield_count = spin;
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        std::atomic<int> count{0};
+        for (int burst = 0; burst < 5; ++burst)
+        {
+            for (int i = 0; i < 100; ++i)
+                pool.post([&count]() { count.fetch_add(1); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pool.shutdown();
+        EXPECT_EQ(count.load(), 500);
+        EXPECT_EQ(pool.workers(), 0u);
+    }
+}
+
+TEST(TEST_CPPY_thread, priorities)
+{
+    using priority = CPPY_CONCURRENT_priority_t;
+    const auto in = [](int ms) { return std::chrono::steady_clock::now() + std::chrono::milliseconds(ms); };
+    {
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 1;
+        options.starvation_limit = std::chrono::seconds(60);
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+
+        // hold the only worker while the queues fill up
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        std::promise<void> holding;
+        pool.post([&holding, opened]() {
+            holding.set_value();
+            opened.wait();
+        });
+        holding.get_future().wait();
+
+        std::mutex order_mutex;
+        std::string order;
+        const auto record = [&](char name) {
+            return [&, name]() {
+                std::lock_guard<std::mutex> lock(order_mutex);
+                order += name;
+            };
+        };
+        pool.post_with({priority::Low}, record('a'));
+        pool.post(record('b'));
+        pool.post_with({priority::High}, record('c'));
+        pool.post_with({priority::High, in(1000)}, record('d'));
+        pool.post_with({priority::Normal, in(2000)}, record('e'));
+        pool.post_with({priority::High, in(500)}, record('f'));
+        pool.post_with({priority::Low, in(100)}, record('g'));
+        auto high = pool.spawn_with({priority::High}, [](int x) { return x * 2; }, 21);
+        EXPECT_EQ(pool.queue_depth(priority::High), 4u);
+        EXPECT_EQ(pool.queue_depth(priority::Normal), 2u);
+        EXPECT_EQ(pool.queue_depth(priority::Low), 2u);
+
+        gate.set_value();
+        EXPECT_EQ(high.get(), 42);
+        pool.shutdown();
+        // earliest deadline first within a class, then submission order; classes in turn
+        EXPECT_EQ(order, "fdc" "eb" "ga");
+        EXPECT_EQ(pool.queue_depth(priority::High), 0u);
+        EXPECT_EQ(pool.queue_depth(priority::Normal), 0u);
+        EXPECT_EQ(pool.queue_depth(priority::Low), 0u);
+    }
+    {
+        // a steady stream of high-priority work does not hold off the low class forever
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 1;
+        options.starvation_limit = std::chrono::milliseconds(10);
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        pool.post([opened]() { opened.wait(); });
+
+        std::atomic<int> high_done{0};
+        int high_before_low = -1;
+        pool.post_with({priority::Low}, [&]() { high_before_low = high_done.load(); });
+        for (int i = 0; i < 40; ++i)
+            pool.post_with({priority::High}, [&high_done]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                high_done.fetch_add(1);
+            });
+        gate.set_value();
+        pool.shutdown();
+        EXPECT_EQ(high_done.load(), 40);
+        EXPECT_GT(high_before_low, 0);
+        EXPECT_LT(high_before_low, 40);
+    }
+}
+
+TEST(TEST_CPPY_thread, histogram)
+{
+    CPPY_CONCURRENT_Histogram histogram;
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(50), 0u);
+    for (uint64_t v = 1; v <= 1000; ++v)
+        histogram.record(v);
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.min(), 1u);
+    EXPECT_EQ(histogram.max(), 1000u);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 500.5);
+    // within a bucket's width, 1/16, above the exact value
+    EXPECT_GE(histogram.percentile(50), 500u);
+    EXPECT_LE(histogram.percentile(50), 500u + 500u / 16);
+    EXPECT_GE(histogram.percentile(99), 990u);
+    EXPECT_LE(histogram.percentile(99), 1000u);
+    EXPECT_EQ(histogram.percentile(100), 1000u);
+    EXPECT_EQ(histogram.percentile(0), 1u);
+
+    CPPY_CONCURRENT_Histogram other;
+    other.record(7, 1000);
+    other.record(uint64_t(1) << 50);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 2001u);
+    EXPECT_EQ(histogram.min(), 1u);
+    EXPECT_EQ(histogram.max(), uint64_t(1) << 50);
+    EXPECT_EQ(histogram.percentile(100), uint64_t(1) << 50);
+    EXPECT_EQ(histogram.percentile(25), 7u);
+
+    for (uint64_t v = 0; v < 100000; v = v * 9 / 8 + 1)
+    {
+        const size_t bucket = cppy::internal::histogram_bucket(v);
+        EXPECT_GE(cppy::internal::histogram_bucket_max(bucket), v);
+        if (bucket > 0)
+        {
+            EXPECT_LT(cppy::internal::histogram_bucket_max(bucket - 1), v);
+        }
+    }
+    EXPECT_EQ(cppy::internal::histogram_bucket(UINT64_MAX), cppy::internal::kHistogramBuckets - 1);
+}
+
+TEST(TEST_CPPY_thread, stats)
+{
+    CPPY_CONCURRENT_ThreadPoolOptions options;
+    options.max_workers = 2;
+    options.work_stealing = true;
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(options);
+    std::vector<CPPY_CONCURRENT_Future<int>> futures;
+    for (int i = 0; i < 100; ++i)
+        futures.push_back(pool.spawn([i]() { return i; }));
+    futures.push_back(pool.spawn([]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return 0;
+    }));
+    for (auto& future : futures)
+        future.get();
+    // its helper tasks are not counted as tasks
+    pool.parallel_for(0, 1000, [](size_t) {}, 1);
+    pool.shutdown();
+
+    const CPPY_CONCURRENT_ThreadPoolStats stats = pool.stats();
+    EXPECT_EQ(stats.pending, 0u);
+    const std::string json = stats.to_json();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.back(), '}');
+#if defined(CPPY_THREAD_STATS)
+    EXPECT_TRUE(stats.enabled);
+    EXPECT_EQ(stats.submitted, 101u);
+    EXPECT_EQ(stats.completed, 101u);
+    EXPECT_EQ(stats.discarded, 0u);
+    EXPECT_EQ(stats.queue_wait.count(), 101u);
+    EXPECT_EQ(stats.run_time.count(), 101u);
+    EXPECT_GE(stats.run_time.max(), 5000000u);
+    ASSERT_EQ(stats.workers.size(), 2u);
+    uint64_t completed = 0;
+    for (const CPPY_CONCURRENT_WorkerStats& worker : stats.workers)
+    {
+        completed += worker.completed;
+        EXPECT_EQ(worker.run_time.count(), worker.completed);
+        EXPECT_GE(worker.utilisation(), 0.0);
+        EXPECT_LE(worker.utilisation(), 1.0);
+    }
+    EXPECT_EQ(completed, 101u);
+    EXPECT_NE(json.find("\"enabled\":true"), std::string::npos);
+    EXPECT_NE(json.find("\"completed\":101"), std::string::npos);
+    EXPECT_NE(stats.to_text().find("worker 1 completed"), std::string::npos);
+
+    // tasks a pool without workers never ran
+    CPPY_CONCURRENT_ThreadPoolExecutor idle(0);
+    idle.post([]() {});
+    EXPECT_EQ(idle.stats().submitted, 1u);
+    idle.shutdown();
+    EXPECT_EQ(idle.stats().discarded, 1u);
+    EXPECT_EQ(idle.stats().submitted, 1u);
+
+    // a task the submitter runs itself is submitted, and not completed by a worker
+    CPPY_CONCURRENT_ThreadPoolOptions bounded;
+    bounded.max_workers = 0;
+    bounded.max_queued = 1;
+    bounded.overflow = CPPY_CONCURRENT_overflow_t::CallerRuns;
+    CPPY_CONCURRENT_ThreadPoolExecutor full(bounded);
+    full.post([]() {});
+    full.post([]() {});
+    EXPECT_EQ(full.stats().submitted, 2u);
+    EXPECT_EQ(full.stats().ran_inline, 1u);
+    EXPECT_EQ(full.stats().completed, 0u);
+    EXPECT_EQ(full.stats().pending, 1u);
+    full.shutdown();
+    EXPECT_EQ(full.stats().discarded, 1u);
+#else
+    EXPECT_FALSE(stats.enabled);
+    EXPECT_EQ(stats.submitted, 0u);
+    EXPECT_EQ(stats.completed, 0u);
+    EXPECT_NE(json.find("\"enabled\":false"), std::string::npos);
+    EXPECT_EQ(json.find("\"submitted\""), std::string::npos);
+#endif
+}
+
+TEST(TEST_CPPY_thread, shutdown_cancel_bounded)
+{
+    // a pool with its only worker held until the returned promise is set
+    struct Held
+    {
+        explicit Held(const CPPY_CONCURRENT_ThreadPoolOptions& options) : pool(options)
+        {
+            std::promise<void> holding;
+            std::shared_future<void> opened = gate.get_future().share();
+            pool.post([&holding, opened]() {
+                holding.set_value();
+                opened.wait();
+            });
+            holding.get_future().wait();
+        }
+        std::promise<void> gate;
+        CPPY_CONCURRENT_ThreadPoolExecutor pool;
+    };
+    const auto bounded = [](size_t max_queued, CPPY_CONCURRENT_overflow_t overflow) {
+        CPPY_CONCURRENT_ThreadPoolOptions options;
+        options.max_workers = 1;
+        options.max_queued = max_queued;
+        options.overflow = overflow;
+        return options;
+    };
+
+    {
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(2);
+        pool.shutdown();
+        EXPECT_THROW(pool.submit([]() {}), std::runtime_error);
+        EXPECT_THROW(pool.spawn([]() { return 1; }), std::runtime_error);
+        EXPECT_THROW(pool.post([]() {}), std::runtime_error);
+        EXPECT_THROW(pool.parallel_for(0, 100, [](size_t) {}, 1), std::runtime_error);
+        pool.shutdown();
+    }
+    {
+        // tasks still running when the pool shuts down may submit more, and those run too
+        std::atomic<int> count{0};
+        CPPY_CONCURRENT_ThreadPoolExecutor pool(2);
+        pool.post([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            pool.post([&count]() { count.fetch_add(1); });
+            count.fetch_add(1);
+        });
+        pool.shutdown();
+        EXPECT_EQ(count.load(), 2);
+    }
+    {
+        // shutdown(wait=false, cancel_futures=true) returns at once and drops what has not started
+        Held held(bounded(0, CPPY_CONCURRENT_overflow_t::Block));
+        std::vector<CPPY_CONCURRENT_Future<int>> futures;
+        for (int i = 0; i < 10; ++i)
+            futures.push_back(held.pool.spawn([i]() { return i; }));
+        std::future<int> submitted = held.pool.submit([]() { return 1; });
+        held.pool.shutdown(false, true);
+        EXPECT_THROW(held.pool.post([]() {}), std::runtime_error);
+        held.gate.set_value();
+        for (auto& future : futures)
+            EXPECT_THROW(future.get(), CPPY_CONCURRENT_CancelledError);
+        EXPECT_THROW(submitted.get(), CPPY_CONCURRENT_CancelledError);
+    }
+    {
+        Held held(bounded(2, CPPY_CONCURRENT_overflow_t::Reject));
+        std::atomic<int> count{0};
+        held.pool.post([&count]() { count.fetch_add(1); });
+        held.pool.post([&count]() { count.fetch_add(1); });
+        EXPECT_THROW(held.pool.post([&count]() { count.fetch_add(1); }), CPPY_CONCURRENT_QueueFullError);
+        EXPECT_THROW(held.pool.spawn([]() { return 1; }), CPPY_CONCURRENT_QueueFullError);
+        held.gate.set_value();
+        held.pool.shutdown();
+        EXPECT_EQ(count.load(), 2);
+    }
+    {
+        Held held(bounded(1, CPPY_CONCURRENT_overflow_t::CallerRuns));
+        held.pool.post([]() {});
+        std::thread::id ran_on;
+        auto future = held.pool.spawn([&ran_on]() {
+            ran_on = std::this_thread::get_id();
+            return 5;
+        });
+        EXPECT_EQ(ran_on, std::this_thread::get_id());
+        EXPECT_EQ(future.get(), 5);
+        held.gate.set_value();
+    }
+    {
+        // Block waits for a place, and gives up when the pool shuts down
+        Held held(bounded(1, CPPY_CONCURRENT_overflow_t::Block));
+        std::atomic<int> count{0};
+        held.pool.post([&count]() { count.fetch_add(1); });
+        std::atomic<bool> returned{false};
+        std::thread submitter([&]() {
+            held.pool.post([&count]() { count.fetch_add(1); });
+            returned = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_FALSE(returned.load());
+        held.gate.set_value();
+        submitter.join();
+        EXPECT_TRUE(returned.load());
+        held.pool.shutdown();
+        EXPECT_EQ(count.load(), 2);
+    }
+    {
+        Held held(bounded(1, CPPY_CONCURRENT_overflow_t::Block));
+        held.pool.post([]() {});
+        std::atomic<bool> refused{false};
+        std::thread submitter([&]() {
+            try
+            {
+                held.pool.post([]() {});
+            }
+            catch (const std::runtime_error&)
+            {
+                refused = true;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        held.pool.shutdown(false);
+        submitter.join();
+        EXPECT_TRUE(refused.load());
+        held.gate.set_value();
+    }
+    {
+        // a cancelled token drops the tasks that have not started
+        Held held(bounded(0, CPPY_CONCURRENT_overflow_t::Block));
+        CPPY_CONCURRENT_CancellationSource source, other;
+        CPPY_CONCURRENT_TaskOptions options, kept;
+        options.cancellation = source.token();
+        kept.cancellation = other.token();
+        std::atomic<int> count{0};
+        auto dropped = held.pool.spawn_with(options, []() { return 1; });
+        held.pool.post_with(options, [&count]() { count.fetch_add(1); });
+        auto runs = held.pool.spawn_with(kept, [token = other.token()]() { return token.cancelled() ? 0 : 2; });
+        EXPECT_FALSE(options.cancellation.cancelled());
+        source.cancel();
+        EXPECT_TRUE(options.cancellation.cancelled());
+        EXPECT_FALSE(CPPY_CONCURRENT_CancellationToken().cancellable());
+        held.gate.set_value();
+        EXPECT_THROW(dropped.get(), CPPY_CONCURRENT_CancelledError);
+        EXPECT_EQ(runs.get(), 2);
+        held.pool.shutdown();
+        EXPECT_EQ(count.load(), 0);
+    }
+}
+
+TEST(TEST_CPPY_thread, future_then)
+{
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(2));
+    {
+        auto length = pool.spawn([]() { return std::string("cppy"); })
+                          .then([](std::string text) { return text.size(); })
+                          .then([](size_t size) { return static_cast<int>(size) * 10; });
+        EXPECT_EQ(length.get(), 40);
+
+        std::atomic<int> ran{0};
+        auto after_void = pool.spawn([&ran]() { ran.fetch_add(1); }).then([&ran]() { return ran.load(); });
+        EXPECT_EQ(after_void.get(), 1);
+    }
+    {
+        // an error skips the stages that take a value and reaches one that takes the future
+        bool skipped = true;
+        auto recovered = pool.spawn([]() -> int { throw std::runtime_error("stage"); })
+                             .then([&skipped](int x) {
+                                 skipped = false;
+                                 return x;
+                             })
+                             .then([](CPPY_CONCURRENT_Future<int> done) {
+                                 try
+                                 {
+                                     return done.get();
+                                 }
+                                 catch (const std::runtime_error&)
+                                 {
+                                     return -1;
+                                 }
+                             });
+        EXPECT_EQ(recovered.get(), -1);
+        EXPECT_TRUE(skipped);
+        auto thrown = pool.spawn([]() { return 1; }).then([](int) -> int { throw std::logic_error("then"); });
+        EXPECT_THROW(thrown.get(), std::logic_error);
+    }
+    {
+        // a continuation returning a future is flattened
+        auto nested = pool.spawn([]() { return 6; }).then([&pool](int x) {
+            return pool.spawn([x]() { return x * 7; });
+        });
+        static_assert(std::is_same_v<decltype(nested), CPPY_CONCURRENT_Future<int>>);
+        EXPECT_EQ(nested.get(), 42);
+    }
+    {
+        // a long chain on a single worker: no stage ever waits for another
+        CPPY_CONCURRENT_ThreadPoolExecutor single(static_cast<size_t>(1));
+        auto chain = single.spawn([]() { return 0; });
+        for (int i = 0; i < 1000; ++i)
+            chain = chain.then([](int x) { return x + 1; });
+        EXPECT_EQ(chain.get(), 1000);
+
+        // a continuation of a future that is already done
+        auto done = single.spawn([]() { return 2; });
+        done.wait();
+        EXPECT_EQ(done.then([](int x) { return x * x; }).get(), 4);
+    }
+    {
+        // continuations of tasks that never ran see the broken promise
+        CPPY_CONCURRENT_ThreadPoolExecutor idle(static_cast<size_t>(0));
+        auto future = idle.spawn([]() { return 1; }).then([](int x) { return x; });
+        idle.shutdown();
+        EXPECT_THROW(future.get(), std::future_error);
+    }
+    {
+        // futures outliving their pool: then() and completions after it is gone run inline
+        CPPY_CONCURRENT_Future<int> outlived;
+        CPPY_CONCURRENT_Future<int> late;
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        {
+            CPPY_CONCURRENT_ThreadPoolExecutor gone(static_cast<size_t>(1));
+            outlived = gone.spawn([]() { return 3; });
+            outlived.wait();
+            late = CPPY_CONCURRENT_when_all(gone.spawn([]() { return 1; }), pool.spawn([opened]() {
+                       opened.wait();
+                       return 2;
+                   })).then([](std::tuple<CPPY_CONCURRENT_Future<int>, CPPY_CONCURRENT_Future<int>> done) {
+                return std::get<0>(done).get() + std::get<1>(done).get();
+            });
+        }
+        EXPECT_EQ(outlived.then([](int x) { return x + 1; }).get(), 4);
+        gate.set_value();
+        EXPECT_EQ(late.get(), 3);
+    }
+}
+
+TEST(TEST_CPPY_thread, when_all_any)
+{
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(3));
+    {
+        std::vector<CPPY_CONCURRENT_Future<int>> futures;
+        for (int i = 0; i < 100; ++i)
+            futures.push_back(pool.spawn([i]() { return i; }));
+        futures.push_back(pool.spawn([]() -> int { throw std::runtime_error("one"); }));
+        auto total = CPPY_CONCURRENT_when_all(futures.begin(), futures.end())
+                         .then([](std::vector<CPPY_CONCURRENT_Future<int>> done) {
+                             int sum = 0, errors = 0;
+                             for (auto& future : done)
+                             {
+                                 EXPECT_TRUE(future.done());
+                                 try
+                                 {
+                                     sum += future.get();
+                                 }
+                                 catch (const std::runtime_error&)
+                                 {
+                                     ++errors;
+                                 }
+                             }
+                             return std::make_pair(sum, errors);
+                         });
+        EXPECT_EQ(total.get(), std::make_pair(4950, 1));
+
+        std::vector<CPPY_CONCURRENT_Future<int>> none;
+        EXPECT_TRUE(CPPY_CONCURRENT_when_all(none.begin(), none.end()).get().empty());
+
+        auto both = CPPY_CONCURRENT_when_all(pool.spawn([]() { return 1; }), pool.spawn([]() { return std::string("a"); }));
+        auto [one, a] = both.get();
+        EXPECT_EQ(one.get(), 1);
+        EXPECT_EQ(a.get(), "a");
+    }
+    {
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        std::vector<CPPY_CONCURRENT_Future<int>> futures;
+        futures.push_back(pool.spawn([opened]() {
+            opened.wait();
+            return 0;
+        }));
+        futures.push_back(pool.spawn([]() { return 1; }));
+        auto any = CPPY_CONCURRENT_when_any(futures.begin(), futures.end()).get();
+        EXPECT_EQ(any.index, 1u);
+        ASSERT_EQ(any.futures.size(), 2u);
+        EXPECT_EQ(any.futures[1].get(), 1);
+        EXPECT_FALSE(any.futures[0].done());
+        // the winner's callback is spent, the other one can still be chained
+        auto later = std::move(any.futures[0]).then([](int x) { return x + 10; });
+        gate.set_value();
+        EXPECT_EQ(later.get(), 10);
+
+        std::vector<CPPY_CONCURRENT_Future<int>> none;
+        EXPECT_EQ(CPPY_CONCURRENT_when_any(none.begin(), none.end()).get().index, SIZE_MAX);
+
+        auto first = CPPY_CONCURRENT_when_any(pool.spawn([]() { return 'x'; }), pool.spawn([]() {})).get();
+        EXPECT_LT(first.index, 2u);
+    }
+    {
+        // as_completed yields futures in the order they finish
+        std::vector<std::promise<void>> gates(4);
+        std::vector<CPPY_CONCURRENT_Future<int>> futures;
+        for (int i = 0; i < 4; ++i)
+            futures.push_back(pool.spawn([opened = gates[i].get_future().share(), i]() {
+                opened.wait();
+                return i;
+            }));
+        std::vector<int> order;
+        auto completed = CPPY_CONCURRENT_as_completed(futures.begin(), futures.end());
+        EXPECT_EQ(completed.size(), 4u);
+        gates[2].set_value();
+        for (auto& future : completed)
+        {
+            order.push_back(future.get());
+            if (order.size() == 1)
+            {
+                gates[0].set_value();
+                gates[3].set_value();
+                gates[1].set_value();
+            }
+        }
+        ASSERT_EQ(order.size(), 4u);
+        EXPECT_EQ(order[0], 2);
+        std::sort(order.begin(), order.end());
+        EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    }
+}
+
+#if defined(CPPY_COROUTINES)
+static CPPY_CONCURRENT_Task<int> coroutine_answer()
+{
+    co_return 42;
+}
+
+static CPPY_CONCURRENT_Task<std::thread::id> coroutine_hop(CPPY_CONCURRENT_ThreadPoolExecutor& pool)
+{
+    co_await CPPY_CONCURRENT_schedule(pool);
+    co_return std::this_thread::get_id();
+}
+
+static CPPY_CONCURRENT_Task<size_t> coroutine_pipeline(CPPY_CONCURRENT_ThreadPoolExecutor& pool, int n)
+{
+    std::string text = co_await pool.spawn([n]() { return std::string(n, 'w'); });
+    // named: GCC 12 miscompiles a lambda capturing a std::string inside a co_await expression
+    auto count = [text]() { return text.size(); };
+    const size_t words = co_await pool.spawn(count);
+    co_return words + static_cast<size_t>(co_await coroutine_answer());
+}
+
+static CPPY_CONCURRENT_Task<> coroutine_throw(CPPY_CONCURRENT_ThreadPoolExecutor& pool)
+{
+    co_await pool.spawn([]() { throw std::runtime_error("spawned"); });
+}
+
+static CPPY_CONCURRENT_Task<long long> coroutine_sum(int n)
+{
+    // each awaited task finishes at once; symmetric transfer keeps the stack flat
+    long long sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += co_await coroutine_answer();
+    co_return sum;
+}
+
+TEST(TEST_CPPY_thread, coroutine_task)
+{
+    CPPY_CONCURRENT_ThreadPoolExecutor pool(static_cast<size_t>(2));
+    EXPECT_EQ(CPPY_CONCURRENT_sync_wait(coroutine_answer()), 42);
+    EXPECT_NE(CPPY_CONCURRENT_sync_wait(coroutine_hop(pool)), std::this_thread::get_id());
+    EXPECT_EQ(CPPY_CONCURRENT_sync_wait(coroutine_pipeline(pool, 10)), 52u);
+    EXPECT_THROW(CPPY_CONCURRENT_sync_wait(coroutine_throw(pool)), std::runtime_error);
+    // the transfer is a tail call, which GCC only emits when optimizing
+#if defined(__OPTIMIZE__)
+    EXPECT_EQ(CPPY_CONCURRENT_sync_wait(coroutine_sum(1000000)), 42000000LL);
+#else
+    EXPECT_EQ(CPPY_CONCURRENT_sync_wait(coroutine_sum(10000)), 420000LL);
+#endif
+
+    // many pipelines in flight on a single worker, none of them holding it while it waits
+    CPPY_CONCURRENT_ThreadPoolExecutor single(static_cast<size_t>(1));
+    auto fan_out = [&single]() -> CPPY_CONCURRENT_Task<size_t> {
+        std::vector<CPPY_CONCURRENT_Future<size_t>> futures;
+        for (int i = 0; i < 100; ++i)
+            futures.push_back(single.spawn([i]() { return static_cast<size_t>(i); }));
+        auto done = co_await CPPY_CONCURRENT_when_all(futures.begin(), futures.end());
+        size_t total = 0;
+        for (auto& future : done)
+            total += future.get();
+        co_return total;
+    };
+    EXPECT_EQ(CPPY_CONCURRENT_sync_wait(fan_out()), 4950u);
+}
+#endif
+
 TEST(TEST_CPPY_TYPING, Container_iscontain)
 {
     {
@@ -2522,6 +4863,59 @@ TEST(TEST_CPPY_TYPING, Sequence_count)
     }
 }
 
+TEST(TEST_CPPY_TYPING, Sequence_simd)
+{
+    // lengths around the vector widths exercise both the SIMD body and the scalar tail
+    for (int n : {0, 1, 3, 4, 7, 8, 9, 33, 1000})
+    {
+        std::vector<int> vi(n);
+        std::vector<float> vf(n);
+        std::vector<double> vd(n);
+        for (int i = 0; i < n; ++i)
+        {
+            vi[i] = i % 5;
+            vf[i] = static_cast<float>(i % 5);
+            vd[i] = static_cast<double>(i % 5);
+        }
+
+        int expected_count = static_cast<int>(std::count(vi.begin(), vi.end(), 4));
+        int count;
+        CPPY_Sequence_count(vi.begin(), vi.end(), 4, &count);
+        EXPECT_EQ(count, expected_count);
+        CPPY_Sequence_count(vf.begin(), vf.end(), 4.0f, &count);
+        EXPECT_EQ(count, expected_count);
+        CPPY_Sequence_count(vd.cbegin(), vd.cend(), 4.0, &count);
+        EXPECT_EQ(count, expected_count);
+
+        bool result;
+        CPPY_Container_iscontain(vi.data(), vi.data() + n, 4, &result);
+        EXPECT_EQ(result, n > 4);
+        CPPY_Container_iscontain(vd.begin(), vd.end(), 7.0, &result);
+        EXPECT_FALSE(result);
+
+        int index;
+        CPPY_ERROR_t err = CPPY_Sequence_index(vf.begin(), vf.end(), 4.0f, &index, 5);
+        if (n > 9)
+        {
+            EXPECT_EQ(err, CPPY_ERROR_t::Ok);
+            EXPECT_EQ(index, 9);
+        }
+        else
+        {
+            EXPECT_EQ(err, CPPY_ERROR_t::ValueError);
+        }
+    }
+    {
+        std::vector<double> v{1.0, std::nan(""), -0.0};
+        bool result;
+        CPPY_Container_iscontain(v.begin(), v.end(), std::nan(""), &result);
+        EXPECT_FALSE(result);
+        int index;
+        CPPY_Sequence_index(v.begin(), v.end(), 0.0, &index);
+        EXPECT_EQ(index, 2);
+    }
+}
+
 TEST(TEST_CPPY_TYPING, MutableSequence_append)
 {
     {